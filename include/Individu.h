@@ -1,12 +1,19 @@
 #pragma once
 
 #include "Vec.h"
+#include "bitpack.h"
+#include "kernels.h"
 #include "randomizer.h"
 #include "settings.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <iostream>
+#include <span>
+#include <string>
+#include <type_traits>
 
 
 /**
@@ -17,9 +24,17 @@
  * @tparam dim Dimension of each vector (number of genes per chromosome)
  * 
  * This class implements an individual for genetic algorithms with the following features:
- * - Multiple chromosomes stored as binary integers
- * - Self-adaptive mutation probabilities
+ * - Multiple chromosomes stored as binary integers, bit-packed on exactly Nb_bin bits per gene
+ * - Self-adaptive mutation probabilities (also packed on Nb_bin bits)
  * - Binary to real number conversion capabilities
+ *
+ * With CachePhenotype (settings.h), the individual also keeps its decoded
+ * phenotype, kept in sync on every gene write (setters, mutation, crossover):
+ * getPhenotype() and coordinates() then read it without decoding, at the cost
+ * of nbVec*dim reals per individual (88 bytes instead of 36 for 2 vectors of
+ * dimension 3 in double). Without it (the default), only the packed genes are
+ * stored and those two accessors decode them into a value on every call; batch
+ * passes over large populations use decodeInto() into their own buffers.
  */
 template <size_t nbVec, size_t dim>
 class Individu {
@@ -42,9 +57,54 @@ public :
      */
     using genome = std::array<chromosome, nbVec>;
 
+    /**
+     * @typedef storage
+     * @brief Packed storage of every gene followed by every mutation probability.
+     *
+     * Field (i*dim + j) is gene j of chromosome i, field (nbVec*dim + k) is the
+     * mutation probability of chromosome k (k == nbVec being the probability
+     * chromosome itself).
+     */
+    using storage = PackedArray<Nb_bin, nbVec * dim + nbVec + 1>;
+
+    /**
+     * @typedef phenotype
+     * @brief The decoded vectors, exactly as received by the fitness function
+     */
+    using phenotype = std::array<Vec<dim>, nbVec>;
+
+    static constexpr size_t proba_offset = nbVec * dim; // indice du premier champ de probabilité
+
+    /**
+     * @typedef coordinate_view
+     * @brief What coordinates() returns: a view of the cache with CachePhenotype, a decoded copy otherwise
+     */
+    using coordinate_view = std::conditional_t<CachePhenotype, std::span<const real>, std::array<real, nbVec * dim>>;
+
 private :
-    genome m_infos; // le vecteur représentant l'individu
-    std::array<integer, nbVec + 1> m_proba; // le vecteur des probabilités de mutation de chaque chromosome : celui des vecteurs et lui-même. Cela donne n+1 probas
+    struct NoCache {}; // la place du phénotype quand il n'est pas gardé : aucun octet grâce à [[no_unique_address]]
+
+    storage m_bits; // les gènes des vecteurs puis les n+1 probabilités de mutation, sur Nb_bin bits chacun
+    [[no_unique_address]] std::conditional_t<CachePhenotype, phenotype, NoCache> m_phenotype; // les vecteurs décodés, si CachePhenotype
+
+    // met à jour la coordonnée décodée du gène j du chromosome i
+    void decodeGene(size_t i, size_t j) {
+        if constexpr (CachePhenotype) m_phenotype[i][j] = bin_to_real(m_bits.get(i * dim + j));
+    }
+
+    // met à jour toutes les coordonnées décodées du chromosome i
+    void decodeChromosome(size_t i) {
+        if constexpr (CachePhenotype) decodeChromosomeInto(i, &m_phenotype[i][0]);
+    }
+
+    // décode le chromosome i dans out (dim réels)
+    void decodeChromosomeInto(size_t i, real* out) const {
+        integer genes[dim];
+        for (size_t j = 0; j < dim; j++) {
+            genes[j] = m_bits.get(i * dim + j);
+        }
+        kernels().decode_genes(genes, dim, out);
+    }
 public :
 
     // ==================================================================================================================
@@ -52,23 +112,58 @@ public :
     // ==================================================================================================================
 
     /**
-     * @brief Default constructor
-     * 
-     * Initializes the individual with:
-     * - Random genes for each chromosome
-     * - Default mutation probability of 0.9 for each chromosome
+     * @brief Default constructor: a blank individual, for scratch storage
+     *
+     * Every field is 0 (the genes decode to min_real, the mutation
+     * probabilities are 0) and nothing is drawn: building scratch agents
+     * costs no random numbers. Random individuals come from
+     * Individu(mutation_proba), or populate() for a whole population.
      */
-    Individu() {
-        // Initialiser chaque gène aléatoirement
-        for (size_t i = 0; i < nbVec; i++) {
-            for (size_t j = 0; j < dim; j++) {
-                m_infos[i][j] = Randomizer::getInt(0, bin_max);
+    Individu() : m_bits{} {
+        if constexpr (CachePhenotype) {
+            const real x = bin_to_real(0);
+            for (auto& v : m_phenotype) {
+                for (size_t j = 0; j < dim; j++) v[j] = x;
             }
         }
+    }
+
+    /**
+     * @brief Constructor from given genes
+     * @param g The genes of every vector chromosome
+     * @param mutation_proba Initial mutation probability of every chromosome, in [0, 1]
+     */
+    Individu(const genome& g, real mutation_proba) : m_bits{} {
+        for (size_t i = 0; i < nbVec; i++) {
+            for (size_t j = 0; j < dim; j++) m_bits.set(i * dim + j, g[i][j]);
+        }
+        for (size_t i = 0; i < nbVec + 1; i++) {
+            m_bits.set(proba_offset + i, proba_to_bin(mutation_proba));
+        }
+        for (size_t i = 0; i < nbVec; i++) {
+            decodeChromosome(i);
+        }
+    }
+
+    /**
+     * @brief Constructor with an initial mutation probability
+     * @param mutation_proba Initial mutation probability of every chromosome, in [0, 1]
+     *
+     * Initializes the individual with random genes for each chromosome.
+     */
+    explicit Individu(real mutation_proba) {
+        // Initialiser chaque gène aléatoirement
+        for (size_t i = 0; i < nbVec * dim; i++) {
+            m_bits.set(i, Randomizer::getBits(Nb_bin));
+        }
         
         // Probabilité de mutation par défaut
         for (size_t i = 0; i < nbVec + 1; i++) {
-            m_proba[i] = proba_to_bin(real(0.9));
+            m_bits.set(proba_offset + i, proba_to_bin(mutation_proba));
+        }
+
+        for (size_t i = 0; i < nbVec; i++) {
+            decodeChromosome(i);
         }
     }
 
@@ -87,10 +182,14 @@ public :
 
     /**
      * @brief Gets the complete genome
-     * @return Const reference to the array of chromosomes
+     * @return The unpacked array of chromosomes
      */
-    const genome& getGenome () const {
-        return m_infos;
+    genome getGenome () const {
+        genome g;
+        for (size_t i = 0; i < nbVec; i++) {
+            g[i] = getChromosome(i);
+        }
+        return g;
     }
 
 
@@ -102,7 +201,7 @@ public :
      * @return Value of the gene
      */
     gene getGene(size_t chromo, size_t gene_idx) const {
-        return m_infos[chromo][gene_idx];
+        return m_bits.get(chromo * dim + gene_idx);
     }
 
     /**
@@ -112,7 +211,8 @@ public :
      * @param value New value for the gene
      */
     void setGene (size_t indice_chromosome, size_t indice_gene, integer value) {
-        m_infos[indice_chromosome][indice_gene] = value;
+        m_bits.set(indice_chromosome * dim + indice_gene, value);
+        decodeGene(indice_chromosome, indice_gene);
     }
 
 
@@ -120,10 +220,14 @@ public :
     /**
      * @brief Gets a specific chromosome
      * @param index Index of the chromosome
-     * @return Const reference to the chromosome
+     * @return The unpacked chromosome
      */
-    const chromosome& getChromosome(size_t index) const {
-        return m_infos[index];
+    chromosome getChromosome(size_t index) const {
+        chromosome c;
+        for (size_t j = 0; j < dim; j++) {
+            c[j] = m_bits.get(index * dim + j);
+        }
+        return c;
     }
 
     /**
@@ -132,7 +236,73 @@ public :
      * @param c New chromosome
      */
     void setChromosome (size_t indice, chromosome c) {
-        m_infos[indice] = c;
+        for (size_t j = 0; j < dim; j++) {
+            m_bits.set(indice * dim + j, c[j]);
+        }
+        decodeChromosome(indice);
+    }
+
+
+
+    // =========================================================
+    // Phénotype
+    // =========================================================
+
+    /**
+     * @brief Gets the decoded vectors
+     * @return With CachePhenotype, a const reference to the cache (no decoding);
+     *         otherwise the vectors decoded from the packed genes
+     */
+    std::conditional_t<CachePhenotype, const phenotype&, phenotype> getPhenotype() const {
+        if constexpr (CachePhenotype) {
+            return m_phenotype;
+        } else {
+            phenotype ph;
+            for (size_t i = 0; i < nbVec; i++) decodeChromosomeInto(i, &ph[i][0]);
+            return ph;
+        }
+    }
+
+    /**
+     * @brief The decoded coordinates, contiguous
+     * @return nbVec*dim reals in [min_real, max_real] (see Domain::toDomain for another domain);
+     *         coordinate j of vector i is at index i*dim + j. With CachePhenotype, a view of
+     *         the cache, without copy; otherwise an array decoded from the packed genes, to be
+     *         kept by value (`const auto x = a.coordinates();`) before taking its data()
+     */
+    coordinate_view coordinates() const {
+        if constexpr (CachePhenotype) {
+            static_assert(sizeof(phenotype) == nbVec * dim * sizeof(real), "the phenotype must be a contiguous array of reals");
+            return { &m_phenotype[0][0], nbVec * dim };
+        } else {
+            coordinate_view x;
+            decodeInto(x.data());
+            return x;
+        }
+    }
+
+    /**
+     * @brief Read-only view of the packed storage words, without copy
+     * @return The words of the storage: field k (gene k, then the nbVec+1 mutation probabilities)
+     *         occupies the absolute bits [k*Nb_bin, (k+1)*Nb_bin), see bitpack.h
+     */
+    std::span<const integer> packedGenes() const {
+        return m_bits.words();
+    }
+
+    /**
+     * @brief Decodes the genes into a caller-provided buffer, without allocating
+     * @param out Buffer of at least nbVec*dim reals; coordinate j of vector i is written at out[i*dim + j]
+     *
+     * Reads the packed genes directly (never the cache), so it can be used to fill
+     * structure-of-arrays batches or to check the cache.
+     */
+    void decodeInto(real* out) const {
+        integer genes[nbVec * dim];
+        for (size_t k = 0; k < nbVec * dim; k++) {
+            genes[k] = m_bits.get(k);
+        }
+        kernels().decode_genes(genes, nbVec * dim, out);
     }
 
     // =========================================================
@@ -145,7 +315,7 @@ public :
      * @return Mutation probability as an integer
      */
     integer getMutationProba(size_t index) const {
-        return m_proba[index];
+        return m_bits.get(proba_offset + index);
     }
 
     /**
@@ -154,7 +324,7 @@ public :
      * @param value New probability value
      */
     void setMutationProba(size_t index, integer value) {
-        m_proba[index] = value;
+        m_bits.set(proba_offset + index, value);
     }
 
 
@@ -177,18 +347,134 @@ public :
     void Mutate() {
         for (size_t i=0; i<nbVec; i++) {
             // un while pour avoir possiblement plusieurs mutations
-            while (Randomizer::getProb() <= bin_to_proba(m_proba[i])) {
+            real p = bin_to_proba(m_bits.get(proba_offset + i));
+            while (Randomizer::getProb() <= p) {
                 int l = Randomizer::getInt(0, dim-1); // le locus du gène à modifier
                 int b = Randomizer::getInt(0, Nb_bin-1); // le bit à modifier
-                m_infos[i][l] ^= (integer(1) << b); // on inverse le bit au rang b du gène l du chromosome i
+                m_bits.flip((i * dim + l) * Nb_bin + b); // on inverse le bit au rang b du gène l du chromosome i
+                decodeGene(i, l);
             }
         }
+        mutateProbabilities();
+    }
 
-        // effectuons maintenant la mutation du chromosome des probas de mutations : 
-        while (Randomizer::getProb() <= bin_to_proba(m_proba[nbVec])) {
+    /**
+     * @brief Performs creep mutation on the individual
+     * @param step The largest move of a gene, >= 1
+     *
+     * Same self-adaptive probabilities as Mutate(), but each mutation moves a
+     * gene by a random non-zero step in [-step, step] (clamped to [0, bin_max])
+     * instead of flipping one of its bits: a small move of the coordinate,
+     * where a flip of a high bit jumps across the interval.
+     */
+    void Creep(size_t step) {
+        for (size_t i=0; i<nbVec; i++) {
+            real p = bin_to_proba(m_bits.get(proba_offset + i));
+            while (Randomizer::getProb() <= p) {
+                int l = Randomizer::getInt(0, dim-1);
+                int64_t d = int64_t(Randomizer::bounded(2 * step)) - int64_t(step); // dans [-step, step - 1]
+                if (d >= 0) d++;                                                      // jamais nul
+                int64_t g = std::clamp<int64_t>(int64_t(m_bits.get(i * dim + l)) + d, 0, int64_t(bin_max));
+                m_bits.set(i * dim + l, integer(g));
+                decodeGene(i, l);
+            }
+        }
+        mutateProbabilities();
+    }
+
+    /**
+     * @brief Bit-flip mutation of the probability chromosome (self-adaptation),
+     *        the last step of Mutate() and Creep()
+     */
+    void mutateProbabilities() {
+        while (Randomizer::getProb() <= bin_to_proba(m_bits.get(proba_offset + nbVec))) {
             int chromosome_i = Randomizer::getInt(0, nbVec - 1);  // on détermine quelle proba doit changer
             int b_position   = Randomizer::getInt(0, Nb_bin - 1); // on détermine quel bit inverser
-            m_proba[chromosome_i] ^= (integer(1) << b_position);  // on inverse le bit correspondant
+            m_bits.flip((proba_offset + chromosome_i) * Nb_bin + b_position); // on inverse le bit correspondant
+        }
+    }
+
+
+
+    /**
+     * @brief Number of bits of a chromosome
+     * @param chromo Index of the chromosome, nbVec designating the probability chromosome
+     * @return dim*Nb_bin for a vector chromosome, (nbVec+1)*Nb_bin for the probability chromosome
+     */
+    static constexpr size_t chromosomeBits(size_t chromo) {
+        return (chromo < nbVec ? dim : nbVec + 1) * Nb_bin;
+    }
+
+    /**
+     * @brief One-point crossover of a single chromosome, performed on the packed bits
+     *
+     * @param p1 First parent
+     * @param p2 Second parent
+     * @param child1 Receives the bits of p1 before the cut and the bits of p2 after it
+     * @param child2 Receives the bits of p2 before the cut and the bits of p1 after it
+     * @param chromo Index of the chromosome, nbVec designating the probability chromosome
+     * @param cut Cut position in bits from the start of the chromosome, in [0, chromosomeBits(chromo))
+     *
+     * Only the chromosome @p chromo is written in the children; the cut may fall
+     * inside a gene and inside a storage word.
+     */
+    static void crossChromosome(const Individu& p1, const Individu& p2,
+                                Individu& child1, Individu& child2,
+                                size_t chromo, size_t cut)
+    {
+        size_t first = chromo * dim * Nb_bin; // le chromosome des probas suit directement le dernier vecteur
+        size_t last  = first + chromosomeBits(chromo);
+        storage::splice(p1.m_bits, p2.m_bits, child1.m_bits, child2.m_bits, first, first + cut, last);
+
+        if (chromo < nbVec) {
+            child1.decodeChromosome(chromo);
+            child2.decodeChromosome(chromo);
+        }
+    }
+
+    /**
+     * @brief Two-point crossover of a single chromosome, performed on the packed bits
+     *
+     * Like crossChromosome(p1, p2, child1, child2, chromo, cut), but the bits
+     * from @p second_cut onward come back from the parent of the beginning:
+     * child1 receives p1, then p2 in [cut, second_cut), then p1 again.
+     *
+     * @pre cut <= second_cut < chromosomeBits(chromo)
+     */
+    static void crossChromosome(const Individu& p1, const Individu& p2,
+                                Individu& child1, Individu& child2,
+                                size_t chromo, size_t cut, size_t second_cut)
+    {
+        size_t first = chromo * dim * Nb_bin;
+        size_t last  = first + chromosomeBits(chromo);
+        storage::splice(p1.m_bits, p2.m_bits, child1.m_bits, child2.m_bits, first, first + cut, last);
+        // une coupure au début de [second_cut, last) : child1 y reçoit entièrement p1, child2 p2
+        storage::splice(p2.m_bits, p1.m_bits, child1.m_bits, child2.m_bits, first + second_cut, first + second_cut, last);
+
+        if (chromo < nbVec) {
+            child1.decodeChromosome(chromo);
+            child2.decodeChromosome(chromo);
+        }
+    }
+
+    /**
+     * @brief Uniform crossover: every gene and every mutation probability of
+     *        child1 comes from p1 or p2 with probability 1/2, child2 receiving the other one
+     */
+    static void crossUniform(const Individu& p1, const Individu& p2, Individu& child1, Individu& child2) {
+        constexpr size_t fields = nbVec * dim + nbVec + 1;
+        for (size_t k = 0; k < fields; k += 32) {
+            const size_t count = std::min<size_t>(32, fields - k);
+            uint64_t mask = Randomizer::getBits(int(count)); // un tirage pour 32 champs
+            for (size_t f = k; f < k + count; f++, mask >>= 1) {
+                const bool swap = mask & 1;
+                child1.m_bits.set(f, (swap ? p2 : p1).m_bits.get(f));
+                child2.m_bits.set(f, (swap ? p1 : p2).m_bits.get(f));
+            }
+        }
+        for (size_t i = 0; i < nbVec; i++) {
+            child1.decodeChromosome(i);
+            child2.decodeChromosome(i);
         }
     }
 
@@ -200,8 +486,8 @@ public :
     // ==================================================================================================================
 
 
-    void save_agent(const Agent& agent, const std::string& filename);
-    Agent load_agent(const std::string& filename);
+    void save_agent(const Individu& agent, const std::string& filename);
+    Individu load_agent(const std::string& filename);
 
 
 
@@ -217,19 +503,12 @@ public :
      * @param vec Individual to output
      * @return Modified output stream
      * 
-     * Converts binary representation to real numbers and outputs vectors
+     * Outputs the decoded phenotype, one vector per line
      */
     friend std::ostream& operator<<(std::ostream& os, const Individu& vec) {
-        // on doit transformer l'écriture binaire de chaque vecteur en une écriture réelle
-
+        const auto& ph = vec.getPhenotype();
         for (size_t i=0; i < nbVec ; i++) {
-            Vec<dim> c {};
-            for (size_t j=0; j < dim; j++) {
-                c[j] += bin_to_real(vec.m_infos[i][j]);
-            }
-
-            // a cette ligne, on vient de finir le chromosome c
-            os << c;
+            os << ph[i];
             if (i < nbVec -1) os << '\n';
         }
         return os;
@@ -1,190 +1,382 @@
 #pragma once
+/**
+ * @file Vec.h
+ * @brief Fixed-size vector of reals, with explicit SIMD arithmetic.
+ *
+ * Vec<dim> stores exactly dim reals: an agent's phenotype is an array of Vec
+ * and must stay a contiguous array of reals (Individu::coordinates, the C
+ * interface). The storage is aligned on its size when that costs no padding
+ * (Vec<2>, Vec<4> of double are 16-byte aligned); Vec<3> keeps the alignment
+ * of a real.
+ *
+ * The padding lives in registers instead: +, -, *, /, dot, norm and
+ * distanceSquared process the coordinates by SIMD packs (SSE2, the x86-64
+ * baseline, so no compile option is needed), the last pack being completed
+ * with zero lanes. Elsewhere, and in constant evaluation, plain loops are
+ * used. Reductions sum the packs lane by lane and then the lanes, so dot()
+ * may differ from a left-to-right sum in the last bit.
+ *
+ * Fast operations never throw: operator[], unit(), operator/ and normalized()
+ * trust their preconditions, and a division by zero gives infinities or NaN
+ * as with plain reals. Their checked counterparts - at(), checkedUnit(),
+ * checkedDivide() and checkedNormalized() - throw instead, and are meant for
+ * code outside of the fitness function.
+ */
+
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cmath>
-#include <stdexcept>
+#include <cstddef>
+#include <initializer_list>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
 #include "settings.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GENETIC_VEC_SSE2
+#include <emmintrin.h>
+#endif
+
+
+
+namespace vec_simd {
+
+#ifdef GENETIC_VEC_SSE2
+
+template <class T> struct Lanes;
+
+// deux double par registre
+template <> struct Lanes<double> {
+    using pack = __m128d;
+    static constexpr size_t width = 2;
+
+    static pack load(const double* p) noexcept { return _mm_loadu_pd(p); }
+    static void store(double* p, pack v) noexcept { _mm_storeu_pd(p, v); }
+    // les n < width premières voies ; les autres valent 0
+    static pack loadTail(const double* p, size_t) noexcept { return _mm_load_sd(p); }
+    static void storeTail(double* p, pack v, size_t) noexcept { _mm_store_sd(p, v); }
+
+    static pack broadcast(double x) noexcept { return _mm_set1_pd(x); }
+    static pack zero() noexcept { return _mm_setzero_pd(); }
+    static pack add(pack a, pack b) noexcept { return _mm_add_pd(a, b); }
+    static pack sub(pack a, pack b) noexcept { return _mm_sub_pd(a, b); }
+    static pack mul(pack a, pack b) noexcept { return _mm_mul_pd(a, b); }
+    static pack div(pack a, pack b) noexcept { return _mm_div_pd(a, b); }
+    static double sum(pack v) noexcept { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+};
+
+// quatre float par registre
+template <> struct Lanes<float> {
+    using pack = __m128;
+    static constexpr size_t width = 4;
+
+    static pack load(const float* p) noexcept { return _mm_loadu_ps(p); }
+    static void store(float* p, pack v) noexcept { _mm_storeu_ps(p, v); }
+    static pack loadTail(const float* p, size_t n) noexcept {
+        return _mm_set_ps(0.f, n > 2 ? p[2] : 0.f, n > 1 ? p[1] : 0.f, p[0]);
+    }
+    static void storeTail(float* p, pack v, size_t n) noexcept {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, v);
+        for (size_t i = 0; i < n; i++) p[i] = lanes[i];
+    }
+
+    static pack broadcast(float x) noexcept { return _mm_set1_ps(x); }
+    static pack zero() noexcept { return _mm_setzero_ps(); }
+    static pack add(pack a, pack b) noexcept { return _mm_add_ps(a, b); }
+    static pack sub(pack a, pack b) noexcept { return _mm_sub_ps(a, b); }
+    static pack mul(pack a, pack b) noexcept { return _mm_mul_ps(a, b); }
+    static pack div(pack a, pack b) noexcept { return _mm_div_ps(a, b); }
+    static float sum(pack v) noexcept {
+        const __m128 h = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        return _mm_cvtss_f32(_mm_add_ss(h, _mm_shuffle_ps(h, h, 1)));
+    }
+};
+
+// Lanes<T> n'existe que pour ces deux types : un autre real (long double...) garde les boucles simples
+template <class T>
+inline constexpr bool enabled = std::is_same_v<T, double> || std::is_same_v<T, float>;
+
+#else
+
+template <class T>
+inline constexpr bool enabled = false;
+
+#endif
+
+/// out[i] = op(a[i], b[i]) for i < n, by packs then one zero-completed pack
+template <class L, size_t n, class Op>
+inline void map(const real* a, const real* b, real* out, Op op) noexcept {
+    size_t i = 0;
+    for (; i + L::width <= n; i += L::width) L::store(out + i, op(L::load(a + i), L::load(b + i)));
+    if constexpr (n % L::width != 0) L::storeTail(out + i, op(L::loadTail(a + i, n - i), L::loadTail(b + i, n - i)), n - i);
+}
+
+/// out[i] = op(a[i], s) for i < n
+template <class L, size_t n, class Op>
+inline void mapScalar(const real* a, real s, real* out, Op op) noexcept {
+    const auto b = L::broadcast(s);
+    size_t i = 0;
+    for (; i + L::width <= n; i += L::width) L::store(out + i, op(L::load(a + i), b));
+    if constexpr (n % L::width != 0) L::storeTail(out + i, op(L::loadTail(a + i, n - i), b), n - i);
+}
+
+/// sum of f(a[i], b[i]) for i < n, f being lane-wise; the zero lanes of the last pack must give 0
+template <class L, size_t n, class F>
+inline real reduce(const real* a, const real* b, F f) noexcept {
+    auto acc = L::zero();
+    size_t i = 0;
+    for (; i + L::width <= n; i += L::width) acc = L::add(acc, f(L::load(a + i), L::load(b + i)));
+    if constexpr (n % L::width != 0) acc = L::add(acc, f(L::loadTail(a + i, n - i), L::loadTail(b + i, n - i)));
+    return L::sum(acc);
+}
+
+} // namespace vec_simd
+
+
+
 template <size_t dim>
 class Vec {
 private:
-    std::array<real, dim> m_Coordinates;
+    // aligné sur un registre (ou sa taille, si elle est plus petite) quand celle-ci est une puissance de 2 :
+    // jamais de remplissage entre deux Vec
+    static constexpr size_t storage_alignment =
+        std::has_single_bit(dim * sizeof(real)) ? std::min<size_t>(dim * sizeof(real), 16) : alignof(real);
+
+    alignas(storage_alignment) std::array<real, dim> m_Coordinates;
+
+#ifdef GENETIC_VEC_SSE2
+    // dépend de dim pour que L::add et les autres ne soient résolus que dans les branches instanciées,
+    // celles où vec_simd::enabled<real> : Lanes<long double> n'est jamais défini
+    using L = vec_simd::Lanes<std::conditional_t<dim != 0, real, real>>;
+#endif
+
+    // true hors évaluation constante, où les paquets SIMD ne sont pas utilisables ; testé sous vec_simd::enabled<real>
+    static constexpr bool simd() noexcept {
+        return !std::is_constant_evaluated();
+    }
 
 public:
     // Constructeurs
-    Vec() : m_Coordinates{} {} // Initialise à zéro
-    
-    Vec(std::array<real, dim> coord) : m_Coordinates(coord) {}
-    
+    constexpr Vec() noexcept : m_Coordinates{} {} // Initialise à zéro
+
+    constexpr Vec(std::array<real, dim> coord) noexcept : m_Coordinates(coord) {}
+
+    // vérifie le nombre d'éléments : à réserver à l'initialisation, pas à la fonction fitness
     Vec(std::initializer_list<real> list) {
         if (list.size() != dim) {
             throw std::invalid_argument("Nombre d'éléments incorrect");
         }
         std::copy(list.begin(), list.end(), m_Coordinates.begin());
     }
-    
+
     // Accesseurs
-    real& operator[](size_t index) {
+    constexpr real& operator[](size_t index) noexcept {
         return m_Coordinates[index];
     }
-    
-    const real& operator[](size_t index) const {
+
+    constexpr const real& operator[](size_t index) const noexcept {
         return m_Coordinates[index];
     }
-    
+
     real& at(size_t index) {
         if (index >= dim) {
             throw std::out_of_range("Index hors limites");
         }
         return m_Coordinates[index];
     }
-    
+
     const real& at(size_t index) const {
         if (index >= dim) {
             throw std::out_of_range("Index hors limites");
         }
         return m_Coordinates[index];
     }
-    
-    size_t size() const { return dim; }
-    
+
+    real* data() noexcept { return m_Coordinates.data(); }
+    const real* data() const noexcept { return m_Coordinates.data(); }
+
+    static constexpr size_t size() noexcept { return dim; }
+
     // Opérateurs arithmétiques
-    constexpr Vec operator+() const {
+    constexpr Vec operator+() const noexcept {
         return *this; // Unaire positif
     }
-    
-    constexpr Vec operator-() const {
-        Vec result;
-        for (size_t i = 0; i < dim; ++i) {
-            result[i] = -m_Coordinates[i];
-        }
-        return result;
+
+    constexpr Vec operator-() const noexcept {
+        return *this * real(-1);
     }
-    
-    constexpr Vec operator+(const Vec& other) const {
+
+    constexpr Vec operator+(const Vec& other) const noexcept {
         Vec result;
+#ifdef GENETIC_VEC_SSE2
+        if constexpr (vec_simd::enabled<real>) {
+            if (simd()) {
+                vec_simd::map<L, dim>(data(), other.data(), result.data(), L::add);
+                return result;
+            }
+        }
+#endif
         for (size_t i = 0; i < dim; ++i) {
             result[i] = m_Coordinates[i] + other[i];
         }
         return result;
     }
-    
-    constexpr Vec operator-(const Vec& other) const {
+
+    constexpr Vec operator-(const Vec& other) const noexcept {
         Vec result;
+#ifdef GENETIC_VEC_SSE2
+        if constexpr (vec_simd::enabled<real>) {
+            if (simd()) {
+                vec_simd::map<L, dim>(data(), other.data(), result.data(), L::sub);
+                return result;
+            }
+        }
+#endif
         for (size_t i = 0; i < dim; ++i) {
             result[i] = m_Coordinates[i] - other[i];
         }
         return result;
     }
-    
+
     // Multiplication par un scalaire
-    constexpr Vec operator*(real scalar) const {
+    constexpr Vec operator*(real scalar) const noexcept {
         Vec result;
+#ifdef GENETIC_VEC_SSE2
+        if constexpr (vec_simd::enabled<real>) {
+            if (simd()) {
+                vec_simd::mapScalar<L, dim>(data(), scalar, result.data(), L::mul);
+                return result;
+            }
+        }
+#endif
         for (size_t i = 0; i < dim; ++i) {
             result[i] = m_Coordinates[i] * scalar;
         }
         return result;
     }
-    
-    // Division par un scalaire
-    constexpr Vec operator/(real scalar) const {
-        if (scalar == 0) {
-            throw std::invalid_argument("Division par zéro");
-        }
+
+    // Division par un scalaire, sans vérification : diviser par 0 donne des infinis ou NaN
+    constexpr Vec operator/(real scalar) const noexcept {
         Vec result;
+#ifdef GENETIC_VEC_SSE2
+        if constexpr (vec_simd::enabled<real>) {
+            if (simd()) {
+                vec_simd::mapScalar<L, dim>(data(), scalar, result.data(), L::div);
+                return result;
+            }
+        }
+#endif
         for (size_t i = 0; i < dim; ++i) {
             result[i] = m_Coordinates[i] / scalar;
         }
         return result;
     }
-    
-    // Opérateurs d'assignation
-    Vec& operator+=(const Vec& other) {
-        for (size_t i = 0; i < dim; ++i) {
-            m_Coordinates[i] += other[i];
+
+    // Division par un scalaire non nul
+    Vec checkedDivide(real scalar) const {
+        if (scalar == 0) {
+            throw std::invalid_argument("Division par zéro");
         }
-        return *this;
+        return *this / scalar;
     }
-    
-    Vec& operator-=(const Vec& other) {
-        for (size_t i = 0; i < dim; ++i) {
-            m_Coordinates[i] -= other[i];
-        }
-        return *this;
+
+    // Opérateurs d'assignation
+    constexpr Vec& operator+=(const Vec& other) noexcept {
+        return *this = *this + other;
     }
-    
-    Vec& operator*=(real scalar) {
-        for (size_t i = 0; i < dim; ++i) {
-            m_Coordinates[i] *= scalar;
-        }
-        return *this;
+
+    constexpr Vec& operator-=(const Vec& other) noexcept {
+        return *this = *this - other;
     }
-    
-    Vec& operator/=(real scalar) {
-        if (scalar == 0) {
-            throw std::invalid_argument("Division par zéro");
-        }
-        for (size_t i = 0; i < dim; ++i) {
-            m_Coordinates[i] /= scalar;
-        }
-        return *this;
+
+    constexpr Vec& operator*=(real scalar) noexcept {
+        return *this = *this * scalar;
     }
-    
+
+    constexpr Vec& operator/=(real scalar) noexcept {
+        return *this = *this / scalar;
+    }
+
     // Opérateurs de comparaison
-    bool operator==(const Vec& other) const {
+    constexpr bool operator==(const Vec& other) const noexcept {
         return m_Coordinates == other.m_Coordinates;
     }
-    
-    bool operator!=(const Vec& other) const {
+
+    constexpr bool operator!=(const Vec& other) const noexcept {
         return !(*this == other);
     }
-    
+
     // Produit scalaire
-    constexpr real dot(const Vec& other) const {
+    constexpr real dot(const Vec& other) const noexcept {
+#ifdef GENETIC_VEC_SSE2
+        if constexpr (vec_simd::enabled<real>) {
+            if (simd()) {
+                return vec_simd::reduce<L, dim>(data(), other.data(), L::mul);
+            }
+        }
+#endif
         real result = 0;
         for (size_t i = 0; i < dim; ++i) {
             result += m_Coordinates[i] * other[i];
         }
         return result;
     }
-    
+
     // Norme
-    constexpr real norm() const {
+    constexpr real norm() const noexcept {
         return std::sqrt(dot(*this));
     }
-    
-    constexpr real normSquared() const {
+
+    constexpr real normSquared() const noexcept {
         return dot(*this);
     }
-    
-    // Normalisation
-    constexpr Vec normalized() const {
-        real n = norm();
+
+    // Normalisation, sans vérification : le vecteur nul donne NaN
+    constexpr Vec normalized() const noexcept {
+        return *this / norm();
+    }
+
+    constexpr void normalize() noexcept {
+        *this = normalized();
+    }
+
+    // Normalisation d'un vecteur non nul
+    Vec checkedNormalized() const {
         if (isZero()) {
             throw std::runtime_error("Impossible de normaliser un vecteur nul");
         }
-        return *this / n;
+        return normalized();
     }
-    
-    constexpr void normalize() {
-        *this = normalized();
-    }
-    
+
     // Distance
-    constexpr real distance(const Vec& other) const {
-        return (*this - other).norm();
+    constexpr real distance(const Vec& other) const noexcept {
+        return std::sqrt(distanceSquared(other));
     }
-    
-    constexpr real distanceSquared(const Vec& other) const {
+
+    constexpr real distanceSquared(const Vec& other) const noexcept {
+#ifdef GENETIC_VEC_SSE2
+        if constexpr (vec_simd::enabled<real>) {
+            if (simd()) {
+                // la différence reste dans les registres : aucun Vec temporaire
+                return vec_simd::reduce<L, dim>(data(), other.data(), [](auto a, auto b) {
+                    const auto d = L::sub(a, b);
+                    return L::mul(d, d);
+                });
+            }
+        }
+#endif
         return (*this - other).normSquared();
     }
-    
+
     // Itérateurs
     auto begin() { return m_Coordinates.begin(); }
     auto end() { return m_Coordinates.end(); }
     auto begin() const { return m_Coordinates.begin(); }
     auto end() const { return m_Coordinates.end(); }
-    
+
     // Affichage
     friend std::ostream& operator<<(std::ostream& os, const Vec& vec) {
         os << "(";
@@ -200,30 +392,35 @@ public:
 
     // méthodes utiles
 
-    // Vecteur unitaire selon un axe
-    static Vec unit(size_t axis) {
-        if (axis >= dim) {
-            throw std::out_of_range("Axe invalide");
-        }
+    // Vecteur unitaire selon un axe, sans vérification : axis < dim
+    static constexpr Vec unit(size_t axis) noexcept {
         Vec result;
         result[axis] = 1.0;
         return result;
     }
 
+    // Vecteur unitaire selon un axe valide
+    static Vec checkedUnit(size_t axis) {
+        if (axis >= dim) {
+            throw std::out_of_range("Axe invalide");
+        }
+        return unit(axis);
+    }
+
     // Vérifier si le vecteur est proche de zéro
-    constexpr bool isZero(real epsilon = 1e-10) const {
+    constexpr bool isZero(real epsilon = 1e-10) const noexcept {
         return normSquared() < epsilon * epsilon;
     }
 
     // Projection sur un autre vecteur
-    constexpr Vec projectOn(const Vec& other) const {
+    constexpr Vec projectOn(const Vec& other) const noexcept {
         real otherNormSq = other.normSquared();
-    
+
         // Utilise une petite tolérance pour la vérification
-        if (std::abs(otherNormSq) < 1e-10) { 
+        if (std::abs(otherNormSq) < 1e-10) {
             return Vec(); // Projection sur un vecteur nul est un vecteur nul
         }
-        return other * (dot(other) / other.normSquared());
+        return other * (dot(other) / otherNormSq);
     }
 
 
@@ -236,8 +433,8 @@ public:
     // dim = 3
 
     template <size_t D = dim>
-    constexpr std::enable_if_t<D == 3, Vec> cross(const Vec& other) const {
-        return Vec({
+    constexpr std::enable_if_t<D == 3, Vec> cross(const Vec& other) const noexcept {
+        return Vec(std::array<real, 3>{
             m_Coordinates[1] * other[2] - m_Coordinates[2] * other[1],
             m_Coordinates[2] * other[0] - m_Coordinates[0] * other[2],
             m_Coordinates[0] * other[1] - m_Coordinates[1] * other[0]
@@ -247,7 +444,7 @@ public:
 
 // Opérateur scalaire * vecteur (ordre inversé)
 template <size_t dim>
-constexpr Vec<dim> operator*(real scalar, const Vec<dim>& vec) {
+constexpr Vec<dim> operator*(real scalar, const Vec<dim>& vec) noexcept {
     return vec * scalar;
 }
 
@@ -260,6 +457,6 @@ using Vec4 = Vec<4>;
 
 
 
-inline Vec3 makeVec3(real x, real y, real z) {
-    return Vec3({x, y, z});
-}
\ No newline at end of file
+constexpr Vec3 makeVec3(real x, real y, real z) noexcept {
+    return Vec3(std::array<real, 3>{x, y, z});
+}
@@ -0,0 +1,80 @@
+#pragma once
+/**
+ * @file benchmarks.h
+ * @brief Standard test functions, and the comparison of two benchmark result files.
+ *
+ * A run whose Domain names a benchmark evaluates that function instead of
+ * fitness() (or fitness_expression), with every engine. The function reads
+ * the first Domain::benchmark_dims coordinates of the agent, vector after
+ * vector (all of them when 0): its dimension is chosen at run time, up to
+ * NumberOfVectors * Dimension. The other coordinates do not count.
+ *
+ * Every function is minimized at 0 in the literature; the engines maximize,
+ * so the fitness is -f(x) and the optimum is a fitness of 0. Thresholds
+ * such as "reach -1e-3" therefore mean the same on every function.
+ *
+ *   function     f(x)                                                      standard interval
+ *   sphere       sum x²                                                    [-5.12, 5.12]
+ *   rastrigin    10 n + sum (x² - 10 cos 2 pi x)                           [-5.12, 5.12]
+ *   rosenbrock   sum 100 (x[i+1] - x[i]²)² + (1 - x[i])²  (n >= 2)         [-5, 10]
+ *   ackley       20 + e - 20 exp(-0.2 sqrt(sum x² / n)) - exp(sum cos 2 pi x / n)   [-32.768, 32.768]
+ *   schwefel     418.9829 n - sum x sin sqrt|x|                            [-500, 500]
+ *   griewank     1 + sum x² / 4000 - prod cos(x[i] / sqrt(i + 1))          [-600, 600]
+ *
+ * The genetic_bench program runs them all through the sweep runner (sweep.h)
+ * and compares two of its result files: see compare_runs().
+ */
+
+#include "settings.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+
+
+enum class Benchmark { None, Sphere, Rastrigin, Rosenbrock, Ackley, Schwefel, Griewank };
+
+constexpr size_t BenchmarkCount = 7; // None compris
+
+/// The name of a benchmark ("none", "sphere", "rastrigin"...).
+const char* to_string(Benchmark b);
+
+/**
+ * @brief The benchmark named @p name, as printed by to_string.
+ * @throw std::invalid_argument if @p name is not a benchmark.
+ */
+Benchmark parse_benchmark(const std::string& name);
+
+/**
+ * @brief -f(x) for the benchmark @p b on the @p n coordinates @p x.
+ * @pre b != Benchmark::None.
+ */
+real evaluate_benchmark(Benchmark b, const real* x, size_t n);
+
+/**
+ * @brief The standard search interval of @p b, written into @p min and @p max.
+ */
+void benchmark_interval(Benchmark b, real& min, real& max);
+
+
+
+/**
+ * @brief The specification of the standard suite run by genetic_bench
+ *        (sweep.h format): every function against every engine, at equal
+ *        evaluation budget, with fixed seeds and fitness targets.
+ */
+extern const char* const default_benchmark_suite;
+
+/**
+ * @brief Compares two result files of the same suite, @p base and @p next.
+ *
+ * Runs are grouped by configuration (every parameter column but the run
+ * number and the seed). For each configuration, prints the median best
+ * fitness of both files and, for each target, how many runs reached it and
+ * the median evaluations and seconds they needed, with the next / base
+ * ratio: below 1 is faster.
+ *
+ * @throw std::runtime_error if a file is not a sweep result file.
+ */
+void compare_runs(std::istream& base, std::istream& next, std::ostream& out);
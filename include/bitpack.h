@@ -0,0 +1,136 @@
+#pragma once
+/**
+ * @file bitpack.h
+ * @brief Fixed-width bit-packed storage for genes.
+ *
+ * PackedArray stores @p count unsigned fields of exactly @p width bits each,
+ * back to back, in an array of `integer` words. A field may straddle two
+ * consecutive words; get() and set() handle the spill transparently.
+ *
+ * Layout: field i occupies the absolute bits [i*width, (i+1)*width), bit 0 of
+ * a field being its least significant bit, and absolute bit n living in word
+ * n / word_bits at position n % word_bits. A contiguous range of fields is
+ * therefore a contiguous range of bits, which is what splice() relies on to
+ * perform a one-point crossover directly on the packed words.
+ *
+ * All operations are O(1) (get, set, flip) or O(words touched) (splice, which
+ * runs the crossover kernel of kernels.h), do not allocate and do not throw.
+ */
+
+#include "settings.h"
+#include "kernels.h"
+
+#include <array>
+#include <climits>
+#include <cstddef>
+
+
+
+template <size_t width, size_t count>
+class PackedArray {
+public:
+    /**
+     * @typedef word
+     * @brief Storage unit. Using the gene type keeps the packed footprint
+     *        never larger than the unpacked one.
+     */
+    using word = integer;
+
+    static constexpr size_t word_bits  = sizeof(word) * CHAR_BIT;                  // nombre de bits par mot
+    static constexpr size_t total_bits = width * count;                             // nombre de bits utiles
+    static constexpr size_t word_count = (total_bits + word_bits - 1) / word_bits;  // nombre de mots stockés
+
+    static_assert(width >= 1 && width <= word_bits, "a packed field must fit in one storage word");
+
+    /// Mask selecting the low @p width bits of a word.
+    static constexpr word field_mask = (width == word_bits) ? ~word(0) : ((word(1) << width) - 1);
+
+private:
+    std::array<word, word_count> m_words;
+
+    // un champ ne peut chevaucher deux mots que si width ne divise pas word_bits
+    static constexpr bool may_straddle = (word_bits % width) != 0;
+
+public:
+    /**
+     * @brief Zero-initialized storage.
+     */
+    constexpr PackedArray() noexcept : m_words{} {}
+
+
+
+    /**
+     * @brief Reads field @p i.
+     * @param i Field index, in [0, count).
+     * @return The field value, in [0, 2^width - 1].
+     */
+    integer get(size_t i) const noexcept {
+        size_t bit = i * width;
+        size_t w   = bit / word_bits;
+        size_t off = bit % word_bits;
+
+        word v = m_words[w] >> off;
+        if constexpr (may_straddle) {
+            if (off + width > word_bits) v |= m_words[w + 1] << (word_bits - off);
+        }
+        return static_cast<integer>(v & field_mask);
+    }
+
+    /**
+     * @brief Writes field @p i. Bits of @p value above @p width are dropped.
+     * @param i Field index, in [0, count).
+     * @param value New value of the field.
+     */
+    void set(size_t i, integer value) noexcept {
+        size_t bit = i * width;
+        size_t w   = bit / word_bits;
+        size_t off = bit % word_bits;
+        word v = static_cast<word>(value) & field_mask;
+
+        m_words[w] = (m_words[w] & ~(field_mask << off)) | (v << off);
+        if constexpr (may_straddle) {
+            if (off + width > word_bits) {
+                size_t spill = word_bits - off;       // nombre de bits écrits dans le premier mot
+                word hi_mask = field_mask >> spill;   // bits restants, dans le mot suivant
+                m_words[w + 1] = (m_words[w + 1] & ~hi_mask) | (v >> spill);
+            }
+        }
+    }
+
+    /**
+     * @brief Inverts one bit.
+     * @param bit Absolute bit position, in [0, total_bits).
+     */
+    void flip(size_t bit) noexcept {
+        m_words[bit / word_bits] ^= word(1) << (bit % word_bits);
+    }
+
+
+
+    /**
+     * @brief One-point crossover on the absolute bit range [first, last).
+     *
+     * Inside the range, @p c1 receives the bits of @p a below @p cut and the bits
+     * of @p b from @p cut onward; @p c2 receives the opposite. Bits outside the
+     * range are left untouched in both children. The cut may fall anywhere,
+     * including in the middle of a field or of a storage word.
+     *
+     * @pre first <= cut <= last <= total_bits
+     */
+    static void splice(const PackedArray& a, const PackedArray& b,
+                       PackedArray& c1, PackedArray& c2,
+                       size_t first, size_t cut, size_t last) noexcept
+    {
+        // les masques de croisement sont calculés par le noyau de la variante du processeur (kernels.h)
+        kernels().splice(a.m_words.data(), b.m_words.data(), c1.m_words.data(), c2.m_words.data(), first, cut, last);
+    }
+
+
+
+    /**
+     * @brief Raw access to the packed words (e.g. for popcount-based metrics).
+     */
+    const std::array<word, word_count>& words() const noexcept {
+        return m_words;
+    }
+};
@@ -0,0 +1,96 @@
+#pragma once
+/**
+ * @file cmaes.h
+ * @brief CmaEs: the covariance matrix adaptation evolution strategy on the
+ *        real coordinates of the vectors.
+ *
+ * The (mu/mu_w, lambda) strategy with cumulative step-size adaptation
+ * (Hansen, "The CMA Evolution Strategy: A Tutorial"). Each generation:
+ *   - samples lambda points x = m + sigma * B * D * z, z ~ N(0, I), drawn on
+ *     the calling thread, then clipped to the domain;
+ *   - evaluates them as one batch on the pool;
+ *   - moves the mean to the weighted mean of the mu best, updates the
+ *     evolution paths, the step size, and the covariance C with the rank-one
+ *     and rank-mu updates (O(mu n^2), on the upper triangle only).
+ *
+ * The eigendecomposition C = B D^2 B^T (cyclic Jacobi, O(n^3)) is the costly
+ * part: it only runs every CmaEigenInterval generations, or every
+ * 1 / (10 n (c1 + cmu)) generations when that setting is 0, as recommended.
+ * In between, sampling keeps the last B and D.
+ *
+ * The run stops as converged once sigma * max(D) falls below 1e-12 of the
+ * domain width or once the condition number of C exceeds 1e14.
+ */
+
+#include "optimizer.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+
+class CmaEs : public Optimizer {
+private:
+    size_t m_lambda = 0;                // les points tirés par génération
+    size_t m_mu = 0;                    // les meilleurs, recombinés
+    std::vector<real> m_weights;        // leurs poids (décroissants, de somme 1)
+    real m_mueff = 0, m_cc = 0, m_cs = 0, m_c1 = 0, m_cmu = 0, m_damps = 0, m_chin = 0;
+    size_t m_eigen_interval = 1;        // les générations entre deux décompositions
+
+    std::vector<real> m_mean;           // la moyenne m
+    real m_sigma = 0;                   // le pas
+    std::vector<real> m_pc, m_ps;       // les chemins d'évolution
+    std::vector<real> m_C;              // la covariance, n × n par lignes
+    std::vector<real> m_B;              // ses vecteurs propres, en colonnes
+    std::vector<real> m_D;              // les racines de ses valeurs propres
+    std::vector<real> m_invsqrtC;       // C^{-1/2} = B D^{-1} B^T
+    size_t m_eigen_generation = 0;      // la génération de la dernière décomposition
+
+    std::vector<real> m_z;              // les tirages normaux de la génération, lambda × n
+    std::vector<real> m_y;              // les pas (x - m) / sigma, lambda × n
+    std::vector<Agent::phenotype> m_points;
+    std::vector<real> m_values;
+    std::vector<size_t> m_order;        // les points du meilleur au moins bon
+
+    Solution m_best;                    // le meilleur point évalué depuis init()
+    bool m_converged = false;
+
+    void sample();
+    void update();
+    void decompose();
+    void publishMetrics(double seconds, size_t evaluations, size_t evaluated);
+
+public:
+    /**
+     * @param params Parameters of the run; lambda = params.continuous_population,
+     *        4 + 3 ln n when 0.
+     * @param pool Pool running the evaluations, nullptr to run serially on the caller.
+     * @throw std::invalid_argument if @p params is invalid.
+     */
+    explicit CmaEs(const Parameters& params, ThreadPool* pool = &ThreadPool::global());
+
+    /**
+     * @brief Seeds the generators, draws the initial mean uniformly in the
+     *        domain and sets sigma to 0.3 times its width. Evaluates nothing.
+     */
+    void init() override;
+
+    void step(size_t n = 1) override;
+
+    bool finished() const override { return Optimizer::finished() || m_converged; }
+    StopReason stopReason() const override;
+
+    Solution bestSolution() const override { return m_best; }
+    void printBest(std::ostream& os) override;
+
+    /**
+     * @brief population.gen: the parameter line (with sigma), then the mean,
+     *        the paths pc and ps and the n rows of C; plus best.ind.
+     */
+    void saveCheckpoint(const std::string& folder) const override;
+
+    size_t populationSize() const override { return m_lambda; }
+    real sigma() const { return m_sigma; }
+};
@@ -0,0 +1,76 @@
+#pragma once
+/**
+ * @file differential_evolution.h
+ * @brief DifferentialEvolution: DE/rand/1/bin on the real coordinates of the vectors.
+ *
+ * The population is a set of points of the domain (Parameters::domain),
+ * NumberOfVectors * Dimension coordinates each, with no genes at all. Each
+ * generation builds one trial per point:
+ *   - mutation: v = x[r1] + F * (x[r2] - x[r3]), with r1, r2, r3 distinct
+ *     random points other than the target (F = Parameters::de_weight);
+ *   - binomial crossover: each coordinate comes from v with probability
+ *     Parameters::de_crossover, one random coordinate always does;
+ *   - a coordinate leaving the domain is brought back halfway between the
+ *     target and the bound it crossed.
+ * The trials are evaluated as one batch on the pool, then each replaces its
+ * target if its fitness is at least as good.
+ *
+ * The trials are drawn on the calling thread: a run is reproducible for a
+ * given seed whatever the number of workers.
+ */
+
+#include "optimizer.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <vector>
+
+
+
+class DifferentialEvolution : public Optimizer {
+private:
+    std::vector<Agent::phenotype> m_points;         // la population
+    std::vector<real>             m_fitness;        // leur fitness, NaN pour un point jamais évalué
+    std::vector<Agent::phenotype> m_trials;         // les essais de la génération en cours
+    std::vector<real>             m_trial_fitness;
+
+    Solution m_best;                                // le meilleur point évalué depuis init()
+
+    // retient le meilleur des count premiers points évalués
+    void trackBest(std::span<const Agent::phenotype> points, const real* values, size_t count);
+    void publishMetrics(double seconds, size_t evaluations);
+
+public:
+    /**
+     * @param params Parameters of the run; the population holds
+     *        params.continuous_population points, 10 per coordinate when 0.
+     * @param pool Pool running the evaluations, nullptr to run serially on the caller.
+     * @throw std::invalid_argument if @p params is invalid.
+     */
+    explicit DifferentialEvolution(const Parameters& params, ThreadPool* pool = &ThreadPool::global());
+
+    /**
+     * @brief Seeds the generators, spreads the population over the domain
+     *        (Parameters::initialization) and evaluates it.
+     */
+    void init() override;
+
+    void step(size_t n = 1) override;
+
+    Solution bestSolution() const override { return m_best; }
+    void printBest(std::ostream& os) override;
+
+    /**
+     * @brief population.gen: the parameter line, then one point per line
+     *        (its coordinates, then its fitness); plus best.ind.
+     */
+    void saveCheckpoint(const std::string& folder) const override;
+
+    size_t populationSize() const override { return m_points.size(); }
+
+    /// The current population and its fitness (NaN for a point never evaluated).
+    std::span<const Agent::phenotype> points() const { return m_points; }
+    std::span<const real> fitness() const { return m_fitness; }
+};
@@ -0,0 +1,69 @@
+#pragma once
+/**
+ * @file diversity.h
+ * @brief Genotype and phenotype diversity metrics of a population.
+ *
+ * These metrics show a diversity collapse before the fitness stalls. They
+ * need no fitness evaluation and draw no random number, so computing them
+ * never changes the course of a seeded run.
+ *
+ * Cost: the metrics are computed on at most `sample` agents taken at a
+ * regular stride (the population order comes from the random pairing of the
+ * crossover, so a stride is an unbiased sample); with the default sample of
+ * DiversitySample agents this is a small fraction of a generation.
+ *
+ *   - Allele frequencies come from column popcounts: each packed storage word
+ *     of an agent is added to bit-sliced vertical counters (one counter per
+ *     bit of the genome, amortized two word operations per addition), so the
+ *     whole sample costs O(m * bits / 32) word operations.
+ *   - The mean pairwise Hamming distance follows exactly from these
+ *     frequencies: sum over the bits of 2 f (1 - f) * m / (m - 1). No pair
+ *     of agents has to be compared.
+ *   - Duplicates are found by hashing the packed words; agents sharing a hash
+ *     are compared with the Hamming kernel (XOR + popcount, kernels.h).
+ */
+
+#include "genetic.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+
+
+/**
+ * @struct DiversityMetrics
+ * @brief The diversity of one generation.
+ */
+struct DiversityMetrics {
+    size_t sampled = 0;                 // le nombre d'agents sur lesquels les métriques ont été calculées
+
+    real mean_hamming = 0;              // distance de Hamming moyenne entre deux agents, en bits (gènes et probabilités)
+    real mean_hamming_ratio = 0;        // la même, rapportée au nombre de bits d'un agent (0.5 pour des agents aléatoires)
+
+    std::vector<real> allele_frequency; // pour chaque bit du génome compacté, la part des agents où il vaut 1
+
+    std::array<real, NumberOfVectors * Dimension> spread {}; // écart-type de chaque coordonnée décodée / (max_real - min_real)
+
+    real duplicate_ratio = 0;           // la part des agents qui sont la copie exacte d'un autre agent de l'échantillon
+};
+
+
+
+/**
+ * @brief Computes the diversity metrics of @p p.
+ * @param p The population (may be empty).
+ * @param pool The pool computing the partial counts (nullptr = serial).
+ * @param sample Maximum number of agents examined (0 = every agent).
+ */
+DiversityMetrics diversity_metrics (const Population& p, ThreadPool* pool, size_t sample = DiversitySample);
+
+
+/**
+ * @brief Phenotypic diversity of a population.
+ *
+ * The spread of DiversityMetrics averaged over the coordinates, computed on
+ * every agent: about 0.29 for uniformly random agents, 0 when every agent is
+ * identical.
+ */
+real diversity (const Population& p, ThreadPool* pool);
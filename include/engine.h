@@ -0,0 +1,287 @@
+#pragma once
+/**
+ * @file engine.h
+ * @brief GeneticEngine: one independent run of the genetic algorithm.
+ *
+ * An engine owns its parameters, its populations and its counters; several
+ * engines can therefore live in the same process. Each engine runs its
+ * operators on the ThreadPool it was given, or serially on the calling thread
+ * when that pool is nullptr (which is how the sweep runner executes many
+ * engines concurrently, one per pool worker).
+ *
+ * Monitoring: each generation is published to an EngineMetrics block (see
+ * metrics.h) that a MetricsServer can expose while the run goes on. Once a
+ * server watches it, the engine also publishes the best and mean fitness of
+ * each generation: it then evaluates the generation at the end of step()
+ * instead of inside the next tournaments, which costs the same number of
+ * evaluations and does not change the run.
+ *
+ * Anytime runs: besides max_gen, a run stops at Parameters::time_limit,
+ * after Parameters::max_evaluations, or on SIGINT / SIGTERM (stop.h). These
+ * conditions are checked between the stages of a generation and every 16
+ * evaluations (one fx::block) inside the evaluation batches, the rounds of
+ * the memetic local search included; a generation interrupted before its
+ * mutations is dropped, so the population is always a complete one, and an
+ * interrupted local search keeps the improvements it already found. The
+ * best agent evaluated since init() stays available through bestSoFar().
+ *
+ * Reproducibility: with a non-zero Parameters::seed, init() reseeds the
+ * Randomizer of the calling thread and of every pool worker, so a run is
+ * reproducible as long as no other engine draws on the same threads between
+ * its steps.
+ *
+ * GeneticEngine is the Algorithm::Genetic implementation of Optimizer
+ * (optimizer.h), which holds the counters, stopping rules and seeding shared
+ * with the continuous engines.
+ */
+
+#include "diversity.h"
+#include "metrics.h"
+#include "genetic.h"
+#include "operators.h"
+#include "optimizer.h"
+#include "parameters.h"
+#include "parallel.h"
+#include "surrogate.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+
+
+/**
+ * @struct BestAgent
+ * @brief The best agent of a generation.
+ */
+struct BestAgent {
+    size_t index = 0;               // son indice dans la population
+    real fitness = 0;               // sa fitness
+    const Agent* agent = nullptr;   // l'agent lui-même, valide jusqu'au prochain step() (nullptr si aucun agent évalué)
+    size_t generation = 0;          // la génération dont il fait partie
+};
+
+
+
+class GeneticEngine : public Optimizer {
+private:
+    Population     m_population;    // la génération courante
+    Population     m_children;      // la génération en construction
+    std::vector<ParentIndex> m_parents; // les indices des parents sélectionnés dans m_population
+
+    std::vector<real> m_fitness;                    // la fitness de chaque agent de la génération courante
+    size_t m_fitness_generation = size_t(-1);       // la génération à laquelle m_fitness correspond
+    size_t m_fitness_partial = size_t(-1);          // la génération dont m_fitness est en partie évaluée (NaN pour les autres)
+    std::vector<size_t> m_pending;                  // les agents que fitness() doit encore évaluer
+
+    std::vector<real> m_sums;                       // UseDeltaFitness : la somme des contributions de chaque agent (NaN si inconnue)
+    std::vector<real> m_reference_sums;             // celles de la génération précédente, encore intacte dans m_children
+    bool m_delta = false;                           // m_children et m_parents décrivent les parents de la génération courante
+
+    real m_initial_diversity = 0;                   // la diversité de la génération 0 (politique Diversity)
+
+    DiversityMetrics m_diversity;                   // les métriques de diversité de la génération courante
+    size_t m_diversity_generation = size_t(-1);     // la génération à laquelle m_diversity correspond
+    bool m_converged = false;                       // la diversité est tombée sous Parameters::min_hamming_ratio
+
+    Surrogate m_surrogate;                          // les agents déjà évalués (Parameters::surrogate_keep < 1)
+    std::vector<real> m_screen;                     // la fitness lue par les tournois : vraie ou prédite par le substitut
+    std::vector<uint8_t> m_screen_exact;            // 1 si m_screen est une vraie évaluation
+    size_t m_screen_generation = size_t(-1);        // la génération à laquelle m_screen correspond
+
+    OperatorBandit m_crossover_bandit;              // Parameters::operator_policy : l'opérateur de croisement de chaque couple
+    OperatorBandit m_mutation_bandit;               // et l'opérateur de mutation de chaque agent
+    std::vector<uint8_t> m_crossovers;              // les opérateurs de croisement de la génération courante, un par couple (vide : fixes)
+    std::vector<uint8_t> m_mutations;               // ses opérateurs de mutation, un par agent (vide : fixes)
+    std::vector<real> m_previous_fitness;           // la fitness exacte de la génération dont elle descend (NaN sinon)
+    std::vector<real> m_parent_fitness;             // celle de chaque parent, dans l'ordre des couples de m_parents
+    size_t m_bred = 0;                              // les agents de la génération courante à créditer à leurs opérateurs (0 = aucun)
+
+    Agent m_best_agent {};                          // le meilleur agent évalué depuis init()
+    BestAgent m_best_so_far;                        // sa fitness et sa génération (agent == nullptr tant qu'aucun agent n'est évalué)
+
+    void saveGeneration(size_t indice) const;
+
+    // évalue les agents indices[k] dans out[indices[k]] (et marque exact[indices[k]]) jusqu'à l'échéance ; renvoie le nombre évalué
+    size_t evaluateBatch(std::span<const size_t> indices, real* out, uint8_t* exact);
+
+    // évalue les agents indices[k] de p dans values[k] ; avec UseDeltaFitness, écrit leur somme dans sums[indices[k]],
+    // calculée si delta à partir de leur parent dans previous, de somme previous_sums : previous[references[k]] s'il
+    // est donné (la recherche locale), sinon celui que désigne referenceOf
+    void evaluateBlock(const Population& p, std::span<const size_t> indices, real* values, real* sums,
+                       const Population& previous, const real* previous_sums, bool delta,
+                       std::span<const size_t> references = {}) const;
+
+    // local_search sur l'élite de la génération courante, évaluée par blocs jusqu'à l'échéance ; renvoie le nombre évalué
+    size_t localSearch(size_t budget);
+
+    // le parent (dans previous) de somme connue le plus proche de l'agent a, d'indice i dans la génération qui
+    // descend de previous par m_parents, ou size_t(-1)
+    size_t referenceOf(const Agent& a, size_t i, const Population& previous, const real* previous_sums) const;
+
+    // Parameters::fused_generation : croise, mute et évalue la génération suivante par tuiles, puis en fait la courante
+    void breedFused();
+
+    // retient le meilleur agent évalué parmi values (seulement ceux marqués dans exact s'il n'est pas nul)
+    void trackBest(const real* values, const uint8_t* exact);
+
+    // tire les opérateurs de la génération à produire à partir de m_parents ; known est la fitness de la courante
+    void assignOperators(const real* known, const uint8_t* exact);
+
+    // crédite aux opérateurs l'amélioration de fitness des agents de la génération courante, puis met à jour les bandits
+    void creditOperators(const real* values, const uint8_t* exact);
+
+    // applique Parameters::size_policy à la génération qui vient d'être produite
+    void resizePopulation();
+
+    // la moitié de population que la politique Linear donne à la génération generation
+    size_t linearHalfSize(size_t generation) const;
+
+    // évalue pour de vrai les enfants les plus prometteurs selon le substitut, prédit la fitness des autres
+    void screenOffspring();
+
+    // publie l'état de la génération courante dans m_metrics
+    void publishMetrics(double seconds, size_t evaluations);
+
+public:
+    /**
+     * @param params Parameters of the run (validated here).
+     * @param pool Pool running the operators, nullptr to run serially on the caller.
+     * @throw std::invalid_argument if @p params is invalid.
+     */
+    explicit GeneticEngine(const Parameters& params, ThreadPool* pool = &ThreadPool::global());
+
+    /**
+     * @brief Seeds the generators, allocates the populations and builds generation 0.
+     */
+    void init() override;
+
+    /**
+     * @brief Produces @p n generations (selection, crossover, mutation).
+     *
+     * After the mutations, the population is resized according to
+     * Parameters::size_policy (never beyond its initial size; growth adds
+     * random immigrants), then refined by the memetic stage if enabled.
+     *
+     * With Parameters::fused_generation, the crossover, the mutations and
+     * the evaluation of the next generation are one pass over tiles of
+     * FusedTile couples, fed by the parent indices the tournaments have
+     * drawn: each tile is mutated and evaluated right after being written.
+     * The metrics count that pass as the crossover stage.
+     *
+     * With an adaptive Parameters::operator_policy, every couple is crossed
+     * and every agent mutated with the operator an OperatorBandit
+     * (operators.h) gives it; each operator is credited with the fitness
+     * improvement of its agents once they are evaluated: the gain of a mutated
+     * parent over itself, the gain of a child over the better of its parents.
+     *
+     * With a surrogate (Parameters::surrogate_keep < 1), only the children the
+     * surrogate ranks best, plus a random exploration share, are evaluated;
+     * the next tournaments read the predicted fitness of the others.
+     *
+     * Stops early, possibly in the middle of a generation, once the run is
+     * over (see finished()).
+     *
+     * @pre init() has been called.
+     */
+    void step(size_t n = 1) override;
+
+    /**
+     * @brief true once max_gen generations have been produced, once the
+     *        population has converged (see converged()), or once an anytime
+     *        limit or a stop request has ended the run (see stopReason()).
+     */
+    bool finished() const override { return Optimizer::finished() || m_converged; }
+
+    /**
+     * @brief Why the run is over, StopReason::Running while it is not.
+     */
+    StopReason stopReason() const override;
+
+    /**
+     * @brief true if the run stopped because the mean Hamming distance fell
+     *        below Parameters::min_hamming_ratio.
+     */
+    bool converged() const { return m_converged; }
+
+    /// The bandits choosing the crossover and the mutation operators (see Parameters::operator_policy).
+    const OperatorBandit& crossoverOperators() const { return m_crossover_bandit; }
+    const OperatorBandit& mutationOperators() const { return m_mutation_bandit; }
+
+    const Population& population() const { return m_population; }
+    size_t populationSize() const override { return m_population.size(); }
+    size_t halfPopulationSize() const { return m_parents.size(); }
+
+    /**
+     * @brief Read-only view of the current generation, without copy.
+     *
+     * Each agent exposes its packed genes (Agent::packedGenes) and its decoded
+     * coordinates (Agent::coordinates). The view is invalidated by step() and init().
+     */
+    std::span<const Agent> agents() const { return { m_population.begin(), m_population.end() }; }
+
+    /**
+     * @brief Fitness of every agent of the current generation, in population order.
+     *
+     * Evaluated on the first call after a step (and counted in evaluations()),
+     * then served from the engine's buffer. With a surrogate, the agents
+     * already evaluated by the pre-screening are not evaluated again. The view is invalidated by step() and init().
+     *
+     * Never exceeds Parameters::max_evaluations and stops at the deadline: the
+     * agents left unevaluated then read NaN.
+     */
+    std::span<const real> fitness();
+
+    /**
+     * @brief Diversity metrics of the current generation (see diversity.h).
+     *
+     * Computed on the first call after a step, then served from the engine.
+     * No fitness evaluation is performed.
+     */
+    const DiversityMetrics& diversityMetrics();
+
+    /**
+     * @brief The best agent of the current generation (among the evaluated
+     *        ones if the run stopped while evaluating it).
+     */
+    BestAgent best();
+
+    /**
+     * @brief The best agent evaluated since init(), whatever its generation.
+     *
+     * This is the result of an anytime run. Only tracked with a single
+     * objective; its agent is nullptr until a first evaluation.
+     */
+    BestAgent bestSoFar() const;
+
+    /**
+     * @brief bestSoFar() as a Solution: its vectors expressed in Parameters::domain.
+     */
+    Solution bestSolution() const override;
+
+    /**
+     * @brief Index of the best agent of the current generation.
+     * @param[out] best_eval If not null, receives its fitness.
+     */
+    size_t bestIndex(real* best_eval = nullptr);
+
+    /**
+     * @brief Prints the best agent of the current generation.
+     */
+    void printBest(std::ostream& os) override;
+
+    /**
+     * @brief Writes a checkpoint of the run into the folder @p folder.
+     *
+     * population.gen holds a line of parameters, then the packed genes of one
+     * agent per line in hexadecimal; best.ind holds the best-so-far agent.
+     *
+     * @throw std::runtime_error if the files cannot be written.
+     */
+    void saveCheckpoint(const std::string& folder) const override;
+};
@@ -0,0 +1,309 @@
+#pragma once
+/**
+ * @file expression.h
+ * @brief A small expression language over the decoded vectors of an agent,
+ *        evaluated on blocks of agents by fused, vectorizable loops.
+ *
+ * An expression is built from:
+ *   - the coordinates of the agent: fx::vec<i> (vector i, Dimension
+ *     coordinates) and fx::coords (all the vectors one after the other);
+ *   - numbers, broadcast over vectors;
+ *   - elementwise operations: + - * / and unary -, min, max, abs, sqrt,
+ *     square, exp, log, sin, cos;
+ *   - reductions and products: sum, dot, norm, norm2, cross (Dimension 3,
+ *     same formula as Vec::cross) and at<k> (coordinate k of a vector).
+ *
+ * Example:
+ * @code
+ * constexpr auto f = -fx::square(fx::sum(fx::coords));                 // the default fitness
+ * constexpr auto g = fx::dot(fx::vec<0>, fx::vec<1>) - 0.5 * fx::norm(fx::cross(fx::vec<0>, fx::vec<1>));
+ * @endcode
+ *
+ * An expression is a tree of tiny structs (expression templates), resolved at
+ * compile time: no Vec and no intermediate array is ever built.
+ * evaluate_block() runs it on a block of agents stored coordinate by
+ * coordinate: every node becomes an inlined computation on one lane, and
+ * the loop over the lanes vectorizes with the instruction set of the
+ * translation unit. Each coordinate is computed in a fixed order (sum, dot:
+ * in coordinate order), so the result does not depend on that instruction
+ * set.
+ *
+ * The types live in an inline namespace named by FX_VARIANT, which each
+ * kernel variant defines (kernels_impl.h): copies compiled with different
+ * instruction sets never merge at link time.
+ */
+
+#include "settings.h"
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#ifndef FX_VARIANT
+#define FX_VARIANT generic
+#endif
+
+
+
+namespace fx {
+inline namespace FX_VARIANT {
+
+constexpr size_t coordinate_count = NumberOfVectors * Dimension;   // les coordonnées d'un agent
+constexpr size_t block = 16;                                        // le nombre d'agents d'un bloc
+
+// Un bloc d'agents est rangé coordonnée par coordonnée : x[k * block + l] est la coordonnée k de l'agent l ;
+// un agent seul garde ses coordonnées contiguës (pas de 1).
+
+
+
+// ==================================================================================================================
+// Noeuds
+// ==================================================================================================================
+
+/// Base of every node; a node has a static width (1 = a number) and evaluates its coordinate C on lane l
+/// of agents whose coordinate k is stored at x[k * S + l].
+struct Node {};
+
+template <class T>
+constexpr bool is_node = std::is_base_of_v<Node, T>;
+
+// les coordonnées [First, First + Width) de l'agent
+template <size_t First, size_t Width>
+struct Var : Node {
+    static constexpr size_t width = Width;
+
+    template <size_t C, size_t S>
+    real get(const real* x, size_t l) const { return x[(First + C) * S + l]; }
+};
+
+struct Const : Node {
+    static constexpr size_t width = 1;
+    real value;
+
+    constexpr Const(real v) : value(v) {}
+
+    template <size_t C, size_t S>
+    real get(const real*, size_t) const { return value; }
+};
+
+template <class Op, class A>
+struct Unary : Node {
+    static constexpr size_t width = A::width;
+    A a;
+
+    constexpr explicit Unary(A a) : a(a) {}
+
+    template <size_t C, size_t S>
+    real get(const real* x, size_t l) const { return Op::apply(a.template get<C, S>(x, l)); }
+};
+
+// opération coordonnée par coordonnée ; un nombre est répété sur toutes les coordonnées de l'autre opérande
+template <class Op, class A, class B>
+struct Binary : Node {
+    static_assert(A::width == B::width || A::width == 1 || B::width == 1, "opérandes de tailles différentes");
+    static constexpr size_t width = A::width > B::width ? A::width : B::width;
+    A a;
+    B b;
+
+    constexpr Binary(A a, B b) : a(a), b(b) {}
+
+    template <size_t C, size_t S>
+    real get(const real* x, size_t l) const {
+        return Op::apply(a.template get<A::width == 1 ? 0 : C, S>(x, l), b.template get<B::width == 1 ? 0 : C, S>(x, l));
+    }
+};
+
+template <class A>
+struct Sum : Node {
+    static constexpr size_t width = 1;
+    A a;
+
+    constexpr explicit Sum(A a) : a(a) {}
+
+    template <size_t C, size_t S>
+    real get(const real* x, size_t l) const { return add<S>(x, l, std::make_index_sequence<A::width>{}); }
+
+private:
+    template <size_t S, size_t... K>
+    real add(const real* x, size_t l, std::index_sequence<K...>) const {
+        real s = 0;
+        ((s += a.template get<K, S>(x, l)), ...); // dans l'ordre des coordonnées, comme une boucle
+        return s;
+    }
+};
+
+template <class A, class B>
+struct Dot : Node {
+    static_assert(A::width == B::width, "dot : vecteurs de tailles différentes");
+    static constexpr size_t width = 1;
+    A a;
+    B b;
+
+    constexpr Dot(A a, B b) : a(a), b(b) {}
+
+    template <size_t C, size_t S>
+    real get(const real* x, size_t l) const { return add<S>(x, l, std::make_index_sequence<A::width>{}); }
+
+private:
+    template <size_t S, size_t... K>
+    real add(const real* x, size_t l, std::index_sequence<K...>) const {
+        real s = 0;
+        ((s += a.template get<K, S>(x, l) * b.template get<K, S>(x, l)), ...);
+        return s;
+    }
+};
+
+template <class A, class B>
+struct Cross : Node {
+    static_assert(A::width == 3 && B::width == 3, "cross n'est défini qu'en dimension 3");
+    static constexpr size_t width = 3;
+    A a;
+    B b;
+
+    constexpr Cross(A a, B b) : a(a), b(b) {}
+
+    template <size_t C, size_t S>
+    real get(const real* x, size_t l) const {
+        constexpr size_t i = (C + 1) % 3, j = (C + 2) % 3;
+        return a.template get<i, S>(x, l) * b.template get<j, S>(x, l) - a.template get<j, S>(x, l) * b.template get<i, S>(x, l);
+    }
+};
+
+template <size_t K, class A>
+struct At : Node {
+    static_assert(K < A::width, "at : coordonnée hors du vecteur");
+    static constexpr size_t width = 1;
+    A a;
+
+    constexpr explicit At(A a) : a(a) {}
+
+    template <size_t C, size_t S>
+    real get(const real* x, size_t l) const { return a.template get<K, S>(x, l); }
+};
+
+
+
+// ==================================================================================================================
+// Opérations élémentaires
+// ==================================================================================================================
+
+struct Add    { static real apply(real a, real b) { return a + b; } };
+struct Sub    { static real apply(real a, real b) { return a - b; } };
+struct Mul    { static real apply(real a, real b) { return a * b; } };
+struct Div    { static real apply(real a, real b) { return a / b; } };
+struct Min    { static real apply(real a, real b) { return b < a ? b : a; } };
+struct Max    { static real apply(real a, real b) { return a < b ? b : a; } };
+struct Neg    { static real apply(real a) { return -a; } };
+struct Abs    { static real apply(real a) { return std::fabs(a); } };
+struct Sqrt   { static real apply(real a) { return std::sqrt(a); } };
+struct Square { static real apply(real a) { return a * a; } };
+struct Exp    { static real apply(real a) { return std::exp(a); } };
+struct Log    { static real apply(real a) { return std::log(a); } };
+struct Sin    { static real apply(real a) { return std::sin(a); } };
+struct Cos    { static real apply(real a) { return std::cos(a); } };
+
+
+
+// ==================================================================================================================
+// Construction des expressions
+// ==================================================================================================================
+
+/// Vector @p I of the agent.
+template <size_t I> requires (I < NumberOfVectors)
+constexpr Var<I * Dimension, Dimension> vec {};
+
+/// All the coordinates of the agent, vector after vector.
+constexpr Var<0, coordinate_count> coords {};
+
+template <class T>
+concept operand = is_node<T> || std::is_arithmetic_v<T>;
+
+template <operand T>
+constexpr auto node(T t) {
+    if constexpr (is_node<T>) return t;
+    else                      return Const(real(t));
+}
+
+template <class Op, operand A, operand B>
+constexpr auto binary(A a, B b) {
+    return Binary<Op, decltype(node(a)), decltype(node(b))>(node(a), node(b));
+}
+
+// les opérateurs ne s'appliquent que si l'un des opérandes au moins est une expression
+template <operand A, operand B> requires (is_node<A> || is_node<B>)
+constexpr auto operator+(A a, B b) { return binary<Add>(a, b); }
+
+template <operand A, operand B> requires (is_node<A> || is_node<B>)
+constexpr auto operator-(A a, B b) { return binary<Sub>(a, b); }
+
+template <operand A, operand B> requires (is_node<A> || is_node<B>)
+constexpr auto operator*(A a, B b) { return binary<Mul>(a, b); }
+
+template <operand A, operand B> requires (is_node<A> || is_node<B>)
+constexpr auto operator/(A a, B b) { return binary<Div>(a, b); }
+
+template <operand A, operand B> requires (is_node<A> || is_node<B>)
+constexpr auto min(A a, B b) { return binary<Min>(a, b); }
+
+template <operand A, operand B> requires (is_node<A> || is_node<B>)
+constexpr auto max(A a, B b) { return binary<Max>(a, b); }
+
+template <class A> requires is_node<A> constexpr auto operator-(A a) { return Unary<Neg, A>(a); }
+template <class A> requires is_node<A> constexpr auto abs(A a)       { return Unary<Abs, A>(a); }
+template <class A> requires is_node<A> constexpr auto sqrt(A a)      { return Unary<Sqrt, A>(a); }
+template <class A> requires is_node<A> constexpr auto square(A a)    { return Unary<Square, A>(a); }
+template <class A> requires is_node<A> constexpr auto exp(A a)       { return Unary<Exp, A>(a); }
+template <class A> requires is_node<A> constexpr auto log(A a)       { return Unary<Log, A>(a); }
+template <class A> requires is_node<A> constexpr auto sin(A a)       { return Unary<Sin, A>(a); }
+template <class A> requires is_node<A> constexpr auto cos(A a)       { return Unary<Cos, A>(a); }
+
+template <class A> requires is_node<A>
+constexpr auto sum(A a) { return Sum<A>(a); }
+
+template <class A, class B> requires (is_node<A> && is_node<B>)
+constexpr auto dot(A a, B b) { return Dot<A, B>(a, b); }
+
+template <class A> requires is_node<A>
+constexpr auto norm2(A a) { return dot(a, a); }
+
+template <class A> requires is_node<A>
+constexpr auto norm(A a) { return sqrt(dot(a, a)); }
+
+template <class A, class B> requires (is_node<A> && is_node<B>)
+constexpr auto cross(A a, B b) { return Cross<A, B>(a, b); }
+
+template <size_t K, class A> requires is_node<A>
+constexpr auto at(A a) { return At<K, A>(a); }
+
+
+
+// ==================================================================================================================
+// Évaluation
+// ==================================================================================================================
+
+/**
+ * @brief out[l] = @p e evaluated on agent l of the block @p x, for l < @p count (<= block).
+ */
+template <class E>
+void evaluate_block(const E& e, const real* x, size_t count, real* out) {
+    static_assert(is_node<E> && E::width == 1, "une fitness est un nombre : réduire l'expression (sum, dot, norm...)");
+    real values[block];
+    for (size_t l = 0; l < block; l++) {
+        values[l] = e.template get<0, block>(x, l); // toutes les voies : la boucle a une longueur fixe et se vectorise
+    }
+    for (size_t l = 0; l < count; l++) out[l] = values[l];
+}
+
+/**
+ * @brief @p e evaluated on one agent whose coordinates are contiguous in @p x
+ *        (as Individu::coordinates()); same operations as evaluate_block.
+ */
+template <class E>
+real evaluate(const E& e, const real* x) {
+    static_assert(is_node<E> && E::width == 1, "une fitness est un nombre : réduire l'expression (sum, dot, norm...)");
+    return e.template get<0, 1>(x, 0);
+}
+
+} // namespace FX_VARIANT
+} // namespace fx
@@ -5,22 +5,33 @@
  *
  * This header declares aliases and core functions used to implement a
  * generational genetic algorithm, including agent evaluation, selection,
- * crossover, mutation, generation creation, and utilities for inspecting the
- * population.
+ * crossover, mutation, and utilities for inspecting the population.
  *
- * The exact template parameters and sizes for Agent, Population and
- * HalfPopulation are provided by the included configuration headers.
+ * The template parameters of Agent are provided by the included configuration
+ * headers; the size of a Population is a runtime value (see Parameters). The generation loop itself lives in GeneticEngine
+ * (engine.h).
  *
- * Thread-safety, persistence format and other runtime policies are governed by
- * the broader program and are not defined here.
+ * Every operator taking a ThreadPool* runs on that pool, or serially on the
+ * calling thread when it is nullptr. Random draws use the Randomizer of the
+ * thread that performs them.
  */
 
 
 
 #include "settings.h"
 #include "Individu.h"
+#include "parallel.h"
+#include "parameters.h"
 
 #include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <utility>
 
 
@@ -36,55 +47,298 @@
  */
 using Agent = Individu<NumberOfVectors, Dimension>;
 
+static_assert(std::is_trivially_copyable_v<Agent> && std::is_trivially_destructible_v<Agent>,
+              "agents are stored in raw placed memory and copied as plain bytes");
+
+static_assert(StorageTile >= 4 && StorageTile % 4 == 0, "a tile holds whole couples and their children");
+
+
+
 /**
- * @typedef Population
- * @brief Fixed-size container holding the entire population for one generation.
+ * @class Population
+ * @brief Runtime-sized container holding the agents of one generation.
  *
- * Population is an std::array of Agent with size PopulationSize.
+ * The agents live in a PlacedBuffer: the memory is reserved untouched so that
+ * the worker which first writes a slice (see populate()) places it on its own
+ * NUMA node.
+ *
+ * The size can change during a run (see PopulationPolicy) without any
+ * reallocation, within the capacity reserved at construction.
+ *
+ * A population too large for the memory lives in a file-backed PlacedBuffer
+ * (see Parameters::storage). It is then cut into tiles of StorageTile
+ * agents: selection draws the opponents of a tournament, and crossover pairs
+ * the parents, within a single tile, so that every stage streams over the
+ * file tile after tile instead of reading it at random.
  */
-using Population = std::array<Agent, PopulationSize>;
+class Population {
+private:
+    PlacedBuffer m_buffer;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+
+public:
+    Population() = default;
+
+    /**
+     * @brief Reserves room for @p size agents, using the huge_pages policy.
+     *
+     * The agents are not constructed; call populate() before reading them.
+     */
+    explicit Population(size_t size)
+        : m_buffer(size * sizeof(Agent), huge_pages), m_size(size), m_capacity(size) {}
+
+    /**
+     * @brief Reserves room for @p size agents in an unnamed file of the folder
+     *        @p storage, or in memory as above when @p storage is empty.
+     * @throw std::runtime_error if the file cannot be created or mapped.
+     */
+    Population(size_t size, const std::string& storage)
+        : m_buffer(storage.empty() ? PlacedBuffer(size * sizeof(Agent), huge_pages)
+                                   : PlacedBuffer(size * sizeof(Agent), storage)),
+          m_size(size), m_capacity(size) {}
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+
+    /// true when the agents live in a file rather than in memory
+    bool outOfCore() const { return m_buffer.fileBacked(); }
+
+    /// the number of agents of a tile (0 = no tiles: the population lives in memory)
+    size_t tile() const { return outOfCore() ? StorageTile : 0; }
+
+    /// access hint for the agents [first, first + count), see PlacedBuffer::advise (no-op in memory)
+    void advise(PlacedBuffer::Advice advice, size_t first, size_t count) const {
+        m_buffer.advise(advice, first * sizeof(Agent), count * sizeof(Agent));
+    }
+
+    /**
+     * @brief Changes the number of agents, within the capacity.
+     *
+     * Shrinking keeps the first @p size agents. Growing exposes agents
+     * left by earlier generations (or unconstructed memory if none was ever
+     * built there): overwrite them, e.g. with populate(p, proba, pool, old_size).
+     */
+    void resize(size_t size) {
+        assert(size <= m_capacity && "a population cannot grow beyond its capacity");
+        m_size = size;
+    }
+
+    Agent*       data()       { return static_cast<Agent*>(m_buffer.data()); }
+    const Agent* data() const { return static_cast<const Agent*>(m_buffer.data()); }
+
+    Agent&       operator[](size_t i)       { return data()[i]; }
+    const Agent& operator[](size_t i) const { return data()[i]; }
+
+    Agent*       begin()       { return data(); }
+    Agent*       end()         { return data() + m_size; }
+    const Agent* begin() const { return data(); }
+    const Agent* end()   const { return data() + m_size; }
+
+    const PlacedBuffer& buffer() const { return m_buffer; }
+
+    void swap(Population& other) noexcept {
+        std::swap(m_buffer, other.m_buffer);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+    }
+};
 
 /**
- * @typedef HalfPopulation
- * @brief Fixed-size container representing a half-population used during
- * selection and crossover (e.g., parents or selected survivors).
+ * @typedef ParentIndex
+ * @brief The index of a selected parent in the current population.
  *
- * HalfPopulation is an std::array of Agent with size HalfPopulationSize.
+ * Selection, shuffling and pairing only move these indices: a parent's genes
+ * are read once, when crossover writes it and its children into the next
+ * generation.
+ */
+using ParentIndex = uint32_t;
+
+/**
+ * @typedef Objectives
+ * @brief The objective vector of an agent in multi-objective mode
+ *        (NumberOfObjectives > 1). Every objective is maximized.
+ */
+using Objectives = std::array<real, NumberOfObjectives>;
+
+/**
+ * @typedef Descriptor
+ * @brief The behaviour characteristics of an agent for MAP-Elites
+ *        (Algorithm::MapElites), each in [0, 1].
  */
-using HalfPopulation = std::array<Agent, HalfPopulationSize>;
+using Descriptor = std::array<real, DescriptorDims>;
 
 
 
 
+/**
+ * @brief Constructs the agents [first, p.size()) of @p p with random genes.
+ *
+ * @param[out] p Population whose memory is reserved but not yet constructed.
+ * @param[in] mutation_proba Initial mutation probability of every chromosome.
+ * @param[in] pool Each worker constructs, hence first-touches, its own slice.
+ * @param[in] first The first agent to construct (0 = the whole population,
+ *                  the size before a growth = random immigrants only).
+ * @param[in] strategy How the new agents are spread over the domain (see
+ *                     sampling.h); Uniform draws every gene independently.
+ */
+void populate (Population& p, real mutation_proba, ThreadPool* pool, size_t first = 0,
+               Initialization strategy = Initialization::Uniform);
+
+/**
+ * @brief Constructs blank agents (see Individu()) in the whole capacity of @p p,
+ *        for a population only used as scratch space.
+ *
+ * Nothing is drawn: this only places the memory (each worker first-touches its
+ * slice). A file-backed population is left untouched, its pages read as zeros
+ * until written.
+ */
+void populate_blank (Population& p, ThreadPool* pool);
+
+
+
+/**
+ * @brief The vectors of an agent, expressed in @p domain.
+ *
+ * Returns the cached phenotype itself when @p domain is the compile-time one.
+ */
+Agent::phenotype phenotype_in (const Agent& a, const Domain& domain);
+
+
 /**
  * @brief Evaluate the fitness (or objective) of a single agent.
  *
  * @param[in] a The agent to evaluate; evaluation must not modify @p a.
+ * @param[in] domain The interval the decoded coordinates are mapped to before
+ *                   calling the fitness function.
  * @return real A numerical score representing the agent's fitness. Higher or
  *              lower values indicate better quality depending on the problem
  *              convention used in the rest of the codebase.
+ *              With UseFitnessExpression it is fitness_expression (objective.h)
+ *              instead of fitness(); with UseDeltaFitness, fitness_from_sum of
+ *              the sum of the contributions; with a benchmark in @p domain,
+ *              that benchmark (benchmarks.h).
  *
  * @note The function must be deterministic for a given agent state, except
  *       where explicit stochastic evaluation is intended and accounted for by
  *       the algorithm.
  */
-real eval_agent (const Agent& a);
+real eval_agent (const Agent& a, const Domain& domain = {});
+
+
+/**
+ * @brief Evaluate the fitness of vectors already expressed in the run's domain.
+ *
+ * The fitness hook of the engines working directly on real coordinates
+ * (DifferentialEvolution, CmaEs): fitness(), fitness_expression with
+ * UseFitnessExpression, fitness_from_sum with UseDeltaFitness, or the
+ * benchmark of @p domain, exactly as eval_agent calls them.
+ */
+real eval_vectors (const Agent::phenotype& vectors, const Domain& domain = {});
+
+
+/**
+ * @brief The behaviour characteristics of vectors expressed in @p domain:
+ *        descriptor() (genetic.cpp), each clamped into [0, 1] (NaN gives 0).
+ */
+Descriptor eval_descriptor (const Agent::phenotype& vectors, const Domain& domain = {});
+
+
+/**
+ * @brief The sum of the fitness_contribution of every coordinate of @p a,
+ *        mapped into @p domain (UseDeltaFitness).
+ *
+ * With UseDeltaFitness, the fitness of an agent is eval_sum(contribution_sum(a)).
+ */
+real contribution_sum (const Agent& a, const Domain& domain = {});
+
 
- 
 /**
- * @brief Perform tournament selection on a population to build a half-size
- * selection pool of parent candidates.
+ * @brief contribution_sum(a, domain), computed from the sum of @p reference.
+ *
+ * Only the coordinates of @p a that differ from @p reference have their
+ * contribution recomputed: O(changed genes) calls of fitness_contribution
+ * instead of O(genome). When more than half of the coordinates differ, the
+ * sum is recomputed from scratch instead.
+ *
+ * @param[in] reference The agent @p reference_sum belongs to, typically a parent of @p a.
+ * @param[in] reference_sum contribution_sum(reference, domain), possibly itself obtained by delta.
+ */
+real contribution_sum_delta (const Agent& a, const Agent& reference, real reference_sum, const Domain& domain = {});
+
+
+/**
+ * @brief The fitness of an agent whose contributions sum to @p sum: fitness_from_sum (UseDeltaFitness).
+ */
+real eval_sum (real sum);
+
+
+/**
+ * @brief Evaluate the fitness of several agents of a population at once.
+ *
+ * out[k] = eval_agent(p[indices[k]], domain). With UseFitnessExpression the
+ * agents go through the fitness_block kernel by blocks of fx::block, which
+ * evaluates fitness_expression on the whole block in vector registers.
+ */
+void eval_agents (const Population& p, std::span<const size_t> indices, const Domain& domain, real* out);
+
+
+/**
+ * @brief Evaluate every objective of a single agent (multi-objective mode).
+ *
+ * @param[in] a The agent to evaluate; evaluation must not modify @p a.
+ * @param[in] domain The interval the decoded coordinates are mapped to.
+ * @return Objectives The NumberOfObjectives values to maximize.
+ */
+Objectives eval_agent_objectives (const Agent& a, const Domain& domain = {});
+
+
+/**
+ * @brief Perform tournament selection on a population to choose the parents
+ * of the next generation.
  *
  * @param[in] p The current population to select from.
- * @return HalfPopulation A container of selected agents (typically used as
- *                       parents for crossover).
+ * @param[out] parents Receives parents.size() indices of agents of @p p
+ *                     (half the population size, used as parents for crossover).
+ * @param[in] domain The interval used to evaluate the agents.
+ * @param[in] pool The pool running the tournaments (nullptr = serial).
+ * @param[in] fitness If not null, the fitness of every agent of @p p (as
+ *                    eval_agent computes it), read instead of evaluating.
+ * @return size_t The number of fitness evaluations performed.
  *
  * @pre The provided population @p p must be valid and fully-initialized.
- * @post Returned HalfPopulation contains agents selected according to the
- *       tournament selection policy configured elsewhere (ties, tournament
- *       size and replacement policy are implementation-specific).
+ * @post @p parents designates agents selected according to the tournament selection
+ *       policy configured elsewhere (ties, tournament size and replacement
+ *       policy are implementation-specific).
+ *
+ * @note When NumberOfObjectives > 1 the population is first ranked by
+ *       non-dominated sorting and crowding distance, and each binary
+ *       tournament is won by the lower rank, then the larger crowding distance.
+ * @note When @p p is cut into tiles, parents[k] is drawn from the tile
+ *       holding agent 2k, i.e. the tile of its future children.
+ */
+size_t selection_tournoi(const Population& p, std::span<ParentIndex> parents, const Domain& domain, ThreadPool* pool,
+                         const real* fitness = nullptr);
+
+
+
+/**
+ * @brief The crossover operators (one cut per chromosome, two cuts per
+ *        chromosome, or each gene and mutation probability from either parent).
+ *
+ * OperatorBandit (operators.h) picks one per couple when operator_policy is
+ * adaptive; otherwise every couple uses OnePoint.
  */
-HalfPopulation selection_tournoi(const Population& p);
+enum class Crossover : uint8_t { OnePoint, TwoPoint, Uniform };
+constexpr size_t CrossoverOperators = 3;
+
+/// The mutation operators: Individu::Mutate (bit flips) or Individu::Creep (steps of at most CreepStep).
+enum class Mutation : uint8_t { BitFlip, Creep };
+constexpr size_t MutationOperators = 2;
+
+/// The name of an operator ("one-point", "two-point", "uniform"; "bit-flip", "creep").
+std::string to_string(Crossover op);
+std::string to_string(Mutation op);
 
 
 
@@ -104,25 +358,49 @@ HalfPopulation selection_tournoi(const Population& p);
  */
 std::pair<Agent, Agent> cross_over (const Agent& p1, const Agent& p2);
 
+/**
+ * @brief Same crossover, writing the offspring directly into @p child1 and
+ *        @p child2 (e.g. slots of the next generation), without temporaries.
+ *
+ * Every chromosome of the children is overwritten; they must not alias the parents.
+ *
+ * @param op The crossover operator; OnePoint is the crossover of the pair overload.
+ */
+void cross_over (const Agent& p1, const Agent& p2, Agent& child1, Agent& child2, Crossover op = Crossover::OnePoint);
+
 
 
 /**
- * @brief Apply crossover to a HalfPopulation to produce a full Population of
- * offspring.
+ * @brief Pair the selected parents and cross them to produce the next
+ * generation.
  *
- * @param[in,out] hp The half-population (usually selected parents). The
- *                   function may treat this input as read-only, but the
- *                   signature allows modifications if required by the
- *                   implementation.
- * @return Population A full population (PopulationSize elements) of children
- *                    generated by pairing and crossing the entries in @p hp.
+ * @param[in] p The current population, in which @p parents points.
+ * @param[in,out] parents The indices of the selected parents. They are
+ *                        shuffled in place to form the couples (within each
+ *                        tile of @p p when it is cut into tiles). Their number
+ *                        may be odd: the parent left without a partner is kept
+ *                        and crossed with the first parent, to give one child.
+ * @param[out] res A population of 2*parents.size() agents receiving each
+ *                 couple and its two children, written in place.
+ * @param[in] pool The pool crossing the couples (nullptr = serial).
+ * @param[in] finish If set, called on the worker with (first, count) each
+ *                   time the agents [first, first + count) of @p res are
+ *                   written, by tiles of at most FusedTile couples: the
+ *                   fused generation mutates and evaluates them there, while
+ *                   they are still in cache. The draws of the crossovers are
+ *                   the same with or without it.
+ * @param[in] crossovers If not empty, the operator of each couple (a
+ *                       Crossover, (parents.size() + 1) / 2 of them, the last
+ *                       one for the lone parent); OnePoint for all otherwise.
  *
- * @pre The size of @p hp must be sufficient for the crossover pairing strategy
- *      (e.g., even number of parents if pairing is required).
- * @post Returned Population contains newly created agents ready for
- *       subsequent mutation and evaluation.
+ * @pre @p parents holds at least one index, res.size() == 2*parents.size()
+ *      and @p res does not share its storage with @p p.
+ * @post @p res contains newly created agents ready for subsequent mutation
+ *       and evaluation.
  */
-Population cross_over_half_pop (HalfPopulation& hp);
+void cross_over_half_pop (const Population& p, std::span<ParentIndex> parents, Population& res, ThreadPool* pool,
+                          const std::function<void(size_t, size_t)>& finish = {},
+                          std::span<const uint8_t> crossovers = {});
 
 
 
@@ -131,6 +409,9 @@ Population cross_over_half_pop (HalfPopulation& hp);
  *
  * @param[in,out] p Pointer to the Population to mutate. Each agent in the
  *                  population may be modified in-place.
+ * @param[in] pool The pool mutating the agents (nullptr = serial).
+ * @param[in] operators If not empty, the operator of each agent (a Mutation,
+ *                      p->size() of them); BitFlip for all otherwise.
  *
  * @pre p must be a non-null pointer to a valid Population.
  * @post The population pointed to by @p p reflects applied mutations. The
@@ -140,66 +421,111 @@ Population cross_over_half_pop (HalfPopulation& hp);
  * @note Mutation intensity, per-gene probabilities, and any constraints or
  *       repair logic are defined by the implementation and configuration.
  */
-void mutations (Population* p);
+void mutations (Population* p, ThreadPool* pool, std::span<const uint8_t> operators = {});
+
+/// Mutates one agent with the operator @p op.
+inline void mutate (Agent& a, Mutation op) {
+    if (op == Mutation::Creep) a.Creep(CreepStep);
+    else                       a.Mutate();
+}
 
 
 
 /**
- * @brief Create or evolve a generation for a genetic algorithm population.
+ * @typedef CandidateEvaluator
+ * @brief Evaluates one round of candidates of local_search.
  *
- * @details Generates the generation identified by \p indice for the provided
- * Population object. This function performs the genetic operations required to
- * produce the requested generation (selection, crossover, mutation,
- * evaluation and any bookkeeping). When \p is_saving_in_file is true, the
- * resulting generation or relevant population data will be persisted to disk
- * (format and location are determined elsewhere in the program).
+ * Called as evaluate(candidates, references, values, sums): values[k]
+ * receives the fitness of candidates[k] and, with UseDeltaFitness, sums[k]
+ * its sum of contributions; references[k] is the index, in the searched
+ * population, of the elite agent candidates[k] differs from by one gene.
+ * Returns the number of candidates evaluated: fewer than candidates.size()
+ * when the evaluation was interrupted, the others keeping values[k] = NaN.
+ */
+using CandidateEvaluator = std::function<size_t(const Population& candidates, std::span<const size_t> references,
+                                                real* values, real* sums)>;
+
+/**
+ * @brief Memetic stage: refines the best agents of a population by local search.
  *
- * @param[in] indice Index of the generation to create (typically 0-based).
- *                   The exact interpretation (generation number vs. archive
- *                   position) depends on the calling context.
- * @param[in,out] p Pointer to the Population to be modified. The function
- *                   updates the population in-place to reflect the new
- *                   generation. Must be a valid, non-null pointer.
- * @param[in] is_saving_in_file When true, persist generation/population data
- *                              to file; when false, do not perform persistence.
- *                              Default: false.
+ * The @p elite agents with the highest fitness run a coordinate pattern
+ * search in the decoded real space: each coordinate is moved by +step and
+ * -step, re-encoded with real_to_bin, and the move is kept if it improves the
+ * fitness. After a full cycle without improvement the step is halved, down to
+ * the resolution of a gene. The candidates of all the elite agents are
+ * evaluated together, one batch per round, through @p evaluate. Once a round
+ * comes back incomplete (see CandidateEvaluator), its improvements are kept
+ * and the search stops.
  *
- * @pre p != nullptr.
- * @pre indice must be within a valid range for the current evolutionary run;
- *      caller is responsible for ensuring index validity.
+ * @param[in,out] p The population; improved agents are written back in place
+ *                  (mutation probabilities are kept).
+ * @param[in,out] fitness The fitness of every agent of @p p; updated for the
+ *                        improved agents.
+ * @param[in] elite Number of agents refined.
+ * @param[in] budget Number of evaluations allowed per elite agent.
+ * @param[in] evaluate Evaluates each round of candidates.
+ * @param[in,out] sums With UseDeltaFitness, the sum of contributions of every
+ *                     agent of @p p, updated for the improved agents (may be nullptr).
+ * @return size_t The number of fitness evaluations performed.
+ */
+size_t local_search (Population& p, real* fitness, size_t elite, size_t budget, const CandidateEvaluator& evaluate,
+                     real* sums = nullptr);
+
+/**
+ * @brief local_search evaluating each round with eval_agents, by blocks of
+ *        fx::block candidates spread over @p pool (nullptr = serial).
  *
- * @post The Population object pointed to by \p p represents the generation
- *       indicated by \p indice (individuals and associated metadata updated,
- *       fitnesses evaluated, and any internal counters advanced).
+ * @param[in] domain The interval used to evaluate the agents.
+ */
+size_t local_search (Population& p, real* fitness, size_t elite, size_t budget, const Domain& domain, ThreadPool* pool);
+
+
+
+/**
+ * @brief Index of the agent with the highest fitness.
  *
- * @note • Saving behavior (file format, naming, location) is implementation-specific and governed by other components of the codebase.
- * @note • Side effects may include dynamic allocation of individuals, mutation of existing individuals, and I/O when \p is_saving_in_file is true.
+ * @param[in] p The population to inspect (non-empty).
+ * @param[in] domain The interval used to evaluate the agents.
+ * @param[out] best_eval If not null, receives the fitness of that agent.
+ */
+size_t best_agent_index(const Population& p, const Domain& domain, real* best_eval = nullptr);
+
+
+/**
+ * @brief Prints the vectors of an agent expressed in @p domain, one vector per line.
+ */
+void print_vectors(std::ostream& os, const Agent& a, const Domain& domain);
+
+/**
+ * @brief Prints vectors already expressed in their domain, one vector per line.
  */
-void create_generation (size_t indice, Population* p, bool is_saving_in_file = false);
+void print_vectors(std::ostream& os, const Agent::phenotype& vectors);
 
 
 /**
  * @brief Print or log the best agent from a population.
  *
  * @param[in] p The population to inspect.
+ * @param[in] domain The interval used to evaluate and print the agents.
+ * @param[in,out] os Destination stream.
  *
  * @note The definition of "best" (maximum vs. minimum fitness) is determined
  *       by the evaluation convention used in eval_agent and higher-level
- *       algorithm policies. Output destination (console, log file, structured
- *       report) is implementation-defined.
+ *       algorithm policies.
+ * @note In multi-objective mode the size of the first Pareto front and the
+ *       best agent of each objective are printed instead.
  */
-void print_best_agent(const Population& p);
+void print_best_agent(const Population& p, const Domain& domain, std::ostream& os);
 
 
 /**
  * @brief Top-level entry point for running the genetic algorithm.
  *
- * This function is responsible for initializing state, iterating through
- * generations, invoking selection/crossover/mutation/evaluation, and handling
- * termination and final reporting.
+ * Runs a GeneticEngine with the default Parameters on the global thread pool,
+ * printing the best agent after every generation.
  *
  * @note The function may block for the full duration of the evolutionary run
  *       and may perform I/O, profiling and resource management as required by
  *       the program.
  */
-void genetic_algorithm ();
\ No newline at end of file
+void genetic_algorithm ();
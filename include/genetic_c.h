@@ -0,0 +1,198 @@
+#pragma once
+/**
+ * @file genetic_c.h
+ * @brief C interface of the genetic library, for hosts that are not written in C++.
+ *
+ * The interface wraps one engine per handle: the genetic algorithm, or one of
+ * the continuous engines (differential evolution, CMA-ES) chosen by
+ * genetic_params::algorithm. The host drives the run generation by generation
+ * and, with the genetic algorithm, reads the population in place: the pointers
+ * returned by genetic_fitness, genetic_genes and genetic_coordinates point
+ * into the engine's own buffers and stay valid until the next genetic_step,
+ * genetic_init or genetic_destroy on the same handle (genetic_coordinates:
+ * also until its next call, unless the library is built with CachePhenotype).
+ *
+ * Errors: functions returning int return 0 on success and -1 on failure;
+ * genetic_create returns NULL on failure. genetic_last_error then gives the
+ * message of the last failure on the calling thread. No C++ exception ever
+ * crosses the interface.
+ *
+ * The views on the population (genetic_diversity, genetic_best,
+ * genetic_fitness, genetic_genes, genetic_coordinates) only exist with the
+ * genetic algorithm; they fail with the other engines.
+ *
+ * A handle must not be used by two threads at the same time.
+ *
+ * Example:
+ * @code
+ * genetic_params p;
+ * genetic_default_params(&p);
+ * p.max_gen = 200;
+ * genetic_engine* e = genetic_create(&p);
+ * genetic_init(e);
+ * while (!genetic_finished(e)) {
+ *     genetic_step(e, 10);
+ *     size_t best; double f;
+ *     genetic_best(e, &best, &f);
+ * }
+ * genetic_destroy(e);
+ * @endcode
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+typedef struct genetic_engine genetic_engine;
+
+/**
+ * @struct genetic_params
+ * @brief Mirror of Parameters (parameters.h), plus the threading of the engine.
+ */
+typedef struct genetic_params {
+    size_t   half_population_size;      /* la moitié de la taille (initiale et maximale) de la population, >= 1 */
+    size_t   max_gen;                   /* le nombre de générations d'enfants */
+    double   initial_mutation_proba;    /* dans [0, 1] */
+    double   min_real;                  /* le domaine des coordonnées */
+    double   max_real;
+    uint64_t seed;                      /* 0 = graine aléatoire */
+    size_t   threads;                   /* 0 = pool global du processus, 1 = sur le thread appelant, n = pool privé de n threads */
+    size_t   memetic_elite;             /* agents d'élite affinés par recherche locale (0 = désactivé) */
+    size_t   memetic_budget;            /* évaluations de la recherche locale par agent d'élite */
+    int      population_policy;         /* 0 = taille fixe, 1 = réduction linéaire, 2 = selon la diversité */
+    size_t   min_half_population_size;  /* la plus petite moitié de population (politiques 1 et 2) */
+    double   min_hamming_ratio;         /* arrêt quand la distance de Hamming moyenne tombe sous cette part des bits (0 = jamais) */
+    double   surrogate_keep;            /* part des enfants évalués pour de vrai, les plus prometteurs selon le substitut (1 = pas de substitut) */
+    double   surrogate_exploration;     /* part de la population évaluée en plus, au hasard parmi les enfants écartés */
+    double   time_limit;                /* durée maximale du run en secondes, depuis genetic_init (0 = pas d'échéance) */
+    size_t   max_evaluations;           /* nombre maximal d'évaluations de la fonction fitness (0 = pas de limite) */
+    const char* storage;                /* dossier des fichiers portant les populations (NULL ou "" = en mémoire), copié par genetic_create */
+    int      algorithm;                 /* 0 = algorithme génétique, 1 = évolution différentielle, 2 = CMA-ES, 3 = MAP-Elites */
+    size_t   continuous_population;     /* la population de DE et de CMA-ES (0 = leur valeur recommandée) */
+    double   de_weight;                 /* le facteur F de l'évolution différentielle, dans ]0, 2] */
+    double   de_crossover;              /* le taux de croisement CR de l'évolution différentielle, dans [0, 1] */
+    int      initialization;            /* la génération 0 : 0 = uniforme, 1 = hypercube latin, 2 = Halton */
+    int      benchmark;                 /* fonction de test à la place de la fitness (0 = aucune, 1 = sphere ... 6 = griewank) */
+    size_t   benchmark_dims;            /* sa dimension (0 = toutes les coordonnées) ; min_real et max_real restent ceux donnés */
+    int      fused_generation;          /* 1 = croisement, mutation et évaluation fusionnés par tuiles de couples */
+    size_t   map_cells;                 /* MAP-Elites : les cases de la grille sur chaque caractéristique de comportement */
+    int      operator_policy;           /* opérateurs de chaque enfant : 0 = fixes, 1 = bandit UCB, 2 = poursuite adaptative */
+} genetic_params;
+
+
+
+/** Fills @p params with the defaults of settings.h. */
+void genetic_default_params(genetic_params* params);
+
+/** Creates an engine; NULL if the parameters are invalid. */
+genetic_engine* genetic_create(const genetic_params* params);
+
+/** Destroys an engine (NULL is accepted). */
+void genetic_destroy(genetic_engine* engine);
+
+/** Seeds the generators and builds generation 0. */
+int genetic_init(genetic_engine* engine);
+
+/**
+ * Produces @p n generations (fewer if max_gen is reached). The population size may change (population_policy).
+ * Unlike the genetic algorithm, DE and CMA-ES evaluate each generation while producing it.
+ */
+int genetic_step(genetic_engine* engine, size_t n);
+
+/**
+ * 1 once max_gen generations have been produced, the population has converged (min_hamming_ratio;
+ * for CMA-ES, a vanishing step or an ill-conditioned covariance), or the run was stopped by time_limit, max_evaluations or genetic_request_stop; 0 otherwise.
+ */
+int genetic_finished(const genetic_engine* engine);
+
+/** Why the run is over: 0 running, 1 max_gen, 2 converged, 3 time_limit, 4 max_evaluations, 5 stop request. */
+int genetic_stop_reason(const genetic_engine* engine);
+
+/**
+ * Asks every engine of the process to stop cleanly (they keep their best-so-far agent).
+ * Async-signal-safe: a host may call it from its own SIGINT handler.
+ */
+void genetic_request_stop(void);
+
+/** Lowers the stop request before starting new runs. */
+void genetic_clear_stop(void);
+
+size_t genetic_generation(const genetic_engine* engine);
+size_t genetic_evaluations(const genetic_engine* engine);
+
+/** The points evaluated per generation: the population, or lambda for CMA-ES. */
+size_t genetic_population_size(const genetic_engine* engine);
+
+/** The seed actually used (the random one if the parameters asked for 0), once init has run. */
+uint64_t genetic_seed(const genetic_engine* engine);
+
+/**
+ * Diversity of the current generation (see diversity.h): mean pairwise Hamming distance as a share
+ * of the bits of an agent, and share of exact duplicates (either pointer may be NULL).
+ */
+int genetic_diversity(genetic_engine* engine, double* mean_hamming_ratio, double* duplicate_ratio);
+
+/**
+ * Serves the live metrics of the engine in the Prometheus text format (see metrics.h) on @p address:
+ * a Unix socket path, or "tcp:<port>" for a port bound to 127.0.0.1. Scraping never slows the run.
+ * The server stops with genetic_destroy; a second call replaces it.
+ */
+int genetic_metrics_listen(genetic_engine* engine, const char* address);
+
+/** Index and fitness of the best agent of the current generation (either pointer may be NULL). */
+int genetic_best(genetic_engine* engine, size_t* index, double* fitness);
+
+/**
+ * Decoded coordinates (as genetic_coordinates) of the best agent evaluated since genetic_init, with its
+ * fitness and generation (any pointer may be NULL). NULL if no agent was evaluated yet, or on failure.
+ * Available with every algorithm; the pointer stays valid until the next genetic_step, genetic_init or
+ * genetic_best_so_far on the same handle.
+ */
+const double* genetic_best_so_far(const genetic_engine* engine, double* fitness, size_t* generation, size_t* count);
+
+/** Writes a checkpoint (population.gen and best.ind) into the folder @p folder, created if needed. */
+int genetic_checkpoint(const genetic_engine* engine, const char* folder);
+
+/**
+ * Fitness of every agent of the current generation; *count receives the population size. NULL on failure.
+ * Agents left unevaluated by a stop read NaN.
+ */
+const double* genetic_fitness(genetic_engine* engine, size_t* count);
+
+/**
+ * Packed genes of agent @p agent: field k (gene k, then the mutation probabilities) occupies the
+ * bits [k*genetic_gene_bits(), (k+1)*genetic_gene_bits()) of the words. *word_count receives the
+ * number of words. NULL on failure.
+ */
+const uint32_t* genetic_genes(const genetic_engine* engine, size_t agent, size_t* word_count);
+
+/**
+ * Decoded coordinates of agent @p agent: vector i, coordinate j at index i*genetic_dimension() + j.
+ * They are expressed in the compile-time interval (genetic_canonical_domain); a run on another
+ * domain maps x to min_real + (x - canonical_min) * (max_real - min_real) / (canonical_max - canonical_min).
+ * Without CachePhenotype (settings.h), the agents keep only their packed genes: the coordinates are decoded
+ * into a buffer of the handle, overwritten by the next call. NULL on failure.
+ */
+const double* genetic_coordinates(const genetic_engine* engine, size_t agent, size_t* count);
+
+/** Compile-time shape of an agent (settings.h). */
+size_t genetic_vectors(void);
+size_t genetic_dimension(void);
+size_t genetic_gene_bits(void);
+
+/** The compile-time interval in which genes are decoded (min_real, max_real of settings.h). */
+void genetic_canonical_domain(double* min, double* max);
+
+/** Message of the last failure on the calling thread ("" if none). */
+const char* genetic_last_error(void);
+
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+/**
+ * @file kernels.h
+ * @brief Hot numeric kernels, compiled for several instruction sets and
+ *        selected at run time.
+ *
+ * The same kernel source (kernels_impl.h) is compiled once per instruction
+ * set, each time in its own translation unit with its own architecture flags:
+ *
+ *   - scalar : no architecture flag, runs everywhere;
+ *   - avx2   : AVX2 + FMA + BMI2 + POPCNT (x86-64, GCC/Clang builds only);
+ *   - avx512 : AVX-512 F/BW/VL/VPOPCNTDQ on top of avx2 (idem).
+ *
+ * The first call to kernels() picks the best variant the processor supports
+ * (CPUID) and logs its choice on std::clog. The environment variable
+ * GENETIC_ISA=scalar|avx2|avx512 forces a variant, e.g. to exercise the
+ * scalar path on a recent machine; a variant the processor lacks falls back
+ * to the best supported one.
+ *
+ * Every variant returns bit-identical results (the kernel translation units
+ * are compiled without floating-point contraction), so the choice of variant
+ * never changes a seeded run. kernels_self_check() verifies this on the
+ * current machine.
+ */
+
+#include "settings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+
+
+/**
+ * @enum Isa
+ * @brief The instruction sets a kernel variant can be compiled for.
+ */
+enum class Isa { Scalar, Avx2, Avx512 };
+
+
+/**
+ * @struct KernelTable
+ * @brief One variant of the kernels.
+ */
+struct KernelTable {
+    Isa isa;
+    const char* name;
+
+    /// out[k] = bin_to_real(bins[k]) for k in [0, n)
+    void (*decode_genes)(const integer* bins, size_t n, real* out);
+
+    /// out[k] = offset + (in[k] - origin) * scale for k in [0, n) (in == out allowed)
+    void (*remap)(const real* in, size_t n, real origin, real scale, real offset, real* out);
+
+    /// one-point crossover of the bit range [first, last) of packed words, cut at bit @p cut (see PackedArray::splice)
+    void (*splice)(const integer* a, const integer* b, integer* c1, integer* c2,
+                   size_t first, size_t cut, size_t last);
+
+    /// number of set bits in words[0..n)
+    uint64_t (*popcount)(const integer* words, size_t n);
+
+    /// number of differing bits between a[0..n) and b[0..n)
+    uint64_t (*hamming)(const integer* a, const integer* b, size_t n);
+
+    /// out[l] = fitness_expression (objective.h) of agent l for l in [0, count), count <= fx::block;
+    /// coordinate k of agent l is coords[k * fx::block + l]
+    void (*fitness_block)(const real* coords, size_t count, real* out);
+
+    /// fitness_expression of one agent whose coordinates are contiguous (same value as its lane in fitness_block)
+    real (*fitness_agent)(const real* coords);
+};
+
+
+
+/**
+ * @brief The variant used by the program, selected on the first call.
+ */
+const KernelTable& kernels();
+
+/**
+ * @brief A given variant.
+ * @return nullptr if the variant is not compiled in or not supported by this processor.
+ */
+const KernelTable* kernel_variant(Isa isa);
+
+/**
+ * @brief A variant given by its name ("scalar", "avx2", "avx512", as in GENETIC_ISA).
+ * @return nullptr if the name is unknown, or the variant not compiled in or not supported.
+ */
+const KernelTable* kernel_variant(const char* name);
+
+/**
+ * @brief Runs every supported variant on the same inputs and compares them with the scalar one.
+ *
+ * Every variant, the scalar one included, is also checked on inputs whose
+ * results are known: decoding of the domain bounds, popcount, the Hamming
+ * distance to words with known flipped bits and a splice of an all-zero and
+ * an all-one parent.
+ * @param os Receives one line per variant.
+ * @param only If not nullptr, the only variant checked (besides the scalar definitions), e.g. kernel_variant(name)
+ *             for a variant forced by GENETIC_ISA.
+ * @return true if every variant checked matches the scalar results bit for bit.
+ */
+bool kernels_self_check(std::ostream& os, const KernelTable* only = nullptr);
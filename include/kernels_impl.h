@@ -0,0 +1,135 @@
+/**
+ * @file kernels_impl.h
+ * @brief Source of the kernels declared in kernels.h, compiled once per instruction set.
+ *
+ * Internal header: only src/kernels_*.cpp include it, after defining
+ *   - KERNEL_NAMESPACE : the namespace receiving this variant (e.g. kernels_avx2);
+ *   - KERNEL_ISA       : the Isa enumerator of this variant;
+ *   - KERNEL_NAME      : its name, as accepted by GENETIC_ISA.
+ * The variant is exported as KERNEL_NAMESPACE::table.
+ *
+ * Everything here is plain loops left to the compiler's vectorizer. The code
+ * must not call any inline function or template shared with the rest of the
+ * program (std::min, bin_to_real, PackedArray...): the linker keeps a single
+ * copy of those, and it could be the one compiled with AVX-512 flags.
+ */
+
+#include "kernels.h"
+
+// les types de l'expression fitness sont propres à chaque variante (voir expression.h)
+#define FX_VARIANT KERNEL_NAMESPACE
+#include "objective.h"
+
+#include <climits>
+
+
+
+namespace KERNEL_NAMESPACE {
+namespace {
+
+constexpr size_t word_bits = sizeof(integer) * CHAR_BIT;
+
+
+
+void decode_genes(const integer* bins, size_t n, real* out) {
+    // même formule, dans le même ordre, que bin_to_real
+    for (size_t k = 0; k < n; k++) {
+        out[k] = min_real + (static_cast<real>(bins[k]) / static_cast<real>(bin_max)) * real_size;
+    }
+}
+
+void remap(const real* in, size_t n, real origin, real scale, real offset, real* out) {
+    for (size_t k = 0; k < n; k++) {
+        out[k] = offset + (in[k] - origin) * scale;
+    }
+}
+
+
+
+// bits d'un mot dont la position relative est < p, p étant ramené dans [0, word_bits]
+inline uint64_t below(int64_t p) {
+    p = p < 0 ? 0 : p;
+    p = p > int64_t(word_bits) ? int64_t(word_bits) : p;
+    return (uint64_t(1) << p) - 1;
+}
+
+void splice(const integer* a, const integer* b, integer* c1, integer* c2,
+            size_t first, size_t cut, size_t last)
+{
+    size_t w_first = first / word_bits;
+    size_t w_last  = (last + word_bits - 1) / word_bits;
+
+    // les masques sont calculés sans branche : la boucle se vectorise
+    for (size_t w = w_first; w < w_last; w++) {
+        int64_t origin = int64_t(w * word_bits);
+        uint64_t lo  = below(int64_t(first) - origin);
+        uint64_t mid = below(int64_t(cut)   - origin);
+        uint64_t hi  = below(int64_t(last)  - origin);
+
+        integer m_head = integer(mid & ~lo); // bits venant du premier parent pour c1
+        integer m_tail = integer(hi & ~mid); // bits venant du second parent pour c1
+        integer keep   = integer(~(m_head | m_tail));
+
+        integer wa = a[w];
+        integer wb = b[w];
+        c1[w] = (c1[w] & keep) | (wa & m_head) | (wb & m_tail);
+        c2[w] = (c2[w] & keep) | (wb & m_head) | (wa & m_tail);
+    }
+}
+
+
+
+// nombre de bits à 1 d'un mot
+inline uint64_t bit_count(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return uint64_t(__builtin_popcountll(x));
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (x * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+uint64_t popcount(const integer* words, size_t n) {
+    uint64_t count = 0;
+    for (size_t k = 0; k < n; k++) {
+        count += bit_count(words[k]);
+    }
+    return count;
+}
+
+uint64_t hamming(const integer* a, const integer* b, size_t n) {
+    uint64_t count = 0;
+    for (size_t k = 0; k < n; k++) {
+        count += bit_count(a[k] ^ b[k]);
+    }
+    return count;
+}
+
+
+
+void fitness_block(const real* coords, size_t count, real* out) {
+    fx::evaluate_block(fitness_expression, coords, count, out);
+}
+
+real fitness_agent(const real* coords) {
+    return fx::evaluate(fitness_expression, coords);
+}
+
+} // namespace
+
+
+
+extern const KernelTable table = {
+    KERNEL_ISA, KERNEL_NAME,
+    &decode_genes,
+    &remap,
+    &splice,
+    &popcount,
+    &hamming,
+    &fitness_block,
+    &fitness_agent,
+};
+
+} // namespace KERNEL_NAMESPACE
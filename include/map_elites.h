@@ -0,0 +1,198 @@
+#pragma once
+/**
+ * @file map_elites.h
+ * @brief MapElites: a quality-diversity engine keeping the best agent of each
+ *        cell of a grid of behaviours.
+ *
+ * The behaviour of an agent is given by descriptor() (genetic.cpp):
+ * DescriptorDims characteristics in [0, 1], computed on its decoded vectors.
+ * Each characteristic is cut into Parameters::map_cells cells; the archive
+ * keeps, for every cell, the agent with the highest fitness seen there (its
+ * elite). The result of a run is the whole archive, a set of good solutions
+ * spread over the behaviours, rather than a single best agent.
+ *
+ * Each generation builds Parameters::populationSize() children: two elites
+ * drawn uniformly among the occupied cells are crossed (cross_over), their
+ * children mutated (Individu::Mutate), then evaluated as one batch and
+ * inserted into the archive. Generation 0 is a random population spread
+ * over the domain (Parameters::initialization).
+ *
+ * The parents are drawn on the calling thread and the insertion does not
+ * depend on the scheduling: a run is reproducible for a given seed and a
+ * given number of workers, as for GeneticEngine.
+ */
+
+#include "optimizer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+
+
+/**
+ * @class EliteArchive
+ * @brief The elites of a MAP-Elites grid, with O(1) insertion and sampling.
+ *
+ * A grid of at most MapElitesDenseCells cells is dense: one slot per cell,
+ * indexed directly. A larger grid is hashed: an open-addressing table of
+ * MapElitesHashCapacity slots holds the occupied cells only; once it is
+ * full, candidates falling in new cells are dropped (see dropped()).
+ *
+ * A batch is inserted in parallel in two passes. First every candidate
+ * claims its cell with a compare-and-swap, if it beats the elite in place
+ * and the candidate already claiming it (highest fitness, then lowest index
+ * in the batch); then every winner copies itself into its cell. The result
+ * is the same whatever the number of workers.
+ */
+class EliteArchive {
+private:
+    static constexpr uint32_t free_claim = uint32_t(-1);   // aucune revendication en cours
+    static constexpr uint64_t empty_key  = uint64_t(-1);   // emplacement libre d'une archive hachée
+
+    size_t m_cells_per_dim = 0;
+    uint64_t m_cells = 0;                           // le nombre de cases de la grille
+    bool m_hashed = false;
+    size_t m_capacity = 0;                          // le nombre d'emplacements
+
+    std::vector<Agent> m_agents;                    // l'élite de chaque emplacement
+    std::vector<real> m_fitness;                    // sa fitness, NaN pour un emplacement vide
+    std::vector<Descriptor> m_descriptors;          // ses caractéristiques
+    std::vector<size_t> m_stamps;                   // l'estampille de l'insertion qui l'a placée
+    std::unique_ptr<std::atomic<uint32_t>[]> m_claims;  // le candidat du lot en cours qui revendique l'emplacement
+    std::unique_ptr<std::atomic<uint64_t>[]> m_keys;    // archive hachée : la case de chaque emplacement
+
+    std::vector<uint32_t> m_occupied;               // les emplacements occupés, dans l'ordre de leur première élite
+    std::vector<size_t> m_slots;                    // l'emplacement de chaque candidat du lot en cours
+    std::vector<uint8_t> m_fresh;                   // le candidat occupe un emplacement jusque-là vide
+    size_t m_dropped = 0;
+
+    // l'emplacement de la case cell, créé si besoin (archive hachée) ; size_t(-1) si la table est pleine
+    size_t slotOf(uint64_t cell);
+
+public:
+    EliteArchive() = default;
+
+    /**
+     * @param cells_per_dim The number of cells on each characteristic (>= 1).
+     */
+    explicit EliteArchive(size_t cells_per_dim);
+
+    EliteArchive(EliteArchive&&) = default;
+    EliteArchive& operator=(EliteArchive&&) = default;
+
+    /// The cell of a descriptor: its characteristics, cut into cells_per_dim parts each, in mixed radix.
+    uint64_t cellOf(const Descriptor& d) const;
+
+    /**
+     * @brief Inserts a batch of candidates.
+     *
+     * Candidate k (agents[k], fitness[k], descriptors[k]) replaces the elite
+     * of its cell if its fitness is strictly higher; a NaN fitness (agent
+     * left unevaluated) is ignored.
+     *
+     * @param stamp Recorded with every elite placed, see writeChanges().
+     * @return The number of cells whose elite changed.
+     */
+    size_t insert(std::span<const Agent> agents, std::span<const real> fitness,
+                  std::span<const Descriptor> descriptors, size_t stamp, ThreadPool* pool);
+
+    /// A slot drawn uniformly among the occupied ones (Randomizer of the calling thread). @pre size() > 0
+    size_t sample() const;
+
+    size_t size() const { return m_occupied.size(); }               // les cases occupées
+    uint64_t cells() const { return m_cells; }                      // les cases de la grille
+    bool hashed() const { return m_hashed; }
+    size_t dropped() const { return m_dropped; }                    // les candidats écartés, table pleine
+    size_t memory() const;                                          // les octets réservés
+
+    /// The occupied slots, in the order their cell was first filled.
+    std::span<const uint32_t> occupied() const { return m_occupied; }
+
+    const Agent& elite(size_t slot) const { return m_agents[slot]; }
+    real fitness(size_t slot) const { return m_fitness[slot]; }
+    const Descriptor& descriptor(size_t slot) const { return m_descriptors[slot]; }
+    size_t stamp(size_t slot) const { return m_stamps[slot]; }
+    uint64_t cell(size_t slot) const { return m_hashed ? m_keys[slot].load(std::memory_order_relaxed) : uint64_t(slot); }
+
+    /**
+     * @brief Writes one line per elite placed with a stamp >= @p since:
+     *        its stamp, its cell, its fitness, its characteristics, then its
+     *        vectors expressed in @p domain (comma-separated).
+     *
+     * Appending the lines of successive calls to a file gives an incremental
+     * snapshot: the last line of each cell is its current elite.
+     */
+    void writeChanges(std::ostream& os, size_t since, const Domain& domain) const;
+};
+
+
+
+class MapElites : public Optimizer {
+private:
+    EliteArchive m_archive;
+    Population m_batch;                             // les enfants de la génération en cours
+    std::vector<uint32_t> m_plan;                   // les emplacements de leurs parents, deux par couple
+    std::vector<Agent::phenotype> m_points;         // leurs vecteurs, dans le domaine
+    std::vector<real> m_values;                     // leur fitness (NaN si non évalués)
+    std::vector<Descriptor> m_descriptors;          // leurs caractéristiques
+
+    Solution m_best;                                // le meilleur point évalué depuis init()
+    size_t m_snapshot = 0;                          // la première estampille que la prochaine sauvegarde écrira
+
+    // évalue les count premiers agents de m_batch et les insère avec l'estampille stamp ; renvoie le nombre évalué
+    size_t evaluateAndInsert(size_t count, size_t stamp);
+
+    void publishMetrics(double seconds, size_t evaluations);
+
+public:
+    /**
+     * @param params Parameters of the run; each generation has
+     *        params.populationSize() children.
+     * @param pool Pool running the operators and the evaluations, nullptr to run serially on the caller.
+     * @throw std::invalid_argument if @p params is invalid.
+     */
+    explicit MapElites(const Parameters& params, ThreadPool* pool = &ThreadPool::global());
+
+    /**
+     * @brief Seeds the generators, builds an empty archive, then evaluates a
+     *        random generation 0 and inserts it.
+     */
+    void init() override;
+
+    /**
+     * @brief Produces @p n generations of children from the archive.
+     *
+     * With save (settings.h), every save_interval generations the cells
+     * changed since the previous save are appended to directory/archive.csv
+     * (see appendSnapshot()).
+     */
+    void step(size_t n = 1) override;
+
+    Solution bestSolution() const override { return m_best; }
+
+    /// Prints the best elite, then the coverage of the grid.
+    void printBest(std::ostream& os) override;
+
+    /**
+     * @brief population.gen: the parameter line, then one elite per line
+     *        (the columns of EliteArchive::writeChanges); plus best.ind.
+     */
+    void saveCheckpoint(const std::string& folder) const override;
+
+    /**
+     * @brief Appends to @p path the elites placed since the previous call
+     *        (every elite on the first call, which also writes the header).
+     * @throw std::runtime_error if the file cannot be written.
+     */
+    void appendSnapshot(const std::string& path);
+
+    size_t populationSize() const override { return m_batch.size(); }
+
+    const EliteArchive& archive() const { return m_archive; }
+};
@@ -0,0 +1,138 @@
+#pragma once
+/**
+ * @file metrics.h
+ * @brief Live metrics of running engines, served in the Prometheus text format.
+ *
+ * Every GeneticEngine publishes an EngineMetrics block once per generation:
+ * plain relaxed stores to lock-free atomics, with no lock, no allocation and
+ * no system call besides reading the steady clock around each stage.
+ *
+ * A MetricsServer owns one background thread listening on a local socket.
+ * Each connection receives a snapshot of the watched engines in the
+ * Prometheus exposition format (text 0.0.4), as an HTTP response if the
+ * client sent an HTTP request, as the bare text otherwise. Scraping only
+ * loads the atomics, so it never blocks nor slows down the generation loop.
+ *
+ * Examples:
+ * @code
+ * curl --unix-socket /tmp/genetic.sock http://localhost/metrics
+ * socat - UNIX-CONNECT:/tmp/genetic.sock
+ * curl http://127.0.0.1:9464/metrics            # with the address "tcp:9464"
+ * @endcode
+ *
+ * The server needs POSIX sockets; elsewhere its constructor throws.
+ */
+
+#include "settings.h"
+#include "parallel.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+
+/**
+ * @enum Stage
+ * @brief The stages of a generation, timed separately.
+ */
+enum class Stage { Selection, Crossover, Mutation, Resize, Surrogate, Memetic, Diversity };
+
+constexpr size_t StageCount = 7;
+
+/// The label of a stage in the exposition ("selection", "crossover"...).
+const char* to_string(Stage s);
+
+
+
+/**
+ * @struct EngineMetrics
+ * @brief The published state of one engine.
+ *
+ * Written by the thread running the engine, read by any other thread.
+ */
+struct EngineMetrics {
+    static_assert(std::atomic<double>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+                  "publishing the metrics must never take a lock");
+
+    std::atomic<uint64_t> generation { 0 };         // la génération courante
+    std::atomic<uint64_t> evaluations { 0 };        // les appels à la fonction fitness depuis init()
+    std::atomic<double> evaluations_per_second { 0 };   // sur la dernière génération
+    std::atomic<double> best_fitness { std::numeric_limits<double>::quiet_NaN() };  // NaN tant qu'inconnue
+    std::atomic<double> mean_fitness { std::numeric_limits<double>::quiet_NaN() };
+    std::atomic<uint64_t> population { 0 };         // le nombre d'agents de la génération courante
+    std::atomic<uint64_t> memory_bytes { 0 };       // la mémoire réservée par le moteur (populations, tampons, substitut)
+    std::array<std::atomic<uint64_t>, StageCount> stage_nanoseconds {};    // le temps passé dans chaque étape depuis init()
+
+    const ThreadPool* pool = nullptr;               // le pool du moteur (nullptr = séquentiel), fixé à la construction
+
+    // un serveur lit ce bloc : le moteur publie alors la fitness de chaque génération
+    std::atomic<bool> watched { false };
+
+    void addStage(Stage s, uint64_t ns) {
+        std::atomic<uint64_t>& t = stage_nanoseconds[size_t(s)];
+        t.store(t.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed); // un seul écrivain
+    }
+};
+
+
+
+/**
+ * @brief Writes the metrics of @p runs in the Prometheus exposition format.
+ * @param runs The blocks to expose, each with the value of its "run" label.
+ */
+void write_prometheus(std::ostream& os, const std::vector<std::pair<std::string, std::shared_ptr<EngineMetrics>>>& runs);
+
+
+
+/**
+ * @class MetricsServer
+ * @brief Serves the metrics of the watched engines on a local socket.
+ */
+class MetricsServer {
+private:
+    std::string m_address;
+    std::string m_socket_path;      // fichier de la socket Unix, à supprimer à l'arrêt (vide en TCP)
+    int m_listen = -1;
+    int m_wake[2] = { -1, -1 };     // écrire dans m_wake[1] réveille le thread pour l'arrêter
+
+    std::mutex m_mutex;             // protège m_runs : jamais pris par un moteur
+    std::vector<std::pair<std::string, std::shared_ptr<EngineMetrics>>> m_runs;
+
+    std::thread m_thread;
+
+    void serve();
+
+public:
+    /**
+     * @param address A Unix socket path ("/tmp/genetic.sock" or "unix:/tmp/genetic.sock"),
+     *                or a TCP port bound to 127.0.0.1 ("tcp:9464").
+     * @throw std::runtime_error if the socket cannot be opened.
+     */
+    explicit MetricsServer(const std::string& address);
+
+    /// Stops the thread and removes the socket file.
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Exposes @p metrics under the label run="@p run".
+     *
+     * The block is kept alive by the server. Its pool, if any, must outlive
+     * the server.
+     */
+    void watch(std::shared_ptr<EngineMetrics> metrics, const std::string& run = "0");
+
+    /// The address the server listens on.
+    const std::string& address() const { return m_address; }
+};
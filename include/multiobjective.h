@@ -0,0 +1,64 @@
+#pragma once
+/**
+ * @file multiobjective.h
+ * @brief Pareto ranking and crowding distance for the multi-objective (NSGA-II) mode.
+ *
+ * Objective vectors are passed row-major: objectives[i*m + k] is objective k of
+ * point i. Every objective is MAXIMIZED, like the scalar fitness. A point a
+ * dominates b when a is >= b on every objective and > b on at least one.
+ *
+ * - non_dominated_sort assigns each point the index of its Pareto front
+ *   (0 = non-dominated). For m <= 3 it runs a sweep in O(N log N · log F)
+ *   (F = number of fronts); for m > 3 it falls back to the classic fast
+ *   non-dominated sort in O(m N²).
+ * - crowding_distance computes the NSGA-II crowding distance of every point
+ *   within its front in O(m N log N).
+ *
+ * Neither function allocates per point beyond O(N) scratch space, and both are
+ * deterministic.
+ */
+
+#include "settings.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+
+
+/**
+ * @brief Assigns to every point the index of its Pareto front.
+ *
+ * @param[in] objectives Row-major n×m matrix of objective values (maximized).
+ * @param[in] n Number of points.
+ * @param[in] m Number of objectives (>= 1).
+ * @param[out] rank Receives n front indices, 0 for the non-dominated points.
+ *
+ * Identical objective vectors receive the same rank.
+ */
+void non_dominated_sort(const real* objectives, size_t n, size_t m, std::vector<size_t>& rank);
+
+
+/**
+ * @brief Computes the crowding distance of every point within its front.
+ *
+ * @param[in] objectives Row-major n×m matrix of objective values.
+ * @param[in] n Number of points.
+ * @param[in] m Number of objectives.
+ * @param[in] rank Front index of every point, as produced by non_dominated_sort.
+ * @param[out] crowding Receives n distances. The extreme points of each front on
+ *                      any objective get +infinity; each objective contributes
+ *                      its neighbour gap normalized by the front's range.
+ */
+void crowding_distance(const real* objectives, size_t n, size_t m,
+                       const std::vector<size_t>& rank, std::vector<real>& crowding);
+
+
+/**
+ * @brief NSGA-II crowded comparison: lower rank wins, then larger crowding distance.
+ * @return true if point a is strictly preferred to point b.
+ */
+inline bool crowded_better(size_t rank_a, real crowding_a, size_t rank_b, real crowding_b) noexcept {
+    if (rank_a != rank_b) return rank_a < rank_b;
+    return crowding_a > crowding_b;
+}
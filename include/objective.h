@@ -0,0 +1,20 @@
+#pragma once
+/**
+ * @file objective.h
+ * @brief The fitness written as an expression (see expression.h), used
+ *        instead of fitness() when UseFitnessExpression is true.
+ *
+ * It must describe the same function as fitness() in genetic.cpp if both are
+ * meant to coexist; only one of them is called during a run.
+ */
+
+#include "expression.h"
+
+
+
+/*
+    La fonction fitness sous forme d'expression : la somme des coordonnées des vecteurs, le tout au carré
+*   fx::vec<i> est le vecteur i, fx::coords toutes les coordonnées ; voir expression.h pour les opérations
+!   NE PAS DÉCLARER inline : chaque variante des noyaux doit garder sa propre copie
+*/
+constexpr auto fitness_expression = -fx::square(fx::sum(fx::coords));                              //? la fonction fitness en expression
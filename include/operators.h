@@ -0,0 +1,82 @@
+#pragma once
+/**
+ * @file operators.h
+ * @brief Adaptive operator selection: a multi-armed bandit sharing the
+ *        offspring of a generation among several variation operators.
+ *
+ * Each operator is an arm. Before breeding, assign() gives an operator to
+ * every offspring; once the offspring are evaluated, credit() records the
+ * fitness improvement each one brought (improvements below 0 count as 0),
+ * and update() turns the generation's records into a reward per arm: its
+ * mean improvement divided by the best mean, in [0, 1]. The quality of an
+ * arm follows its rewards with the learning rate OperatorLearningRate:
+ *
+ *     q_a += alpha (r_a - q_a)
+ *
+ * and the policy (operator_policy, settings.h) turns the qualities into the
+ * share of the next offspring given to each arm:
+ *
+ * - Ucb: every offspring goes to the arm maximising
+ *   q_a + OperatorExploration sqrt(2 ln N / n_a), n_a counting the offspring
+ *   already given to arm a (N to all arms). The counts fade by
+ *   (1 - alpha) every generation, so that an arm that falls behind gets
+ *   tried again.
+ * - AdaptivePursuit: every offspring draws its arm from the shares p_a,
+ *   which pursue the best arm b:
+ *
+ *       p_b += beta (p_max - p_b),   p_a += beta (p_min - p_a) otherwise,
+ *
+ *   with p_min = OperatorMinShare and p_max = 1 - (K - 1) p_min: no arm
+ *   ever drops below p_min.
+ *
+ * The bookkeeping is a few operations per offspring, on the calling thread:
+ * the choices depend only on its Randomizer, a run stays reproducible.
+ */
+
+#include "settings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+
+class OperatorBandit {
+private:
+    OperatorPolicy m_policy = OperatorPolicy::Fixed;
+    std::vector<real> m_quality;    // la qualité estimée de chaque opérateur, dans [0, 1]
+    std::vector<real> m_share;      // la part des enfants confiée à chaque opérateur
+    std::vector<real> m_pulls;      // Ucb : le nombre (estompé) d'enfants confiés à chaque opérateur
+    std::vector<real> m_gain;       // la génération en cours : la somme des améliorations de chaque opérateur
+    std::vector<size_t> m_count;    // et le nombre de ses enfants crédités
+
+public:
+    OperatorBandit() = default;
+
+    /**
+     * @param policy Ucb or AdaptivePursuit (Fixed always gives arm 0).
+     * @param arms The number of operators, 1 to 255.
+     * @throw std::invalid_argument if @p arms is out of range.
+     */
+    OperatorBandit(OperatorPolicy policy, size_t arms);
+
+    /// Gives an operator to each of the out.size() next offspring.
+    void assign(std::span<uint8_t> out);
+
+    /// Records an offspring of operator @p arm whose fitness improved by @p improvement.
+    void credit(size_t arm, real improvement) {
+        m_gain[arm] += improvement > 0 ? improvement : 0;
+        m_count[arm]++;
+    }
+
+    /// Turns the credits recorded since the previous call into new qualities and shares.
+    void update();
+
+    size_t arms() const { return m_quality.size(); }
+    OperatorPolicy policy() const { return m_policy; }
+
+    /// The share of each operator among the offspring of the last assign().
+    std::span<const real> shares() const { return m_share; }
+    std::span<const real> quality() const { return m_quality; }
+};
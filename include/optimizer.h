@@ -0,0 +1,207 @@
+#pragma once
+/**
+ * @file optimizer.h
+ * @brief Optimizer: the interface shared by every optimization engine.
+ *
+ * Four engines implement it, selected at run time by Parameters::algorithm
+ * (see make_optimizer):
+ *   - GeneticEngine (engine.h): the genetic algorithm on packed genes;
+ *   - DifferentialEvolution (differential_evolution.h): DE/rand/1/bin on the
+ *     real coordinates;
+ *   - CmaEs (cmaes.h): CMA-ES on the real coordinates;
+ *   - MapElites (map_elites.h): an archive of the best agent of each cell of
+ *     a grid of behaviours, bred with the genetic operators.
+ *
+ * They share the fitness hook (eval_vectors, i.e. fitness() or the
+ * fitness expression), the per-thread Randomizer seeded from
+ * Parameters::seed, the stopping rules (max_gen, time_limit,
+ * max_evaluations, SIGINT / SIGTERM), the metrics block and the checkpoint
+ * folder layout. The base class holds that common state and the helpers
+ * implementing it; an engine only provides its generation step.
+ */
+
+#include "genetic.h"
+#include "metrics.h"
+#include "parameters.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+
+
+
+/**
+ * @enum StopReason
+ * @brief Why a run is over (Running while it is not).
+ */
+enum class StopReason { Running, Generations, Converged, Deadline, Evaluations, Signal };
+
+/// The label of a stop reason ("running", "generations", "converged", "deadline", "evaluations", "signal").
+const char* to_string(StopReason r);
+
+/// The label of an algorithm ("genetic", "de", "cmaes", "map-elites").
+const char* to_string(Algorithm a);
+
+/**
+ * @brief The algorithm named @p name, as printed by to_string.
+ * @throw std::invalid_argument if @p name is not an algorithm.
+ */
+Algorithm parse_algorithm(const std::string& name);
+
+
+
+/**
+ * @struct Solution
+ * @brief The best point evaluated by a run, whatever the engine.
+ */
+struct Solution {
+    bool found = false;             // false tant qu'aucun point n'a été évalué
+    real fitness = 0;               // sa fitness
+    size_t generation = 0;          // la génération à laquelle il a été évalué
+    Agent::phenotype vectors {};    // ses vecteurs, exprimés dans Parameters::domain
+};
+
+
+
+class Optimizer {
+protected:
+    Parameters  m_params;
+    ThreadPool* m_pool;
+
+    size_t m_generation  = 0;       // nombre de générations déjà produites
+    size_t m_evaluations = 0;       // nombre d'appels à la fonction fitness
+
+    std::shared_ptr<EngineMetrics> m_metrics;       // l'état publié à chaque génération (metrics.h)
+
+    std::chrono::steady_clock::time_point m_deadline;   // init() + Parameters::time_limit
+    StopReason m_stop = StopReason::Running;        // un arrêt anticipé : échéance, budget d'évaluations ou signal
+
+    /**
+     * @param params Parameters of the run (validated here).
+     * @param pool Pool running the evaluations, nullptr to run serially on the caller.
+     * @throw std::invalid_argument if @p params is invalid.
+     */
+    Optimizer(const Parameters& params, ThreadPool* pool);
+
+    // début de init() : tire la graine si besoin, réensemence le thread appelant et les workers, remet à zéro
+    // les compteurs, l'arrêt, l'échéance et les temps par étape
+    void beginRun();
+
+    // true si l'échéance est passée ou si un signal demande l'arrêt ; lu par les workers pendant les évaluations
+    bool expired() const;
+
+    // true si le run doit s'arrêter maintenant, dont la raison est alors notée dans m_stop
+    bool interrupted();
+
+    // le nombre d'évaluations encore permises par Parameters::max_evaluations
+    size_t evaluationsLeft() const;
+
+    // évalue points[k] dans out[k] (vecteurs exprimés dans le domaine) jusqu'à l'échéance, sur le pool ; les points
+    // laissés sans évaluation valent NaN. Renvoie le nombre évalué, sans le compter dans m_evaluations
+    size_t evaluateVectors(std::span<const Agent::phenotype> points, real* out);
+
+    // publie les compteurs du run et la fitness de la génération courante (NaN si inconnue) dans m_metrics
+    void publish(double seconds, size_t evaluations, real best, real mean, size_t population, size_t memory);
+
+    // un moteur concret reste déplaçable (mais pas à travers un pointeur vers Optimizer)
+    Optimizer(Optimizer&&) = default;
+    Optimizer& operator=(Optimizer&&) = default;
+
+public:
+    virtual ~Optimizer() = default;
+
+    Optimizer(const Optimizer&) = delete;
+    Optimizer& operator=(const Optimizer&) = delete;
+
+    /**
+     * @brief Seeds the generators and builds (and evaluates, for the
+     *        continuous engines) generation 0.
+     */
+    virtual void init() = 0;
+
+    /**
+     * @brief Produces @p n generations, stopping early once the run is over (see finished()).
+     * @pre init() has been called.
+     */
+    virtual void step(size_t n = 1) = 0;
+
+    /**
+     * @brief Runs the remaining generations up to Parameters::max_gen.
+     */
+    void run() { if (m_generation < m_params.max_gen) step(m_params.max_gen - m_generation); }
+
+    /**
+     * @brief true once max_gen generations have been produced, once the
+     *        engine has converged, or once an anytime limit or a stop request
+     *        has ended the run (see stopReason()).
+     */
+    virtual bool finished() const { return m_generation >= m_params.max_gen || m_stop != StopReason::Running; }
+
+    /**
+     * @brief Why the run is over, StopReason::Running while it is not.
+     */
+    virtual StopReason stopReason() const;
+
+    const Parameters& parameters() const { return m_params; }
+    size_t generation() const { return m_generation; }
+
+    /// The number of points evaluated per generation (the population, lambda for CMA-ES, the children for MAP-Elites).
+    virtual size_t populationSize() const = 0;
+    size_t evaluations() const { return m_evaluations; }
+
+    /**
+     * @brief The metrics block of the engine, updated at every generation.
+     */
+    std::shared_ptr<EngineMetrics> metrics() const { return m_metrics; }
+
+    /**
+     * @brief The best point evaluated since init(), whatever its generation.
+     *
+     * This is the result of an anytime run; no evaluation is performed.
+     * Only tracked with a single objective.
+     */
+    virtual Solution bestSolution() const = 0;
+
+    /**
+     * @brief Prints the best point of the current generation and its fitness.
+     */
+    virtual void printBest(std::ostream& os) = 0;
+
+    /**
+     * @brief Writes a checkpoint of the run into the folder @p folder.
+     *
+     * population.gen starts with a line of parameters (seed, generation,
+     * evaluations, algorithm...), followed by the state of the engine;
+     * best.ind holds the best-so-far point.
+     *
+     * @throw std::runtime_error if the files cannot be written.
+     */
+    virtual void saveCheckpoint(const std::string& folder) const = 0;
+
+    /**
+     * @brief A seed derived from @p seed for the stream number @p stream (splitmix64).
+     */
+    static uint64_t deriveSeed(uint64_t seed, uint64_t stream);
+};
+
+
+
+/**
+ * @brief Builds the engine named by @p params.algorithm.
+ * @throw std::invalid_argument if @p params is invalid.
+ */
+std::unique_ptr<Optimizer> make_optimizer(const Parameters& params, ThreadPool* pool = &ThreadPool::global());
+
+
+/**
+ * @brief Writes best.ind, the best-so-far point of a run, into the folder @p folder.
+ *
+ * Does nothing if no point has been evaluated yet.
+ * @throw std::runtime_error if the file cannot be written.
+ */
+void write_solution(const std::string& folder, const Solution& s);
@@ -0,0 +1,236 @@
+#pragma once
+/**
+ * @file parallel.h
+ * @brief NUMA-aware thread pool and placed memory used by the parallel engine.
+ *
+ * This header provides:
+ *  - CpuTopology : the NUMA nodes of the machine and the cpus attached to each
+ *    of them (read from /sys/devices/system/node on Linux, a single node
+ *    holding every hardware thread elsewhere);
+ *  - PlacedBuffer : a page-aligned, untouched allocation optionally backed by
+ *    transparent or explicit huge pages, or by a file for data larger than
+ *    the memory. Its pages are physically placed by the first thread that
+ *    writes them (Linux first-touch policy);
+ *  - ThreadPool : persistent worker threads pinned to cpus according to an
+ *    AffinityPolicy, and a parallel_for that always hands the same index range
+ *    to the same worker for a given size.
+ *
+ * The last point is what makes first-touch placement useful: if a population
+ * is initialized with parallel_for, every later parallel_for over the same
+ * population makes each worker read and write the pages that live on its own
+ * NUMA node.
+ *
+ * Pinning and huge pages are only implemented on Linux; on other platforms the
+ * pool still runs in parallel and the summary reports the features as
+ * unavailable.
+ */
+
+#include "settings.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+
+/**
+ * @struct CpuTopology
+ * @brief The NUMA nodes of the machine and their cpus.
+ */
+struct CpuTopology {
+    std::vector<std::vector<int>> nodes; // nodes[n] = identifiants des cpus du noeud n
+
+    /**
+     * @brief Detects the topology of the current machine.
+     * @return At least one node holding at least one cpu.
+     */
+    static CpuTopology detect();
+
+    size_t cpuCount() const;
+};
+
+
+
+/**
+ * @class PlacedBuffer
+ * @brief Page-aligned raw memory whose pages are not touched at allocation.
+ *
+ * The memory is obtained with mmap on Linux (so that no page is faulted in
+ * before the owning worker writes it) and with aligned operator new elsewhere.
+ * Nothing is constructed in it; callers construct their objects with placement
+ * new from the thread that should own each page.
+ *
+ * A file-backed buffer maps an unnamed file (created then unlinked) instead
+ * of anonymous memory: the kernel writes cold pages back to the disk and
+ * reads them again on demand, so the buffer may exceed the physical memory.
+ * advise() passes access hints to the kernel for such buffers.
+ */
+class PlacedBuffer {
+private:
+    void*  m_data  = nullptr;
+    size_t m_bytes = 0;         // taille réellement réservée (arrondie aux pages)
+    bool   m_mapped = false;    // true si obtenue par mmap
+    bool   m_file   = false;    // true si la projection est adossée à un fichier
+    HugePages m_pages = HugePages::None; // type de pages effectivement obtenu
+
+public:
+    PlacedBuffer() = default;
+
+    /**
+     * @brief Reserves at least @p bytes bytes.
+     * @param bytes Requested size.
+     * @param pages Requested huge page policy; falls back to normal pages if unavailable.
+     * @throw std::bad_alloc if the memory cannot be reserved.
+     */
+    PlacedBuffer(size_t bytes, HugePages pages);
+
+    /**
+     * @brief Reserves at least @p bytes bytes in an unnamed file of @p folder, mapped in memory.
+     *
+     * The file is removed from @p folder as soon as it is mapped: nothing is
+     * left on the disk when the buffer is destroyed or the process dies.
+     * @throw std::runtime_error if the file cannot be created, sized or mapped
+     *        (always on platforms without mmap).
+     */
+    PlacedBuffer(size_t bytes, const std::string& folder);
+    ~PlacedBuffer();
+
+    PlacedBuffer(const PlacedBuffer&) = delete;
+    PlacedBuffer& operator=(const PlacedBuffer&) = delete;
+    PlacedBuffer(PlacedBuffer&& other) noexcept;
+    PlacedBuffer& operator=(PlacedBuffer&& other) noexcept;
+
+    void*     data() const { return m_data; }
+    size_t    bytes() const { return m_bytes; }
+    HugePages pages() const { return m_pages; }
+    bool      fileBacked() const { return m_file; }
+
+    /**
+     * @enum Advice
+     * @brief Access hints for a file-backed buffer.
+     */
+    enum class Advice {
+        Sequential, ///< read in order: aggressive read-ahead, pages dropped behind the reader
+        WillNeed,   ///< about to be read: start reading from the disk now
+        Discard     ///< contents no longer needed: dropped without being written back (they read as zeros)
+    };
+
+    /**
+     * @brief Passes @p advice for the bytes [offset, offset + length) to the kernel.
+     *
+     * Only file-backed buffers are advised: the hints cannot change what a
+     * memory buffer holds. Sequential and WillNeed cover every page touching
+     * the range, Discard only the pages lying entirely inside it.
+     */
+    void advise(Advice advice, size_t offset, size_t length) const;
+};
+
+
+
+/**
+ * @class ThreadPool
+ * @brief Persistent pinned workers with a statically partitioned parallel_for.
+ *
+ * Not reentrant: parallel_for must not be called from inside a job.
+ */
+class ThreadPool {
+private:
+    CpuTopology m_topology;
+    AffinityPolicy m_policy;
+    std::vector<int> m_cpu;         // cpu sur lequel est épinglé chaque worker (-1 si aucun)
+    std::vector<int> m_node;        // noeud NUMA de chaque worker
+    bool m_pinned = false;          // true si l'épinglage a réussi pour tous les workers
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const std::function<void(size_t)>* m_job = nullptr;
+    size_t m_epoch = 0;             // incrémenté à chaque nouveau job
+    std::atomic<size_t> m_pending { 0 }; // nombre de workers n'ayant pas fini le job courant (lisible sans verrou)
+    std::exception_ptr m_error;
+    bool m_stop = false;
+
+    void workerLoop(size_t id);
+    void run(const std::function<void(size_t)>& job);
+
+public:
+    /**
+     * @param threads Number of workers (0 = one per available cpu).
+     * @param policy How workers are pinned to cpus.
+     */
+    ThreadPool(size_t threads, AffinityPolicy policy);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief The pool configured by NumberOfThreads and affinity_policy (settings.h).
+     */
+    static ThreadPool& global();
+
+    size_t size() const { return m_threads.size(); }
+    const CpuTopology& topology() const { return m_topology; }
+    int cpuOf(size_t worker) const { return m_cpu[worker]; }
+    int nodeOf(size_t worker) const { return m_node[worker]; }
+
+    /**
+     * @brief Number of workers still running the current job (0 when idle).
+     *
+     * Lock-free, meant for monitoring from another thread.
+     */
+    size_t busy() const { return m_pending.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief The index range [begin, end) owned by @p worker when @p n items are split.
+     */
+    static std::pair<size_t, size_t> chunk(size_t n, size_t worker, size_t workers) {
+        return { n * worker / workers, n * (worker + 1) / workers };
+    }
+
+    /**
+     * @brief Runs f(begin, end, worker) on every worker and waits for all of them.
+     *
+     * Worker w always receives chunk(n, w, size()), so the same items are
+     * always processed by the same pinned thread. The first exception thrown by
+     * a worker is rethrown in the caller.
+     */
+    template <typename F>
+    void parallel_for(size_t n, F&& f) {
+        size_t workers = size();
+        std::function<void(size_t)> job = [&](size_t w) {
+            auto [begin, end] = chunk(n, w, workers);
+            if (begin < end) f(begin, end, w);
+        };
+        run(job);
+    }
+
+    /**
+     * @brief Prints the topology, the pinning of every worker, and the placement
+     *        of a population of @p n items stored in @p buffer.
+     */
+    void printPlacement(std::ostream& os, size_t n, const PlacedBuffer& buffer) const;
+};
+
+
+
+/**
+ * @brief parallel_for on @p pool, or f(0, n, 0) on the calling thread when @p pool is nullptr.
+ *
+ * Lets the same code run inside an engine owning the pool and inside a job
+ * that is itself already running on a pool worker (which must not reenter it).
+ */
+template <typename F>
+void parallel_for(ThreadPool* pool, size_t n, F&& f) {
+    if (pool)       pool->parallel_for(n, std::forward<F>(f));
+    else if (n > 0) f(size_t(0), n, size_t(0));
+}
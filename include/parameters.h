@@ -0,0 +1,95 @@
+#pragma once
+/**
+ * @file parameters.h
+ * @brief Runtime parameters of one genetic algorithm run.
+ *
+ * settings.h fixes everything that shapes the types (Nb_bin, NumberOfVectors,
+ * Dimension, NumberOfObjectives...). The values gathered here can change from
+ * one run to the next in the same process, which is what the parameter sweep
+ * runner relies on. Their defaults are the settings.h values, so a
+ * default-constructed Parameters reproduces the historical behavior.
+ */
+
+#include "benchmarks.h"
+#include "settings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+
+/**
+ * @struct Domain
+ * @brief The interval [min, max] in which every coordinate of a vector lives,
+ *        and the function evaluated there.
+ *
+ * Genes are always decoded into the compile-time interval [min_real, max_real]
+ * (that is what Individu caches). A run working on another interval maps these
+ * canonical coordinates with the affine transform below, which is exact since
+ * both decodings are linear in the gene.
+ *
+ * The function is fitness() unless the domain names a benchmark (see
+ * benchmarks.h), which is how test functions of any dimension are run without
+ * recompiling.
+ */
+struct Domain {
+    real min = min_real;
+    real max = max_real;
+    Benchmark benchmark = Benchmark::None;  // une fonction de test évaluée à la place de fitness()
+    size_t benchmark_dims = 0;              // ses coordonnées : les premières de l'agent (0 = toutes)
+
+    /// true when the domain is the compile-time one, i.e. when toDomain is the identity
+    bool isCanonical() const noexcept { return min == min_real && max == max_real; }
+
+    /// maps a coordinate decoded in [min_real, max_real] into [min, max]
+    real toDomain(real x) const noexcept { return min + (x - min_real) * ((max - min) / real_size); }
+
+    /// the number of coordinates read by the benchmark
+    size_t benchmarkDims() const noexcept { return benchmark_dims ? benchmark_dims : NumberOfVectors * Dimension; }
+
+    /// maps a coordinate of [min, max] back into [min_real, max_real]
+    real toCanonical(real x) const noexcept { return min_real + (x - min) * (real_size / (max - min)); }
+};
+
+
+
+/**
+ * @struct Parameters
+ * @brief The runtime parameters of a run.
+ */
+struct Parameters {
+    size_t half_population_size = HalfPopulationSize;   // la moitié de la taille (initiale et maximale) de la population, >= 1
+    size_t max_gen              = maxGen;               // le nombre de générations d'enfants
+    real initial_mutation_proba = real(0.9);            // la probabilité de mutation de chaque chromosome à la génération 0
+    Initialization initialization = ::initialization;   // la répartition de la génération 0 dans le domaine
+    Domain domain {};                                   // l'intervalle des coordonnées
+    uint64_t seed = 0;                                  // la graine du générateur aléatoire (0 = graine aléatoire)
+    size_t memetic_elite  = MemeticElite;               // le nombre d'agents d'élite affinés par recherche locale (0 = désactivé)
+    size_t memetic_budget = MemeticBudget;              // le nombre d'évaluations de la recherche locale par agent d'élite
+    PopulationPolicy size_policy    = population_policy;       // la façon dont la taille de la population évolue
+    size_t min_half_population_size = MinHalfPopulationSize;   // la plus petite moitié de population (politiques adaptatives)
+    real min_hamming_ratio = MinHammingRatio;           // arrêt quand la diversité génotypique tombe sous ce seuil (0 = jamais)
+    real surrogate_keep        = SurrogateKeep;         // la part des enfants évalués pour de vrai, sur la prédiction du substitut (1 = désactivé)
+    real surrogate_exploration = SurrogateExploration;  // la part de la population évaluée en plus, au hasard parmi les enfants écartés
+    real time_limit        = TimeLimit;                 // la durée maximale du run en secondes, depuis init() (0 = pas d'échéance)
+    size_t max_evaluations = MaxEvaluations;            // le nombre maximal d'évaluations de la fonction fitness (0 = pas de limite)
+    std::string storage    = PopulationStorage;         // le dossier des fichiers portant les populations ("" = en mémoire)
+    Algorithm algorithm    = ::algorithm;               // l'algorithme d'optimisation (make_optimizer)
+    size_t continuous_population = ContinuousPopulation; // la population de DE et de CMA-ES (0 = leur valeur recommandée)
+    real de_weight         = DeWeight;                  // le facteur F de l'évolution différentielle, dans ]0, 2]
+    real de_crossover      = DeCrossover;               // le taux de croisement CR de l'évolution différentielle, dans [0, 1]
+    size_t map_cells       = MapElitesCells;            // les cases de la grille de MAP-Elites sur chaque caractéristique de comportement
+    bool fused_generation  = FusedGeneration;           // croisement, mutation et évaluation fusionnés par tuiles de couples
+    OperatorPolicy operator_policy = ::operator_policy; // le choix des opérateurs de croisement et de mutation de chaque enfant
+
+    size_t populationSize() const noexcept { return 2 * half_population_size; }
+
+    bool surrogateEnabled() const noexcept { return surrogate_keep < 1; }
+
+    /**
+     * @brief Checks the parameters.
+     * @throw std::invalid_argument if they cannot describe a run.
+     */
+    void validate() const;
+};
@@ -1,113 +1,305 @@
 /**
  * @file randomizer.h
- * @brief Simple static random utilities wrapper around <random>.
+ * @brief Fast static random utilities: xoshiro256++ generators, unbiased
+ *        bounded integers and bulk fills.
  *
  * This header provides the Randomizer class: a collection of static helper
  * functions for generating random numbers and shuffling arrays. The class
- * is non-instantiable (deleted constructor) and manages a single
- * std::mt19937 PRNG and a uniform real distribution used for probability
- * sampling.
+ * is non-instantiable (deleted constructor).
  *
  * Key characteristics:
- * - Lazy initialization: the generator and the real-number distribution are
- *   initialized on first use by calling Randomizer::Init() automatically.
- *   Initialization seeds the PRNG with std::random_device.
- * - Single global generator: a single static std::mt19937 is shared by all
- *   calls. This class is not synchronized for concurrent access; callers
- *   must ensure external synchronization when using Randomizer from
- *   multiple threads.
+ * - Generator: xoshiro256++ (Blackman & Vigna), 256 bits of state, period
+ *   2^256 - 1, a handful of shifts, rotations and additions per 64-bit
+ *   output. Seeds are expanded with splitmix64.
+ * - Unbiased bounded integers: getInt uses Lemire's multiply-and-reject
+ *   method ("Fast Random Integer Generation in an Interval", 2019): one
+ *   multiplication per draw, and a division only in the rare rejection case.
+ *   No distribution object is constructed per call.
+ * - One generator per thread: the state is thread_local and
+ *   constant-initialized, so each thread (e.g. each ThreadPool worker) draws
+ *   from its own stream without synchronization or TLS initialization guard.
+ *   Each thread is seeded with std::random_device on its first use.
+ * - Bulk fills: fillInts, fillProbs and fillBits produce a whole array in one
+ *   call from four interleaved xoshiro256++ lanes, a loop the compiler turns
+ *   into SIMD code. Hot loops can pre-draw their random "tape" this way
+ *   instead of calling the generator once per decision.
  * - Convenience functions:
- *     - getProb(): returns a real in [0.0, 1.0) (uses the configured real type
- *       alias from settings.h).
+ *     - getProb(): returns a real in [0.0, 1.0) with 53 random bits.
  *     - getInt(int min, int max): returns an integer in the inclusive range
  *       [min, max].
+ *     - getBits(int n): returns an `integer` whose n low bits are uniformly
+ *       random (n <= 32), e.g. a full gene of Nb_bin bits.
  *     - getDistinctIntCouple(int min, int max): returns a pair of two
  *       distinct integers sampled uniformly from [min, max]. Requires
  *       min < max (checked via assert).
- *     - shuffle(std::array<T, size>&): shuffles the elements of a std::array
- *       in-place using the internal generator.
- *
- * Notes and usage considerations:
- * - The header depends on settings.h which must define the floating-point
- *   alias `real`. The uniform real distribution for getProb() uses the
- *   range [0.0, 1.0].
- * - getInt and getDistinctIntCouple construct temporary uniform_int_distribution
- *   objects per call, so their cost is dominated by distribution construction
- *   and the underlying PRNG.
- * - getDistinctIntCouple asserts that min < max; use this function only when
- *   at least two distinct values are available in the supplied range.
- * - The class deliberately deletes the default constructor to prevent
- *   instantiation; all functionality is accessed via static methods.
+ *     - shuffle(std::array<T, size>&) / shuffle(first, last): Fisher-Yates
+ *       shuffle of a std::array or of a random-access range in-place.
  *
  * Example:
  * @code
- * // Ensure settings.h defines `real` (e.g., using real = double;)
  * double p = Randomizer::getProb();              // probability in [0,1)
  * int x = Randomizer::getInt(0, 10);             // integer in [0,10]
  * auto pair = Randomizer::getDistinctIntCouple(0, 5); // two distinct ints 0..5
  * std::array<int,4> a = {1,2,3,4};
  * Randomizer::shuffle(a);                        // shuffles a in-place
+ * int tape[256];
+ * Randomizer::fillInts(tape, 256, 0, 5999);      // 256 indices at once
  * @endcode
  *
- * @warning This utility is not thread-safe. If you require concurrent access
- * to the PRNG, protect calls with a mutex or use thread-local engines.
+ * @note Init() and Init(seed) only (re)seed the generators of the calling
+ * thread. Init(seed) makes the streams of that thread reproducible.
  */
 #pragma once
 
 #include <algorithm>
-#include <random>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <utility>
 #include "settings.h"
 #include <cassert>
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+
+
+/**
+ * @brief splitmix64 step: used to expand a 64-bit seed into generator states.
+ */
+inline uint64_t splitmix64(uint64_t& x) noexcept {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * @class Xoshiro256pp
+ * @brief xoshiro256++ generator, usable as a UniformRandomBitGenerator.
+ */
+class Xoshiro256pp {
+private:
+    uint64_t s[4] = { 0, 0, 0, 0 };
+
+    static constexpr uint64_t rotl(uint64_t x, int k) noexcept {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    using result_type = uint64_t;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    constexpr Xoshiro256pp() = default;
+    explicit Xoshiro256pp(uint64_t seed) noexcept { this->seed(seed); }
+
+    void seed(uint64_t seed) noexcept {
+        for (auto& word : s) word = splitmix64(seed);
+    }
+
+    result_type operator()() noexcept {
+        const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+};
+
+
+/**
+ * @class XoshiroLanes
+ * @brief Four independent xoshiro256++ streams advanced together.
+ *
+ * The state is stored lane-major (one array per state word), so next()
+ * is a loop over independent lanes that vectorizes (AVX2: one register per
+ * state word).
+ */
+class XoshiroLanes {
+public:
+    static constexpr size_t lanes = 4;
+
+private:
+    uint64_t s0[lanes] = {}, s1[lanes] = {}, s2[lanes] = {}, s3[lanes] = {};
+
+public:
+    constexpr XoshiroLanes() = default;
+
+    void seed(uint64_t seed) noexcept {
+        for (size_t l = 0; l < lanes; l++) {
+            s0[l] = splitmix64(seed);
+            s1[l] = splitmix64(seed);
+            s2[l] = splitmix64(seed);
+            s3[l] = splitmix64(seed);
+        }
+    }
+
+    /**
+     * @brief Writes one output per lane into out[0..lanes).
+     */
+    void next(uint64_t* out) noexcept {
+        for (size_t l = 0; l < lanes; l++) {
+            uint64_t sum = s0[l] + s3[l];
+            out[l] = ((sum << 23) | (sum >> 41)) + s0[l];
+            uint64_t t = s1[l] << 17;
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = (s3[l] << 45) | (s3[l] >> 19);
+        }
+    }
+};
+
+
+
+/**
+ * @struct RandomizerState
+ * @brief The per-thread generators of Randomizer.
+ */
+struct RandomizerState {
+    Xoshiro256pp generator;     // tirages unitaires
+    XoshiroLanes lanes;         // remplissages en masse
+    bool initialized = false;
+};
+
+
 
 class Randomizer {
 private:
-    static std::mt19937 generator;
-    static std::uniform_real_distribution<real> distrib_proba;
-    static bool initialized;
+    // initialisation constante : l'accès au thread_local ne passe par aucune garde
+    static inline thread_local RandomizerState state {};
+
+    static RandomizerState& get() {
+        if (!state.initialized) Init();
+        return state;
+    }
+
+    // partie haute du produit 64 × 64 bits
+    static uint64_t mulhi(uint64_t a, uint64_t b, uint64_t& lo) noexcept {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 m = static_cast<unsigned __int128>(a) * b;
+        lo = static_cast<uint64_t>(m);
+        return static_cast<uint64_t>(m >> 64);
+#elif defined(_MSC_VER)
+        uint64_t hi;
+        lo = _umul128(a, b, &hi);
+        return hi;
+#else
+        uint64_t a_lo = uint32_t(a), a_hi = a >> 32, b_lo = uint32_t(b), b_hi = b >> 32;
+        uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+        uint64_t mid = (p0 >> 32) + uint32_t(p1) + uint32_t(p2);
+        lo = (mid << 32) | uint32_t(p0);
+        return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+    }
 
 public:
     Randomizer() = delete;
-   
-    static void Init() {
-        std::random_device rd;
-        generator.seed(rd());
-        distrib_proba = std::uniform_real_distribution<real>(0.0, 1.0);
-        initialized = true;
+
+    static void Init();
+
+    static void Init(uint64_t seed) {
+        state.generator.seed(seed);
+        state.lanes.seed(splitmix64(seed) ^ 0x6A09E667F3BCC909ULL); // flux distinct de celui du générateur unitaire
+        state.initialized = true;
     }
-    
-    static real getProb() {
-        if (!initialized) Init();
 
-        return distrib_proba(generator);
+    /**
+     * @brief Unbiased integer in [0, range) (Lemire), range >= 1.
+     */
+    static uint64_t bounded(uint64_t range) {
+        Xoshiro256pp& g = get().generator;
+        uint64_t lo;
+        uint64_t hi = mulhi(g(), range, lo);
+        if (lo < range) {
+            uint64_t threshold = (0 - range) % range; // 2^64 mod range
+            while (lo < threshold) hi = mulhi(g(), range, lo);
+        }
+        return hi;
     }
-    
+
+    static real getProb() {
+        return static_cast<real>((get().generator() >> 11) * 0x1.0p-53);
+    }
+
     static int getInt(int min, int max) {
-        if (!initialized) Init();
-        
-        std::uniform_int_distribution<int> d(min, max);
-        return d(generator);
+        assert(min <= max && "getInt needs min <= max");
+        uint64_t range = uint64_t(int64_t(max) - int64_t(min)) + 1;
+        return static_cast<int>(int64_t(min) + int64_t(bounded(range)));
+    }
+
+    static integer getBits(int n) {
+        assert(n >= 1 && n <= 32 && "getBits returns at most 32 bits");
+        return static_cast<integer>(get().generator() >> (64 - n));
     }
 
     static std::pair<int, int> getDistinctIntCouple(int min, int max) {
         assert(min < max && "min must be less than max for getDistinctIntCouple");
-        if (!initialized) Init();
-
-        std::uniform_int_distribution<int> d(min, max);
-        int x1 = d(generator);
-        int x2 = 0;
 
-        do {
-            x2 = d(generator);
-        } while (x2 == x1);
+        // on tire x2 parmi les max-min valeurs différentes de x1 : aucune boucle de rejet
+        int x1 = getInt(min, max);
+        int x2 = getInt(min, max - 1);
+        if (x2 >= x1) x2++;
 
         return {x1, x2};
     }
 
     template <typename T, size_t size>
     static void shuffle(std::array<T, size>& arr) {
-        if (!initialized) Init();
-        std::shuffle(arr.begin(), arr.end(), generator);
+        shuffle(arr.begin(), arr.end());
+    }
+
+    template <typename RandomIt>
+    static void shuffle(RandomIt first, RandomIt last) {
+        auto n = last - first;
+        for (decltype(n) i = n - 1; i > 0; i--) {
+            auto j = static_cast<decltype(n)>(bounded(uint64_t(i) + 1));
+            using std::swap;
+            swap(first[i], first[j]);
+        }
     }
-};
\ No newline at end of file
+
+
+
+    // ==================================================================================================================
+    // Remplissages en masse
+    // ==================================================================================================================
+
+    /**
+     * @brief Fills out[0..n) with unbiased integers in [min, max].
+     * @pre max - min < 2^32
+     */
+    static void fillInts(int* out, size_t n, int min, int max);
+
+    /**
+     * @brief Fills out[0..n) with reals in [0, 1).
+     */
+    static void fillProbs(real* out, size_t n);
+
+    /**
+     * @brief Fills out[0..n) with independent standard normal draws (mean 0, variance 1).
+     */
+    static void fillNormals(real* out, size_t n);
+
+    /**
+     * @brief Fills out[0..n) with values whose @p nbits low bits are random (nbits <= 32),
+     *        e.g. genes of Nb_bin bits.
+     */
+    static void fillBits(integer* out, size_t n, int nbits);
+
+    /**
+     * @brief Fills out[0..n) with raw random 64-bit words (bit masks).
+     */
+    static void fillWords(uint64_t* out, size_t n);
+};
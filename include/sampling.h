@@ -0,0 +1,59 @@
+#pragma once
+/**
+ * @file sampling.h
+ * @brief Designs of initial points in the unit hypercube [0, 1)^dims.
+ *
+ * A UnitDesign places `count` points; point i, coordinate k is computed on
+ * its own by coordinate(i, k), so the workers of populate() each fill their
+ * slice of the population without any shared state:
+ *   - Uniform: independent uniform draws;
+ *   - LatinHypercube: each coordinate is cut into `count` strata of equal
+ *     width, and every stratum holds exactly one point. The stratum of point
+ *     i on coordinate k is perm_k(i), a random permutation of [0, count)
+ *     evaluated on the fly (a keyed Feistel network walked until it falls
+ *     back into range), so no permutation is ever stored;
+ *   - Halton: the radical inverse of i + 1 in the k-th prime base, shifted by
+ *     a random amount modulo 1 (Cranley-Patterson rotation). A low-discrepancy
+ *     sequence covers the domain more evenly than random points.
+ *
+ * The keys and shifts are drawn on the calling thread by the constructor;
+ * the uniform draws and the position of a point inside its stratum come from
+ * the Randomizer of the thread calling coordinate().
+ */
+
+#include "settings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+
+/// The label of an initialization ("uniform", "lhs", "halton").
+const char* to_string(Initialization s);
+
+
+class UnitDesign {
+private:
+    Initialization m_strategy;
+    size_t m_count;
+    unsigned m_half_bits = 0;           // LHS : la moitié des bits du réseau de Feistel
+    std::vector<uint64_t> m_keys;       // LHS : la clé de la permutation de chaque coordonnée
+    std::vector<uint32_t> m_bases;      // Halton : le nombre premier de chaque coordonnée
+    std::vector<real> m_shifts;         // Halton : le décalage de chaque coordonnée
+
+    size_t permute(size_t i, uint64_t key) const;
+
+public:
+    /**
+     * @param strategy How the points are spread.
+     * @param count The number of points.
+     * @param dims The number of coordinates of a point.
+     */
+    UnitDesign(Initialization strategy, size_t count, size_t dims);
+
+    /**
+     * @brief Coordinate @p k of point @p i, in [0, 1).
+     */
+    real coordinate(size_t i, size_t k) const;
+};
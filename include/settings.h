@@ -9,6 +9,7 @@
 */
 
 #include <cstdint>
+#include <cstddef>
 
 
 
@@ -20,7 +21,7 @@ constexpr real min_real     = -1000;
 constexpr real max_real     =  1000;                                                                //? la valeur maximale que peut prendre un réel
 constexpr real real_size    = max_real - min_real;                                                  //! la taille de l'intervalle de représentation des réels
 
-constexpr int Nb_bin    = 32;                                                                       //? le nombre de bits sur lequel est codé un gène
+constexpr int Nb_bin    = 32;                                                                       //? le nombre de bits sur lequel est codé un gène (1 à 32). Les gènes sont compactés sur exactement Nb_bin bits
 constexpr size_t bin_max  = (1ULL << Nb_bin) - 1;                                                   //! la valeur maximale que peut prendre un gène
 
 using integer = uint32_t;                                                                           //? le type représentant un entier NATUREL
@@ -37,6 +38,69 @@ constexpr size_t Dimension          = 3;
 
 constexpr size_t maxGen = 1000;                                                                     //? la dernière génération d'enfants
 
+enum class Initialization { Uniform, LatinHypercube, Halton };                                      //! Uniform : gènes tirés au hasard, LatinHypercube : chaque coordonnée couvre ses N strates une fois chacune, Halton : suite à faible discrépance décalée au hasard
+constexpr Initialization initialization = Initialization::Uniform;                                  //? la répartition des agents de la génération 0 (et des points initiaux de DE) dans le domaine
+
+constexpr size_t NumberOfObjectives = 1;                                                            //? le nombre d'objectifs : 1 = fonction fitness, plus de 1 = mode multi-objectif (NSGA-II) sur fitness_objectives
+constexpr bool UseFitnessExpression = false;                                                        //? true = la fitness est fitness_expression (objective.h), évaluée par blocs d'agents vectorisés, au lieu de fitness
+constexpr bool UseDeltaFitness = false;                                                             //? true = la fitness est fitness_from_sum de la somme des fitness_contribution (genetic.cpp) : un agent est évalué à partir de son parent, sur ses seules coordonnées modifiées
+constexpr size_t DeltaRefreshInterval = 64;                                                         //? avec UseDeltaFitness, toutes les DeltaRefreshInterval générations, les sommes sont recalculées en entier (arrondis accumulés)
+
+constexpr bool FusedGeneration = false;                                                             //? true = la génération suivante est produite par tuiles de couples : croisement, mutation et évaluation de chaque tuile tant qu'elle est en cache (Parameters::fused_generation)
+constexpr size_t FusedTile = 16;                                                                    //? le nombre de couples d'une tuile du mode fusionné : 4*FusedTile agents, à garder dans le cache L1 avec leurs parents
+
+constexpr bool CachePhenotype = false;                                                              //? true = chaque agent garde aussi ses vecteurs décodés, tenus à jour à chaque écriture d'un gène : lectures sans décodage, mais 88 octets par agent au lieu de 36 (2 vecteurs de dimension 3, double) ; false = gènes compactés seuls, décodés à la demande
+
+enum class OperatorPolicy { Fixed, Ucb, AdaptivePursuit };                                          //! Fixed : croisement en un point et mutation par inversion de bit seulement, Ucb et AdaptivePursuit : un bandit manchot répartit les enfants entre les opérateurs selon l'amélioration de fitness qu'ils apportent
+constexpr OperatorPolicy operator_policy = OperatorPolicy::Fixed;                                   //? le choix des opérateurs de croisement (un point, deux points, uniforme) et de mutation (inversion de bit, creep) de chaque enfant
+constexpr size_t CreepStep           = bin_max / 256 > 0 ? bin_max / 256 : 1;                       //? le plus grand déplacement d'un gène par la mutation creep (ici 1/256 de son intervalle)
+constexpr real OperatorLearningRate  = real(0.3);                                                   //? le poids de la dernière génération dans la qualité estimée d'un opérateur (et l'oubli de ses tirages passés avec Ucb)
+constexpr real OperatorPursuitRate   = real(0.3);                                                   //? AdaptivePursuit : la vitesse à laquelle les parts se rapprochent de celles qui favorisent le meilleur opérateur
+constexpr real OperatorMinShare      = real(0.05);                                                  //? AdaptivePursuit : la part minimale des enfants confiée à chaque opérateur
+constexpr real OperatorExploration   = real(0.5);                                                   //? Ucb : le poids du bonus d'exploration des opérateurs peu essayés
+
+constexpr size_t MemeticElite       = 0;                                                            //? le nombre d'agents d'élite affinés par recherche locale à chaque génération (0 = pas de mode mémétique)
+constexpr size_t MemeticBudget      = 64;                                                           //? le nombre d'évaluations de la recherche locale, par agent d'élite et par génération
+
+enum class PopulationPolicy { Fixed, Linear, Diversity };                                           //! Fixed : taille constante, Linear : réduction linéaire jusqu'à MinHalfPopulationSize à la dernière génération, Diversity : taille proportionnelle à la diversité de la population
+constexpr PopulationPolicy population_policy = PopulationPolicy::Fixed;                             //? la façon dont la taille de la population évolue au cours du run
+constexpr size_t MinHalfPopulationSize       = 100;                                                 //? la plus petite moitié de population qu'une politique adaptative peut atteindre
+
+constexpr size_t DiversitySample    = 256;                                                          //? le nombre d'agents examinés pour mesurer la diversité d'une génération (0 = tous)
+constexpr real MinHammingRatio      = 0;                                                            //? on arrête le run quand la distance de Hamming moyenne tombe sous cette part des bits d'un agent (0 = jamais)
+constexpr real TimeLimit            = 0;                                                            //? la durée maximale d'un run en secondes, depuis init() (0 = pas d'échéance)
+constexpr size_t MaxEvaluations     = 0;                                                            //? le nombre maximal d'évaluations de la fonction fitness par run (0 = pas de limite)
+
+enum class Algorithm { Genetic, DifferentialEvolution, CmaEs, MapElites };                          //! Genetic : l'AG sur les gènes compactés, DifferentialEvolution (DE/rand/1/bin) et CmaEs : directement sur les coordonnées réelles du domaine, MapElites : une archive des meilleurs agents de chaque case d'une grille de comportements
+constexpr Algorithm algorithm         = Algorithm::Genetic;                                         //? l'algorithme d'optimisation (GENETIC_ALGORITHM=genetic|de|cmaes|map-elites le change à l'exécution)
+constexpr size_t ContinuousPopulation = 0;                                                          //? la population de DE et de CMA-ES (0 = leur valeur recommandée : 10n pour DE, 4 + 3 ln n pour CMA-ES, n le nombre de coordonnées)
+constexpr real DeWeight               = real(0.5);                                                  //? le facteur F de l'évolution différentielle, appliqué à la différence de deux agents
+constexpr real DeCrossover            = real(0.9);                                                  //? la probabilité CR qu'une coordonnée de l'essai vienne du vecteur muté plutôt que de l'agent
+constexpr size_t CmaEigenInterval     = 0;                                                          //? le nombre de générations de CMA-ES entre deux décompositions de la covariance (0 = automatique)
+
+constexpr size_t DescriptorDims        = 2;                                                         //? le nombre de caractéristiques de comportement de MAP-Elites (descriptor, genetic.cpp)
+constexpr size_t MapElitesCells        = 32;                                                        //? le nombre de cases de la grille de MAP-Elites sur chaque caractéristique
+constexpr size_t MapElitesDenseCells   = size_t(1) << 20;                                           //? au-delà de ce nombre de cases, l'archive de MAP-Elites est une table de hachage des seules cases occupées
+constexpr size_t MapElitesHashCapacity = size_t(1) << 16;                                           //? le nombre maximal de cases occupées d'une archive hachée (une puissance de 2)
+
+constexpr real SurrogateKeep         = 1;                                                           //? la part des enfants envoyée à la vraie fonction fitness, les plus prometteurs selon le substitut (1 = pas de substitut)
+constexpr real SurrogateExploration  = real(0.05);                                                  //? la part de la population évaluée en plus, tirée au hasard parmi les enfants écartés par le substitut
+constexpr size_t SurrogateNeighbours = 8;                                                           //? le nombre de voisins d'une prédiction du substitut (1 à 32)
+constexpr real SurrogateEpsilon      = real(0.25);                                                  //? la tolérance de la recherche des voisins : chacun est au plus (1 + SurrogateEpsilon) fois plus loin que le vrai voisin de même rang (0 = recherche exacte, plus lente loin des amas)
+constexpr size_t SurrogateArchive    = 1 << 16;                                                     //? le nombre maximal d'agents évalués conservés par le substitut
+
+
+//======= Paramètres du parallélisme =======//
+
+enum class AffinityPolicy { None, Compact, Scatter };                                               //! None : pas d'épinglage, Compact : on remplit un noeud NUMA avant de passer au suivant, Scatter : on alterne les noeuds
+enum class HugePages { None, Transparent, Explicit };                                               //! Transparent : madvise(MADV_HUGEPAGE), Explicit : mmap(MAP_HUGETLB), avec repli sur les pages transparentes
+
+constexpr size_t NumberOfThreads                = 0;                                                //? le nombre de threads de calcul (0 = un par coeur disponible)
+constexpr AffinityPolicy affinity_policy        = AffinityPolicy::Compact;                          //? la façon dont les threads sont épinglés sur les coeurs
+constexpr HugePages huge_pages                  = HugePages::Transparent;                           //? le type de pages utilisées pour stocker la population
+constexpr const char* PopulationStorage        = "";                                               //? le dossier des fichiers projetés qui portent les populations trop grandes pour la mémoire ("" = en mémoire)
+constexpr size_t StorageTile                   = size_t(1) << 16;                                  //? le nombre d'agents d'une tuile d'une population sur disque : les tournois et les couples restent dans une tuile
+
 
 //======= Paramètres de sauvegarde dans des fichiers =======//
 
@@ -0,0 +1,30 @@
+#pragma once
+/**
+ * @file stop.h
+ * @brief Process-wide stop request, raised by SIGINT / SIGTERM.
+ *
+ * Every GeneticEngine polls stop_requested() between the stages of a
+ * generation and every 16 evaluations inside its evaluation batches (the
+ * rounds of the memetic local search included). Once
+ * the request is raised, the running engines stop cleanly: they keep their
+ * best-so-far agent (GeneticEngine::bestSoFar) and report
+ * StopReason::Signal.
+ *
+ * The handlers only store to a lock-free atomic, which is async-signal-safe.
+ * After the first signal they are reset to the default action, so a second
+ * Ctrl-C kills a process that does not stop fast enough.
+ */
+
+
+
+/// Installs the SIGINT and SIGTERM handlers raising the stop request.
+void install_stop_handlers();
+
+/// Raises the stop request (async-signal-safe: a host may call it from its own handler).
+void request_stop() noexcept;
+
+/// true once the stop request has been raised.
+bool stop_requested() noexcept;
+
+/// Lowers the stop request, before starting new runs in the same process.
+void clear_stop_request() noexcept;
@@ -0,0 +1,131 @@
+#pragma once
+/**
+ * @file surrogate.h
+ * @brief Nearest-neighbour surrogate of the fitness, used to pre-screen offspring.
+ *
+ * The surrogate archives the phenotype (decoded coordinates, in the canonical
+ * interval) and the fitness of every agent that went through a real
+ * evaluation, and predicts the fitness of a new agent by inverse distance
+ * weighting (IDW) of its SurrogateNeighbours nearest archived neighbours:
+ *
+ *     f(x) = sum_i w_i f_i / sum_i w_i,   w_i = 1 / |x - x_i|²
+ *
+ * (an archived point at distance 0 gives its own fitness).
+ *
+ * Index: the archived points are split at the median of their widest
+ * coordinate, recursively, down to leaves of a few points. Below 12
+ * coordinates each node prunes with its splitting plane (k-d tree); above,
+ * where planes prune little, each node keeps the bounding ball of its points
+ * instead (ball tree). Both searches are (1 + e)-approximate, with
+ * e = SurrogateEpsilon (settings.h, 0.25 by default): a subtree is skipped
+ * unless it may hold a point (1 + e) times closer than the worst neighbour
+ * kept so far. The i-th neighbour returned is therefore at most (1 + e) times
+ * farther than the true i-th nearest archived point. Far from a cluster, all
+ * its points are at nearly the same distance, so the approximation saves most
+ * of the visits and barely moves the IDW weights. SurrogateEpsilon = 0 gives
+ * the exact search.
+ *
+ * Incremental rebuild: the archive is indexed by a main tree and by a small
+ * tree over the points added since the main tree was built. commit() rebuilds
+ * the small tree, and rebuilds the main tree over the whole archive once the
+ * small one exceeds an eighth of it, so indexing costs O(log N) per insertion
+ * amortized. The archive keeps the @p capacity most recent points, the
+ * oldest being dropped when the main tree is rebuilt.
+ *
+ * Threading: add() and commit() must not run concurrently with anything
+ * else; predict() is read-only and may run from any number of threads.
+ */
+
+#include "genetic.h"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+
+
+class Surrogate {
+public:
+    static constexpr size_t dims = NumberOfVectors * Dimension;    // nombre de coordonnées d'un phénotype
+    using Point = std::array<real, dims>;
+
+private:
+    struct Node {
+        size_t begin = 0, end = 0;      // les points [begin, end) de m_sorted
+        size_t left = 0, right = 0;     // les enfants (0 = feuille : la racine n'est l'enfant de personne)
+        size_t axis = 0;                // la coordonnée de coupe
+        real split = 0;                 // la valeur de coupe
+    };
+
+    struct Ball {
+        Point center {};                // le centre des points du noeud
+        real radius = 0;                // la distance du centre au point le plus éloigné
+    };
+
+    size_t m_capacity;
+    size_t m_neighbours;
+
+    struct Tree {
+        std::vector<Point> points;      // les points indexés, dans l'ordre des feuilles : une feuille est contiguë
+        std::vector<real>  values;
+        std::vector<Node>  nodes;       // nodes[0] est la racine (vide si aucun point)
+        std::vector<Ball>  balls;       // la boule englobante de chaque noeud (arbre à boules uniquement)
+    };
+
+    std::vector<Point> m_points;        // l'archive, du plus ancien au plus récent
+    std::vector<real>  m_values;
+
+    Tree m_main;                        // les points [0, m_indexed) de l'archive
+    Tree m_recent;                      // les points [m_indexed, m_recent_end)
+    size_t m_indexed = 0;
+    size_t m_recent_end = 0;            // les points suivants, pas encore indexés, sont parcourus un à un
+
+    struct Nearest;
+
+    // indexe dans tree les points [first, last) de l'archive
+    void index(Tree& tree, size_t first, size_t last);
+
+    // construit le sous-arbre des points order[begin, end) et renvoie l'indice de sa racine
+    size_t build(Tree& tree, std::vector<size_t>& order, size_t begin, size_t end);
+
+    // ajoute à best les plus proches voisins de x dans le sous-arbre du noeud node
+    static void search(const Tree& tree, size_t node, const real* x, Nearest& best);
+
+public:
+    /**
+     * @param capacity Maximum number of archived points.
+     * @param neighbours Number of neighbours of a prediction (1 to 32).
+     */
+    explicit Surrogate(size_t capacity = SurrogateArchive, size_t neighbours = SurrogateNeighbours);
+
+    /** Empties the archive. */
+    void clear();
+
+    /** Archives the phenotype of @p a with its real fitness (scanned linearly until the next commit). */
+    void add(const Agent& a, real fitness);
+
+    /** Indexes the points added since the last commit. */
+    void commit();
+
+    /** Number of archived points. */
+    size_t size() const { return m_points.size(); }
+
+    /** Bytes reserved by the archive and its trees. */
+    size_t memory() const;
+
+    /** Number of neighbours of a prediction. */
+    size_t neighbours() const { return m_neighbours; }
+
+    /**
+     * @brief The predicted fitness of @p a.
+     * @pre size() > 0
+     */
+    real predict(const Agent& a) const;
+
+    /**
+     * @brief The predicted fitness of the phenotype @p x (dims coordinates in the canonical interval).
+     * @pre size() > 0
+     */
+    real predict(std::span<const real> x) const;
+};
@@ -0,0 +1,152 @@
+#pragma once
+/**
+ * @file sweep.h
+ * @brief Parameter-sweep runner: many independent runs in one process.
+ *
+ * A sweep specification is a text file of "key = value" lines ('#' starts a
+ * comment). General keys:
+ *
+ *   mode    = grid | random     cartesian product of the axes, or random samples
+ *   samples = 200               number of random samples (random mode)
+ *   repeats = 3                 runs per configuration, each with its own seed
+ *   seed    = 42                master seed; run i gets deriveSeed(seed, i)
+ *   output  = ./data/sweep.csv  summary file (one row per run)
+ *   targets = -1, -0.001        fitness levels: for each, the evaluations and
+ *                               seconds a run took to reach it (best >= level)
+ *
+ * Axis keys: half_population_size, max_gen, initial_mutation_proba, min_real,
+ * max_real, memetic_elite, memetic_budget, population_policy (0 = Fixed,
+ * 1 = Linear, 2 = Diversity), min_half_population_size, min_hamming_ratio,
+ * surrogate_keep, surrogate_exploration, time_limit, max_evaluations,
+ * algorithm (0 = genetic, 1 = de, 2 = cmaes, 3 = map-elites; see make_optimizer),
+ * initialization (0 = uniform, 1 = Latin hypercube, 2 = Halton; see sampling.h),
+ * benchmark (0 = none, 1 = sphere ... 6 = griewank, in the order of
+ * benchmarks.h; also sets the standard interval, which a min_real or max_real
+ * axis given after it overrides), benchmark_dims, fused_generation (0 or 1),
+ * map_cells, operator_policy (0 = Fixed, 1 = Ucb, 2 = AdaptivePursuit; see operators.h).
+ * An axis value is either a list "a, b, c" or a range:
+ *   - "lo:hi:step" is expanded into a list (both modes);
+ *   - "lo:hi" is sampled uniformly (random mode only).
+ * An axis that is not given keeps its Parameters default. Combinations that
+ * fail Parameters::validate (e.g. min_real >= max_real) are skipped;
+ * integer parameters are rounded to the nearest integer.
+ *
+ * Example:
+ * @code
+ * mode = grid
+ * repeats = 4
+ * half_population_size = 250, 500, 1000
+ * max_gen = 100:500:100
+ * initial_mutation_proba = 0.5, 0.9
+ * @endcode
+ *
+ * Runs are scheduled largest-first (population size × generations) on a
+ * shared ThreadPool; each run executes serially on the worker that picked it.
+ *
+ * The best fitness of a run is its best-so-far point (Optimizer::bestSolution),
+ * so that runs stopped by a deadline or a budget, and runs of different
+ * algorithms, are compared fairly; the "stop" column tells why each run ended.
+ *
+ * With targets, a run is stepped one generation at a time and its best-so-far
+ * point is checked after each one: a target is timed at the end of the
+ * generation that reached it. The columns evaluations_to_<level> and
+ * seconds_to_<level> stay empty when the level was never reached.
+ */
+
+#include "engine.h"
+#include "parameters.h"
+#include "parallel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+
+/**
+ * @struct SweepAxis
+ * @brief The values one parameter takes in a sweep.
+ */
+struct SweepAxis {
+    std::vector<double> values;     // liste explicite (vide si intervalle)
+    double lo = 0, hi = 0;          // intervalle tiré uniformément (mode random)
+
+    bool isRange() const { return values.empty(); }
+};
+
+
+/**
+ * @struct SweepSpec
+ * @brief A parsed sweep specification.
+ */
+struct SweepSpec {
+    enum class Mode { Grid, Random };
+
+    Mode mode = Mode::Grid;
+    size_t samples = 100;
+    size_t repeats = 1;
+    uint64_t seed = 1;
+    std::string output = std::string(directory) + "/sweep.csv";
+    std::vector<real> targets;      // niveaux de fitness à chronométrer
+
+    std::vector<std::pair<std::string, SweepAxis>> axes; // dans l'ordre du fichier
+
+    /**
+     * @brief Parses a specification.
+     * @throw std::runtime_error on an unknown key or a malformed value (with its line number).
+     */
+    static SweepSpec parse(std::istream& in);
+
+    /**
+     * @brief Expands the specification into the list of runs, seeds included.
+     * @param[out] skipped If not null, receives the number of invalid combinations dropped.
+     */
+    std::vector<Parameters> expand(size_t* skipped = nullptr) const;
+};
+
+
+/**
+ * @struct RunSummary
+ * @brief The outcome of one run of a sweep.
+ */
+struct RunSummary {
+    size_t run = 0;
+    Parameters params;
+    real best_fitness = 0;
+    size_t generations = 0;
+    size_t evaluations = 0;
+    double seconds = 0;
+    StopReason stop = StopReason::Running;  // pourquoi le run s'est arrêté
+    std::vector<size_t> evaluations_to;     // par cible : les évaluations pour l'atteindre (0 si jamais atteinte)
+    std::vector<double> seconds_to;         // par cible : les secondes pour l'atteindre
+};
+
+
+/**
+ * @brief Runs every configuration on @p pool and writes one CSV row per run to @p csv.
+ *
+ * Rows are written (and flushed) as runs complete, so a partial sweep still
+ * leaves a usable file. @p progress, if not null, receives one line per
+ * finished run. @p targets are the fitness levels to time (SweepSpec::targets).
+ *
+ * @return The summaries, in run order.
+ */
+std::vector<RunSummary> run_sweep(const std::vector<Parameters>& runs, ThreadPool& pool,
+                                  std::ostream& csv, std::ostream* progress = nullptr,
+                                  const std::vector<real>& targets = {});
+
+
+/**
+ * @brief Runs a whole specification: the body of genetic_sweep and genetic_bench.
+ *
+ * Expands @p spec (the number of runs and of skipped combinations goes to
+ * @p progress), creates the folder of spec.output and the CSV file, installs
+ * the SIGINT / SIGTERM handlers (stop.h) so that Ctrl-C keeps one row per
+ * finished run, then calls run_sweep on ThreadPool::global().
+ *
+ * @throw std::runtime_error if spec.output cannot be written.
+ * @return The summaries, in run order.
+ */
+std::vector<RunSummary> run_sweep_spec(const SweepSpec& spec, std::ostream& progress);
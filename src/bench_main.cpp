@@ -0,0 +1,61 @@
+/*
+    Banc d'essai : les fonctions de test standard (benchmarks.h) contre chaque moteur, à graines fixes.
+
+    Utilisation :
+        genetic_bench [spécification] [sortie.csv]       lance la suite (par défaut default_benchmark_suite)
+        genetic_bench --compare <base.csv> <nouveau.csv>  compare deux fichiers de résultats de la même suite
+        genetic_bench --print-suite                       affiche la suite par défaut, point de départ d'une variante
+
+    La spécification suit le format de sweep.h ; la clé "targets" donne les niveaux de fitness chronométrés.
+    Deux fichiers produits avant et après une modification se comparent avec --compare.
+*/
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "benchmarks.h"
+#include "sweep.h"
+
+
+int main(int argc, char** argv) {
+    try {
+        const std::string first = argc > 1 ? argv[1] : "";
+
+        if (first == "--print-suite") {
+            std::cout << default_benchmark_suite;
+            return 0;
+        }
+
+        if (first == "--compare") {
+            if (argc < 4) {
+                std::cerr << "utilisation : " << argv[0] << " --compare <base.csv> <nouveau.csv>\n";
+                return 1;
+            }
+            std::ifstream base(argv[2]), next(argv[3]);
+            if (!base.is_open()) throw std::runtime_error(std::string("impossible d'ouvrir ") + argv[2]);
+            if (!next.is_open()) throw std::runtime_error(std::string("impossible d'ouvrir ") + argv[3]);
+            compare_runs(base, next, std::cout);
+            return 0;
+        }
+
+        SweepSpec spec;
+        if (first.empty()) {
+            std::istringstream suite(default_benchmark_suite);
+            spec = SweepSpec::parse(suite);
+        } else {
+            std::ifstream spec_file(first);
+            if (!spec_file.is_open()) throw std::runtime_error("impossible d'ouvrir " + first);
+            spec = SweepSpec::parse(spec_file);
+        }
+        if (argc > 2) spec.output = argv[2];
+
+        run_sweep_spec(spec, std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "erreur : " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numbers>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+
+
+
+// ==================================================================================================================
+// Fonctions de test
+// ==================================================================================================================
+
+const char* to_string(Benchmark b) {
+    switch (b) {
+        case Benchmark::Sphere:     return "sphere";
+        case Benchmark::Rastrigin:  return "rastrigin";
+        case Benchmark::Rosenbrock: return "rosenbrock";
+        case Benchmark::Ackley:     return "ackley";
+        case Benchmark::Schwefel:   return "schwefel";
+        case Benchmark::Griewank:   return "griewank";
+        default:                    return "none";
+    }
+}
+
+Benchmark parse_benchmark(const std::string& name) {
+    for (size_t b = 0; b < BenchmarkCount; b++) {
+        if (name == to_string(Benchmark(b))) return Benchmark(b);
+    }
+    throw std::invalid_argument("fonction de test inconnue : " + name
+                                + " (sphere, rastrigin, rosenbrock, ackley, schwefel ou griewank)");
+}
+
+void benchmark_interval(Benchmark b, real& min, real& max) {
+    switch (b) {
+        case Benchmark::Sphere:
+        case Benchmark::Rastrigin:  min = real(-5.12);   max = real(5.12);   return;
+        case Benchmark::Rosenbrock: min = -5;            max = 10;           return;
+        case Benchmark::Ackley:     min = real(-32.768); max = real(32.768); return;
+        case Benchmark::Schwefel:   min = -500;          max = 500;          return;
+        case Benchmark::Griewank:   min = -600;          max = 600;          return;
+        default:                    min = min_real;      max = max_real;     return;
+    }
+}
+
+real evaluate_benchmark(Benchmark b, const real* x, size_t n) {
+    constexpr real two_pi = 2 * std::numbers::pi_v<real>;
+    real f = 0;
+    switch (b) {
+        case Benchmark::Sphere:
+            for (size_t i = 0; i < n; i++) f += x[i] * x[i];
+            break;
+        case Benchmark::Rastrigin:
+            f = 10 * real(n);
+            for (size_t i = 0; i < n; i++) f += x[i] * x[i] - 10 * std::cos(two_pi * x[i]);
+            break;
+        case Benchmark::Rosenbrock:
+            for (size_t i = 0; i + 1 < n; i++) {
+                const real a = x[i + 1] - x[i] * x[i], c = 1 - x[i];
+                f += 100 * a * a + c * c;
+            }
+            break;
+        case Benchmark::Ackley: {
+            real squares = 0, cosines = 0;
+            for (size_t i = 0; i < n; i++) {
+                squares += x[i] * x[i];
+                cosines += std::cos(two_pi * x[i]);
+            }
+            f = 20 + std::numbers::e_v<real> - 20 * std::exp(real(-0.2) * std::sqrt(squares / real(n)))
+              - std::exp(cosines / real(n));
+            break;
+        }
+        case Benchmark::Schwefel:
+            f = real(418.9828872724339) * real(n);
+            for (size_t i = 0; i < n; i++) f -= x[i] * std::sin(std::sqrt(std::fabs(x[i])));
+            break;
+        case Benchmark::Griewank: {
+            real product = 1;
+            for (size_t i = 0; i < n; i++) {
+                f += x[i] * x[i] / 4000;
+                product *= std::cos(x[i] / std::sqrt(real(i + 1)));
+            }
+            f += 1 - product;
+            break;
+        }
+        default:
+            break;
+    }
+    return -f;
+}
+
+
+
+
+// ==================================================================================================================
+// Suite et comparaison
+// ==================================================================================================================
+
+const char* const default_benchmark_suite =
+    "# chaque fonction de test contre chaque moteur, au même budget d'évaluations\n"
+    "mode = grid\n"
+    "repeats = 5\n"
+    "seed = 1\n"
+    "half_population_size = 100\n"
+    "max_gen = 1000000\n"
+    "max_evaluations = 100000\n"
+    "benchmark = 1, 2, 3, 4, 5, 6\n"
+    "algorithm = 0, 1, 2\n"
+    "targets = -1, -0.01, -0.0001, -0.000001\n"
+    "output = " directory "/bench.csv\n";
+
+namespace {
+
+struct ResultFile {
+    std::vector<std::string> columns;
+    std::vector<std::vector<std::string>> rows;
+
+    size_t column(const std::string& name) const {
+        auto it = std::find(columns.begin(), columns.end(), name);
+        if (it == columns.end()) throw std::runtime_error("colonne absente : " + name);
+        return size_t(it - columns.begin());
+    }
+};
+
+std::vector<std::string> split(const std::string& line) {
+    std::vector<std::string> res;
+    std::stringstream ss(line);
+    std::string item;
+    while (std::getline(ss, item, ',')) res.push_back(item);
+    if (!line.empty() && line.back() == ',') res.emplace_back();
+    return res;
+}
+
+ResultFile read_results(std::istream& in) {
+    ResultFile f;
+    std::string line;
+    if (!std::getline(in, line)) throw std::runtime_error("fichier de résultats vide");
+    f.columns = split(line);
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        f.rows.push_back(split(line));
+        f.rows.back().resize(f.columns.size());
+    }
+    return f;
+}
+
+bool is_result_column(const std::string& name) {
+    static const char* const results[] = { "run", "seed", "best_fitness", "generations", "evaluations", "seconds", "stop" };
+    if (std::find(std::begin(results), std::end(results), name) != std::end(results)) return true;
+    return name.starts_with("evaluations_to_") || name.starts_with("seconds_to_");
+}
+
+// la médiane des cellules non vides (NaN si aucune)
+double median(std::vector<double> v) {
+    if (v.empty()) return std::nan("");
+    std::sort(v.begin(), v.end());
+    const size_t m = v.size() / 2;
+    return v.size() % 2 ? v[m] : (v[m - 1] + v[m]) / 2;
+}
+
+struct Group {
+    std::vector<double> best;
+    std::vector<std::vector<double>> evaluations, seconds; // par cible, les runs qui l'ont atteinte
+    size_t runs = 0;
+};
+
+using Groups = std::map<std::string, Group>;
+
+Groups group(const ResultFile& f, const std::vector<std::string>& key, const std::vector<std::string>& targets) {
+    Groups res;
+    std::vector<size_t> key_columns;
+    for (const std::string& k : key) key_columns.push_back(f.column(k));
+    const size_t best = f.column("best_fitness");
+
+    for (const auto& row : f.rows) {
+        std::string label;
+        for (size_t c : key_columns) label += row[c] + ' ';
+        Group& g = res[label];
+        g.evaluations.resize(targets.size());
+        g.seconds.resize(targets.size());
+        g.runs++;
+        if (!row[best].empty()) g.best.push_back(std::stod(row[best]));
+        for (size_t t = 0; t < targets.size(); t++) {
+            const std::string& e = row[f.column("evaluations_to_" + targets[t])];
+            const std::string& s = row[f.column("seconds_to_" + targets[t])];
+            if (e.empty()) continue;
+            g.evaluations[t].push_back(std::stod(e));
+            g.seconds[t].push_back(std::stod(s));
+        }
+    }
+    return res;
+}
+
+// une médiane absente (aucun run n'a atteint la cible) s'affiche '-'
+std::string number(double v) {
+    if (std::isnan(v)) return "-";
+    std::ostringstream ss;
+    ss << std::setprecision(4) << v;
+    return ss.str();
+}
+
+std::string ratio(double next, double base) {
+    if (!(base > 0) || std::isnan(next)) return "";
+    std::ostringstream ss;
+    ss << " (x" << std::fixed << std::setprecision(2) << next / base << ')';
+    return ss.str();
+}
+
+} // namespace
+
+void compare_runs(std::istream& base_in, std::istream& next_in, std::ostream& out) {
+    const ResultFile base = read_results(base_in), next = read_results(next_in);
+
+    // la configuration : toutes les colonnes de paramètres ; seules celles qui varient servent d'étiquette
+    std::vector<std::string> key, targets;
+    for (const std::string& c : base.columns) {
+        if (c.starts_with("evaluations_to_")) targets.push_back(c.substr(std::string("evaluations_to_").size()));
+        if (is_result_column(c)) continue;
+        const size_t i = base.column(c);
+        bool varies = false;
+        for (const auto& row : base.rows) varies = varies || row[i] != base.rows.front()[i];
+        if (varies) key.push_back(c);
+    }
+    for (const std::string& c : key) next.column(c); // le même plan des deux côtés
+
+    const Groups a = group(base, key, targets), b = group(next, key, targets);
+
+    for (const std::string& k : key) out << k << ' ';
+    out << "\n\n";
+    for (const auto& [label, g] : a) {
+        auto it = b.find(label);
+        if (it == b.end()) continue;
+        const Group& h = it->second;
+
+        out << label << '\n'
+            << "  meilleure fitness (médiane)  " << number(median(g.best)) << "  ->  " << number(median(h.best)) << '\n';
+        for (size_t t = 0; t < targets.size(); t++) {
+            const double ea = median(g.evaluations[t]), eb = median(h.evaluations[t]);
+            const double sa = median(g.seconds[t]), sb = median(h.seconds[t]);
+            out << "  cible " << std::setw(10) << std::left << targets[t] << std::right
+                << "  atteinte " << g.evaluations[t].size() << '/' << g.runs << " -> " << h.evaluations[t].size() << '/' << h.runs
+                << "   évaluations " << number(ea) << " -> " << number(eb) << ratio(eb, ea)
+                << "   secondes " << number(sa) << " -> " << number(sb) << ratio(sb, sa) << '\n';
+        }
+        out << '\n';
+    }
+}
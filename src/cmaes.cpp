@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "cmaes.h"
+#include "randomizer.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t n = NumberOfVectors * Dimension;   // la dimension de l'espace de recherche
+
+real* coordinates(Agent::phenotype& p) { return &p[0][0]; }
+
+constexpr real max_condition = real(1e14);          // au-delà, la covariance n'est plus exploitable
+constexpr real min_step      = real(1e-12);         // en part de la largeur du domaine
+
+} // namespace
+
+
+
+CmaEs::CmaEs(const Parameters& params, ThreadPool* pool)
+    : Optimizer(params, pool)
+{
+    // réglages par défaut du tutoriel de Hansen
+    m_lambda = m_params.continuous_population ? m_params.continuous_population
+                                              : 4 + size_t(std::floor(3 * std::log(real(n))));
+    m_mu = m_lambda / 2;
+
+    m_weights.resize(m_mu);
+    for (size_t i = 0; i < m_mu; i++) m_weights[i] = std::log(real(m_mu) + real(0.5)) - std::log(real(i + 1));
+    const real total = std::accumulate(m_weights.begin(), m_weights.end(), real(0));
+    real squares = 0;
+    for (real& w : m_weights) {
+        w /= total;
+        squares += w * w;
+    }
+    m_mueff = 1 / squares;
+
+    const real N = real(n);
+    m_cc = (4 + m_mueff / N) / (N + 4 + 2 * m_mueff / N);
+    m_cs = (m_mueff + 2) / (N + m_mueff + 5);
+    m_c1 = 2 / ((N + real(1.3)) * (N + real(1.3)) + m_mueff);
+    m_cmu = std::min(1 - m_c1, 2 * (m_mueff - 2 + 1 / m_mueff) / ((N + 2) * (N + 2) + m_mueff));
+    m_damps = 1 + 2 * std::max(real(0), std::sqrt((m_mueff - 1) / (N + 1)) - 1) + m_cs;
+    m_chin = std::sqrt(N) * (1 - 1 / (4 * N) + 1 / (21 * N * N));
+
+    // la décomposition coûte O(n^3) : elle n'est refaite que lorsque C a assez changé
+    m_eigen_interval = CmaEigenInterval ? CmaEigenInterval
+                                        : std::max<size_t>(1, size_t(1 / (10 * N * (m_c1 + m_cmu))));
+}
+
+void CmaEs::init() {
+    beginRun();
+    m_best = Solution{};
+    m_converged = false;
+
+    const Domain& d = m_params.domain;
+    m_mean.resize(n);
+    Randomizer::fillProbs(m_mean.data(), n);
+    for (real& x : m_mean) x = d.min + x * (d.max - d.min);
+    m_sigma = real(0.3) * (d.max - d.min);
+
+    m_pc.assign(n, 0);
+    m_ps.assign(n, 0);
+    m_C.assign(n * n, 0);
+    m_B.assign(n * n, 0);
+    m_invsqrtC.assign(n * n, 0);
+    for (size_t i = 0; i < n; i++) m_C[i * n + i] = m_B[i * n + i] = m_invsqrtC[i * n + i] = 1;
+    m_D.assign(n, 1);
+    m_eigen_generation = 0;
+
+    m_z.resize(m_lambda * n);
+    m_y.resize(m_lambda * n);
+    m_points.assign(m_lambda, Agent::phenotype{});
+    m_values.assign(m_lambda, std::numeric_limits<real>::quiet_NaN());
+    m_order.resize(m_lambda);
+
+    publishMetrics(0, 0, 0);
+}
+
+void CmaEs::step(size_t count) {
+    using clock = std::chrono::steady_clock;
+    EngineMetrics& metrics = *m_metrics;
+
+    for (size_t k = 0; k < count && !finished(); k++) {
+        if (interrupted()) break;
+        const clock::time_point start = clock::now();
+        clock::time_point last = start;
+        auto lap = [&](Stage s) {
+            clock::time_point now = clock::now();
+            metrics.addStage(s, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+            last = now;
+        };
+
+        sample();
+        lap(Stage::Mutation);
+
+        const size_t evaluations = m_evaluations;
+        const size_t budget = std::min(m_lambda, evaluationsLeft());
+        const size_t done = evaluateVectors(std::span(m_points).first(budget), m_values.data());
+        m_evaluations += done;
+        for (size_t i = 0; i < budget; i++) {
+            const real f = m_values[i];
+            if (std::isnan(f) || (m_best.found && !(f > m_best.fitness))) continue;
+            m_best.found = true;
+            m_best.fitness = f;
+            m_best.generation = m_generation + 1;
+            m_best.vectors = m_points[i];
+        }
+
+        // une génération incomplète ne met pas à jour la distribution : ses points restent dans bestSolution()
+        if (done < m_lambda) {
+            interrupted();
+            publishMetrics(std::chrono::duration<double>(clock::now() - start).count(), m_evaluations - evaluations, done);
+            break;
+        }
+
+        // du meilleur au moins bon ; une fitness NaN passe en dernier
+        std::iota(m_order.begin(), m_order.end(), size_t(0));
+        std::sort(m_order.begin(), m_order.end(), [this](size_t a, size_t b) {
+            const real fa = m_values[a], fb = m_values[b];
+            if (std::isnan(fa) != std::isnan(fb)) return std::isnan(fb);
+            if (fa != fb && !std::isnan(fa)) return fa > fb;
+            return a < b;
+        });
+        lap(Stage::Selection);
+
+        update();
+        m_generation++;
+        if (m_generation - m_eigen_generation >= m_eigen_interval) decompose();
+        lap(Stage::Crossover);
+
+        const real max_d = *std::max_element(m_D.begin(), m_D.end());
+        const real min_d = *std::min_element(m_D.begin(), m_D.end());
+        if (!(m_sigma * max_d >= min_step * (m_params.domain.max - m_params.domain.min))
+            || !(max_d * max_d <= max_condition * min_d * min_d)) {
+            m_converged = true;
+        }
+
+        interrupted();
+        publishMetrics(std::chrono::duration<double>(clock::now() - start).count(), m_evaluations - evaluations, m_lambda);
+    }
+}
+
+void CmaEs::sample() {
+    const Domain& d = m_params.domain;
+    Randomizer::fillNormals(m_z.data(), m_z.size());
+
+    std::vector<real> dz (n);
+    for (size_t k = 0; k < m_lambda; k++) {
+        const real* z = &m_z[k * n];
+        real* y = &m_y[k * n];
+        real* x = coordinates(m_points[k]);
+
+        // y = B D z, x = m + sigma y
+        for (size_t j = 0; j < n; j++) dz[j] = m_D[j] * z[j];
+        for (size_t i = 0; i < n; i++) {
+            real s = 0;
+            for (size_t j = 0; j < n; j++) s += m_B[i * n + j] * dz[j];
+            x[i] = std::clamp(m_mean[i] + m_sigma * s, d.min, d.max);
+            y[i] = (x[i] - m_mean[i]) / m_sigma; // le pas réellement fait, une fois le point ramené dans le domaine
+        }
+    }
+}
+
+void CmaEs::update() {
+    // la nouvelle moyenne et le pas moyen yw = (m' - m) / sigma
+    std::vector<real> yw (n, 0);
+    for (size_t r = 0; r < m_mu; r++) {
+        const real* y = &m_y[m_order[r] * n];
+        for (size_t i = 0; i < n; i++) yw[i] += m_weights[r] * y[i];
+    }
+    for (size_t i = 0; i < n; i++) m_mean[i] += m_sigma * yw[i];
+
+    // chemins d'évolution
+    const real cs = std::sqrt(m_cs * (2 - m_cs) * m_mueff);
+    real norm_ps = 0;
+    for (size_t i = 0; i < n; i++) {
+        real s = 0;
+        for (size_t j = 0; j < n; j++) s += m_invsqrtC[i * n + j] * yw[j];
+        m_ps[i] = (1 - m_cs) * m_ps[i] + cs * s;
+        norm_ps += m_ps[i] * m_ps[i];
+    }
+    norm_ps = std::sqrt(norm_ps);
+
+    const real progress = norm_ps / std::sqrt(1 - std::pow(1 - m_cs, real(2 * (m_generation + 1)))) / m_chin;
+    const real hsig = (progress < real(1.4) + 2 / real(n + 1)) ? 1 : 0;
+    const real cc = hsig * std::sqrt(m_cc * (2 - m_cc) * m_mueff);
+    for (size_t i = 0; i < n; i++) m_pc[i] = (1 - m_cc) * m_pc[i] + cc * yw[i];
+
+    // covariance : mise à jour de rang un et de rang mu, sur le triangle supérieur puis recopiée
+    const real keep = 1 - m_c1 - m_cmu + (1 - hsig) * m_c1 * m_cc * (2 - m_cc);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i; j < n; j++) m_C[i * n + j] = keep * m_C[i * n + j] + m_c1 * m_pc[i] * m_pc[j];
+    }
+    for (size_t r = 0; r < m_mu; r++) {
+        const real* y = &m_y[m_order[r] * n];
+        const real w = m_cmu * m_weights[r];
+        for (size_t i = 0; i < n; i++) {
+            const real wy = w * y[i];
+            for (size_t j = i; j < n; j++) m_C[i * n + j] += wy * y[j];
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) m_C[i * n + j] = m_C[j * n + i];
+    }
+
+    m_sigma *= std::exp((m_cs / m_damps) * (norm_ps / m_chin - 1));
+}
+
+void CmaEs::decompose() {
+    // Jacobi cyclique : A = V^T C V tend vers diag(valeurs propres), V porte les vecteurs propres en colonnes
+    std::vector<real> A = m_C;
+    std::vector<real>& V = m_B;
+    std::fill(V.begin(), V.end(), real(0));
+    for (size_t i = 0; i < n; i++) V[i * n + i] = 1;
+
+    for (int sweep = 0; sweep < 64; sweep++) {
+        real off = 0, diag = 0;
+        for (size_t p = 0; p < n; p++) {
+            diag += A[p * n + p] * A[p * n + p];
+            for (size_t q = p + 1; q < n; q++) off += A[p * n + q] * A[p * n + q];
+        }
+        if (off <= std::numeric_limits<real>::epsilon() * std::numeric_limits<real>::epsilon() * diag) break;
+
+        for (size_t p = 0; p < n; p++) {
+            for (size_t q = p + 1; q < n; q++) {
+                const real apq = A[p * n + q];
+                if (apq == 0) continue;
+                const real theta = (A[q * n + q] - A[p * n + p]) / (2 * apq);
+                const real t = std::copysign(real(1), theta) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+                const real c = 1 / std::sqrt(t * t + 1), s = t * c;
+                for (size_t k = 0; k < n; k++) {
+                    const real akp = A[k * n + p], akq = A[k * n + q];
+                    A[k * n + p] = c * akp - s * akq;
+                    A[k * n + q] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < n; k++) {
+                    const real apk = A[p * n + k], aqk = A[q * n + k];
+                    A[p * n + k] = c * apk - s * aqk;
+                    A[q * n + k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < n; k++) {
+                    const real vkp = V[k * n + p], vkq = V[k * n + q];
+                    V[k * n + p] = c * vkp - s * vkq;
+                    V[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    // une valeur propre nulle ou négative (arrondis) est relevée : le critère de conditionnement arrêtera le run
+    real largest = 0;
+    for (size_t i = 0; i < n; i++) largest = std::max(largest, A[i * n + i]);
+    for (size_t i = 0; i < n; i++) m_D[i] = std::sqrt(std::max(A[i * n + i], largest * real(1e-20)));
+
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            real s = 0;
+            for (size_t k = 0; k < n; k++) s += V[i * n + k] * V[j * n + k] / m_D[k];
+            m_invsqrtC[i * n + j] = s;
+        }
+    }
+    m_eigen_generation = m_generation;
+}
+
+StopReason CmaEs::stopReason() const {
+    if (m_stop != StopReason::Running) return m_stop;
+    if (m_converged)                   return StopReason::Converged;
+    return Optimizer::stopReason();
+}
+
+void CmaEs::publishMetrics(double seconds, size_t evaluations, size_t evaluated) {
+    real best = std::numeric_limits<real>::quiet_NaN(), mean = best;
+    real sum = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < evaluated; i++) {
+        const real f = m_values[i];
+        if (std::isnan(f)) continue;
+        if (count == 0 || f > best) best = f;
+        sum += f;
+        count++;
+    }
+    if (count > 0) mean = sum / real(count);
+    const size_t reals = m_mean.capacity() + m_pc.capacity() + m_ps.capacity() + m_C.capacity() + m_B.capacity()
+                       + m_D.capacity() + m_invsqrtC.capacity() + m_z.capacity() + m_y.capacity() + m_values.capacity();
+    publish(seconds, evaluations, best, mean, m_lambda,
+            reals * sizeof(real) + m_points.capacity() * sizeof(Agent::phenotype) + m_order.capacity() * sizeof(size_t));
+}
+
+void CmaEs::printBest(std::ostream& os) {
+    // le meilleur point de la dernière génération complète, sinon le meilleur jamais évalué
+    const bool generation = m_generation > 0 && !std::isnan(m_values[m_order[0]]);
+    if (!generation && !m_best.found) {
+        os << "aucun point évalué" << std::endl;
+        return;
+    }
+    os << "Meilleur point :" << std::endl;
+    print_vectors(os, generation ? m_points[m_order[0]] : m_best.vectors);
+    os << "\nfitness : " << (generation ? m_values[m_order[0]] : m_best.fitness) << std::endl;
+}
+
+void CmaEs::saveCheckpoint(const std::string& folder) const {
+    fs::path dir = folder;
+    fs::create_directories(dir);
+
+    fs::path gen = dir / (std::string("population") + std::string(extension_generations));
+    std::ofstream file (gen);
+    if (!file.is_open()) {
+        throw std::runtime_error("impossible d'écrire " + gen.string());
+    }
+
+    auto write = [&file](const char* name, const real* v, size_t size) {
+        file << name;
+        for (size_t i = 0; i < size; i++) file << ' ' << v[i];
+        file << '\n';
+    };
+
+    // une ligne de paramètres, puis l'état de la distribution
+    file << std::setprecision(std::numeric_limits<real>::max_digits10)
+         << "seed " << m_params.seed << " generation " << m_generation << " evaluations " << m_evaluations
+         << " algorithm " << to_string(m_params.algorithm) << " lambda " << m_lambda << " mu " << m_mu
+         << " sigma " << m_sigma << " min_real " << m_params.domain.min << " max_real " << m_params.domain.max
+         << " stop " << to_string(stopReason()) << '\n';
+    write("mean", m_mean.data(), m_mean.size());
+    write("pc", m_pc.data(), m_pc.size());
+    write("ps", m_ps.data(), m_ps.size());
+    for (size_t i = 0; i < n && m_C.size() == n * n; i++) write("C", &m_C[i * n], n);
+
+    write_solution(folder, m_best);
+}
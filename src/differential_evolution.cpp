@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "differential_evolution.h"
+#include "randomizer.h"
+#include "sampling.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t coordinate_count = NumberOfVectors * Dimension;
+
+// les coordonnées d'un point, contiguës (vecteur après vecteur)
+real* coordinates(Agent::phenotype& p) { return &p[0][0]; }
+const real* coordinates(const Agent::phenotype& p) { return &p[0][0]; }
+
+} // namespace
+
+
+
+DifferentialEvolution::DifferentialEvolution(const Parameters& params, ThreadPool* pool)
+    : Optimizer(params, pool) {}
+
+void DifferentialEvolution::init() {
+    beginRun();
+    m_best = Solution{};
+
+    const size_t size = m_params.continuous_population ? m_params.continuous_population
+                                                       : std::max<size_t>(4, 10 * coordinate_count);
+    m_points.assign(size, Agent::phenotype{});
+    m_fitness.assign(size, std::numeric_limits<real>::quiet_NaN());
+    m_trials.assign(size, Agent::phenotype{});
+    m_trial_fitness.assign(size, std::numeric_limits<real>::quiet_NaN());
+
+    // la population initiale, tirée sur le thread appelant selon Parameters::initialization
+    const Domain& d = m_params.domain;
+    std::vector<real> u (size * coordinate_count);
+    if (m_params.initialization == Initialization::Uniform) {
+        Randomizer::fillProbs(u.data(), u.size());
+    } else {
+        const UnitDesign design(m_params.initialization, size, coordinate_count);
+        for (size_t i = 0; i < size; i++) {
+            for (size_t j = 0; j < coordinate_count; j++) u[i * coordinate_count + j] = design.coordinate(i, j);
+        }
+    }
+    for (size_t i = 0; i < size; i++) {
+        real* x = coordinates(m_points[i]);
+        for (size_t j = 0; j < coordinate_count; j++) x[j] = d.min + u[i * coordinate_count + j] * (d.max - d.min);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const size_t count = std::min(size, evaluationsLeft());
+    const size_t done = evaluateVectors(std::span(m_points).first(count), m_fitness.data());
+    m_evaluations += done;
+    trackBest(m_points, m_fitness.data(), count);
+    interrupted();
+    publishMetrics(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), done);
+}
+
+void DifferentialEvolution::step(size_t n) {
+    using clock = std::chrono::steady_clock;
+    EngineMetrics& metrics = *m_metrics;
+    const Domain& d = m_params.domain;
+    const size_t size = m_points.size();
+    const real F = m_params.de_weight, CR = m_params.de_crossover;
+
+    for (size_t k = 0; k < n && !finished(); k++) {
+        if (interrupted()) break;
+        const clock::time_point start = clock::now();
+        clock::time_point last = start;
+        auto lap = [&](Stage s) {
+            clock::time_point now = clock::now();
+            metrics.addStage(s, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+            last = now;
+        };
+
+        // les essais : tirés en série, la graine fixe donc tout le run
+        for (size_t i = 0; i < size; i++) {
+            size_t r1, r2, r3;
+            do r1 = Randomizer::bounded(size); while (r1 == i);
+            do r2 = Randomizer::bounded(size); while (r2 == i || r2 == r1);
+            do r3 = Randomizer::bounded(size); while (r3 == i || r3 == r1 || r3 == r2);
+            const size_t forced = Randomizer::bounded(coordinate_count);
+
+            const real* x  = coordinates(m_points[i]);
+            const real* a  = coordinates(m_points[r1]);
+            const real* b  = coordinates(m_points[r2]);
+            const real* c  = coordinates(m_points[r3]);
+            real* t = coordinates(m_trials[i]);
+            for (size_t j = 0; j < coordinate_count; j++) {
+                if (j != forced && !(Randomizer::getProb() < CR)) {
+                    t[j] = x[j];
+                    continue;
+                }
+                real v = a[j] + F * (b[j] - c[j]);
+                if (v < d.min)      v = (x[j] + d.min) / 2; // ramené entre la cible et la borne franchie
+                else if (v > d.max) v = (x[j] + d.max) / 2;
+                t[j] = v;
+            }
+        }
+        lap(Stage::Crossover);
+
+        const size_t evaluations = m_evaluations;
+        const size_t count = std::min(size, evaluationsLeft());
+        const size_t done = evaluateVectors(std::span(m_trials).first(count), m_trial_fitness.data());
+        m_evaluations += done;
+
+        // remplacement glouton ; un essai non évalué (échéance, budget) laisse sa cible en place
+        for (size_t i = 0; i < count; i++) {
+            const real f = m_trial_fitness[i];
+            if (std::isnan(f) || f < m_fitness[i]) continue;
+            m_points[i] = m_trials[i];
+            m_fitness[i] = f;
+        }
+        trackBest(m_trials, m_trial_fitness.data(), count);
+        lap(Stage::Selection);
+
+        // une génération interrompue n'est pas comptée, mais ses remplacements sont gardés : la population reste valide
+        if (done == size) m_generation++;
+        interrupted();
+        publishMetrics(std::chrono::duration<double>(clock::now() - start).count(), m_evaluations - evaluations);
+        if (done < size) break;
+    }
+}
+
+void DifferentialEvolution::trackBest(std::span<const Agent::phenotype> points, const real* values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (std::isnan(values[i]) || (m_best.found && !(values[i] > m_best.fitness))) continue;
+        m_best.found = true;
+        m_best.fitness = values[i];
+        m_best.generation = m_generation;
+        m_best.vectors = points[i];
+    }
+}
+
+void DifferentialEvolution::publishMetrics(double seconds, size_t evaluations) {
+    real best = std::numeric_limits<real>::quiet_NaN(), mean = best;
+    real sum = 0;
+    size_t count = 0;
+    for (real f : m_fitness) {
+        if (std::isnan(f)) continue;
+        if (count == 0 || f > best) best = f;
+        sum += f;
+        count++;
+    }
+    if (count > 0) mean = sum / real(count);
+    publish(seconds, evaluations, best, mean, m_points.size(),
+            (m_points.capacity() + m_trials.capacity()) * sizeof(Agent::phenotype)
+            + (m_fitness.capacity() + m_trial_fitness.capacity()) * sizeof(real));
+}
+
+void DifferentialEvolution::printBest(std::ostream& os) {
+    size_t best = m_points.size();
+    for (size_t i = 0; i < m_points.size(); i++) {
+        if (std::isnan(m_fitness[i])) continue;
+        if (best == m_points.size() || m_fitness[i] > m_fitness[best]) best = i;
+    }
+    if (best == m_points.size()) {
+        os << "aucun point évalué" << std::endl;
+        return;
+    }
+    os << "Meilleur point :" << std::endl;
+    print_vectors(os, m_points[best]);
+    os << "\nfitness : " << m_fitness[best] << std::endl;
+}
+
+void DifferentialEvolution::saveCheckpoint(const std::string& folder) const {
+    fs::path dir = folder;
+    fs::create_directories(dir);
+
+    fs::path gen = dir / (std::string("population") + std::string(extension_generations));
+    std::ofstream file (gen);
+    if (!file.is_open()) {
+        throw std::runtime_error("impossible d'écrire " + gen.string());
+    }
+
+    // une ligne de paramètres, puis chaque point sur une ligne : ses coordonnées, puis sa fitness
+    file << std::setprecision(std::numeric_limits<real>::max_digits10)
+         << "seed " << m_params.seed << " generation " << m_generation << " evaluations " << m_evaluations
+         << " algorithm " << to_string(m_params.algorithm) << " population " << m_points.size()
+         << " weight " << m_params.de_weight << " crossover " << m_params.de_crossover
+         << " min_real " << m_params.domain.min << " max_real " << m_params.domain.max
+         << " stop " << to_string(stopReason()) << '\n';
+    for (size_t i = 0; i < m_points.size(); i++) {
+        const real* x = coordinates(m_points[i]);
+        for (size_t j = 0; j < coordinate_count; j++) file << x[j] << ' ';
+        file << m_fitness[i] << '\n';
+    }
+
+    write_solution(folder, m_best);
+}
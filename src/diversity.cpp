@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "diversity.h"
+#include "kernels.h"
+
+
+
+namespace {
+
+constexpr size_t coords      = NumberOfVectors * Dimension;
+constexpr size_t word_count  = Agent::storage::word_count;
+constexpr size_t word_bits   = Agent::storage::word_bits;
+constexpr size_t genome_bits = Agent::storage::total_bits;
+constexpr size_t planes      = 32; // compteurs verticaux de 32 bits : jusqu'à 2^32 agents
+
+// les sommes partielles d'un worker
+struct Partial {
+    // compteurs verticaux : le bit b du mot w du plan j est le bit j du nombre d'agents ayant le bit (w, b) à 1
+    std::array<std::array<integer, word_count>, planes> counter {};
+
+    // moments des coordonnées, centrées sur le milieu de l'intervalle (moins d'annulation dans la variance)
+    std::array<real, coords> sum {}, sq {};
+};
+
+void add_agent(Partial& part, const Agent& a) {
+    std::span<const integer> words = a.packedGenes();
+    for (size_t w = 0; w < word_count; w++) {
+        // incrément binaire des 32 compteurs du mot à la fois : deux opérations par mot en moyenne
+        integer carry = words[w];
+        for (size_t j = 0; carry != 0; j++) {
+            integer t = part.counter[j][w] & carry;
+            part.counter[j][w] ^= carry;
+            carry = t;
+        }
+    }
+
+    constexpr real middle = (min_real + max_real) / 2;
+    const auto x = a.coordinates();
+    for (size_t k = 0; k < coords; k++) {
+        real c = x[k] - middle;
+        part.sum[k] += c;
+        part.sq[k]  += c * c;
+    }
+}
+
+uint64_t hash_words(std::span<const integer> words) {
+    uint64_t h = 0xCBF29CE484222325ULL; // FNV-1a, mot par mot
+    for (integer w : words) h = (h ^ w) * 0x100000001B3ULL;
+    return h;
+}
+
+} // namespace
+
+
+
+DiversityMetrics diversity_metrics (const Population& p, ThreadPool* pool, size_t sample) {
+    DiversityMetrics res;
+    const size_t n = p.size();
+    const size_t m = (sample == 0) ? n : std::min(sample, n);
+    res.sampled = m;
+    res.allele_frequency.assign(genome_bits, 0);
+    if (m == 0) return res;
+
+    // l'agent k de l'échantillon est l'agent k*n/m de la population : un pas régulier, aucun tirage
+    auto sampled = [n, m, &p](size_t k) -> const Agent& { return p[k * n / m]; };
+
+    std::vector<Partial> partial(pool ? pool->size() : 1);
+    parallel_for(pool, m, [&](size_t begin, size_t end, size_t w) {
+        for (size_t k = begin; k < end; k++) add_agent(partial[w], sampled(k));
+    });
+
+    // ===== fréquences alléliques et distance de Hamming moyenne =====
+    const size_t used = std::bit_width(m); // un compteur ne dépasse pas m : les plans suivants sont nuls
+    for (size_t bit = 0; bit < genome_bits; bit++) {
+        size_t w = bit / word_bits, b = bit % word_bits;
+        uint64_t count = 0;
+        for (const Partial& part : partial) {
+            for (size_t j = 0; j < used; j++) count += uint64_t((part.counter[j][w] >> b) & 1) << j;
+        }
+        res.allele_frequency[bit] = real(count) / real(m);
+    }
+
+    if (m >= 2) {
+        // deux agents diffèrent sur un bit de fréquence f avec une probabilité 2f(1-f) (tirage sans remise : facteur m/(m-1))
+        real sum = 0;
+        for (real f : res.allele_frequency) sum += 2 * f * (1 - f);
+        res.mean_hamming = sum * real(m) / real(m - 1);
+        res.mean_hamming_ratio = res.mean_hamming / real(genome_bits);
+    }
+
+    // ===== étalement des coordonnées =====
+    for (size_t k = 0; k < coords; k++) {
+        real sum = 0, sq = 0;
+        for (const Partial& part : partial) { sum += part.sum[k]; sq += part.sq[k]; }
+        real mean = sum / real(m);
+        res.spread[k] = std::sqrt(std::max(real(0), sq / real(m) - mean * mean)) / real_size;
+    }
+
+    // ===== doublons =====
+    std::vector<std::pair<uint64_t, size_t>> hashes(m);
+    for (size_t k = 0; k < m; k++) hashes[k] = { hash_words(sampled(k).packedGenes()), k };
+    std::sort(hashes.begin(), hashes.end());
+
+    const KernelTable& kt = kernels();
+    size_t duplicates = 0;
+    for (size_t first = 0; first < m; ) {
+        size_t last = first + 1;
+        while (last < m && hashes[last].first == hashes[first].first) last++;
+
+        // même empreinte : on vérifie bit à bit, un agent est un doublon s'il égale un agent précédent du groupe
+        for (size_t k = first + 1; k < last; k++) {
+            const integer* a = sampled(hashes[k].second).packedGenes().data();
+            for (size_t l = first; l < k; l++) {
+                if (kt.hamming(a, sampled(hashes[l].second).packedGenes().data(), word_count) == 0) {
+                    duplicates++;
+                    break;
+                }
+            }
+        }
+        first = last;
+    }
+    res.duplicate_ratio = real(duplicates) / real(m);
+
+    return res;
+}
+
+
+
+real diversity (const Population& p, ThreadPool* pool) {
+    if (p.size() < 2) return 0;
+
+    DiversityMetrics d = diversity_metrics(p, pool, 0);
+    real sum = 0;
+    for (real s : d.spread) sum += s;
+    return sum / real(coords);
+}
@@ -0,0 +1,680 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "expression.h"
+#include "engine.h"
+#include "randomizer.h"
+
+
+namespace fs = std::filesystem; // alias pour avoir à moins écrire
+
+
+
+
+// ==================================================================================================================
+// Moteur
+// ==================================================================================================================
+
+GeneticEngine::GeneticEngine(const Parameters& params, ThreadPool* pool)
+    : Optimizer(params, pool) {}
+
+void GeneticEngine::init() {
+    beginRun();
+
+    const size_t n = m_params.populationSize();
+    m_population = Population(n, m_params.storage);
+    m_parents.assign(m_params.half_population_size, 0);
+    m_children   = Population(n, m_params.storage);
+
+    populate(m_population, m_params.initial_mutation_proba, m_pool, 0, m_params.initialization);
+    // la génération en construction n'est jamais lue avant d'être écrite : des agents vierges, sans aucun tirage
+    populate_blank(m_children, m_pool);
+
+    m_fitness_generation = size_t(-1);
+    m_fitness_partial = size_t(-1);
+    if constexpr (UseDeltaFitness) m_sums.assign(n, std::numeric_limits<real>::quiet_NaN());
+    m_delta = false;
+    m_diversity_generation = size_t(-1);
+    m_converged = false;
+    m_surrogate.clear();
+    m_screen_generation = size_t(-1);
+    m_best_so_far = BestAgent{};
+    if (m_params.operator_policy != OperatorPolicy::Fixed) {
+        m_crossover_bandit = OperatorBandit(m_params.operator_policy, CrossoverOperators);
+        m_mutation_bandit  = OperatorBandit(m_params.operator_policy, MutationOperators);
+    }
+    m_crossovers.clear();
+    m_mutations.clear();
+    m_bred = 0;
+
+    publishMetrics(0, 0);
+    m_initial_diversity = (m_params.size_policy == PopulationPolicy::Diversity) ? diversity(m_population, m_pool) : 0;
+}
+
+void GeneticEngine::step(size_t n) {
+    using clock = std::chrono::steady_clock;
+    EngineMetrics& metrics = *m_metrics;
+
+    clock::time_point start = clock::now();
+    size_t evaluations = m_evaluations;
+    for (size_t k = 0; k < n && !finished(); k++) {
+        if (interrupted()) break;
+        start = clock::now();
+        evaluations = m_evaluations;
+
+        // ajoute aux métriques le temps écoulé depuis la fin de l'étape précédente
+        clock::time_point last = start;
+        auto lap = [&](Stage s) {
+            clock::time_point now = clock::now();
+            metrics.addStage(s, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+            last = now;
+        };
+
+        // les tournois relisent la fitness de la génération : évaluée d'un bloc, autant d'évaluations que les tournois
+        // eux-mêmes, mais un lot que l'échéance peut interrompre et dont le meilleur agent est retenu
+        const real* known = nullptr;
+        if (m_fitness_generation == m_generation)        known = m_fitness.data();
+        else if (m_screen_generation == m_generation)    known = m_screen.data();
+        else if constexpr (NumberOfObjectives == 1) {
+            fitness();
+            if (m_fitness_generation != m_generation) break; // évaluation interrompue : la génération est abandonnée
+            known = m_fitness.data();
+        }
+        else if (evaluationsLeft() < m_population.size()) {
+            m_stop = StopReason::Evaluations; // le classement de Pareto évalue toute la génération
+            break;
+        }
+        const uint8_t* exact = known == m_screen.data() ? m_screen_exact.data() : nullptr;
+        if (m_bred) creditOperators(known, exact);
+        m_evaluations += selection_tournoi(m_population, m_parents, m_params.domain, m_pool, known);
+        lap(Stage::Selection);
+        if (interrupted()) break;
+        if (m_params.operator_policy != OperatorPolicy::Fixed) assignOperators(known, exact);
+
+        if (m_params.fused_generation) {
+            breedFused();
+            lap(Stage::Crossover);
+        } else {
+            cross_over_half_pop(m_population, m_parents, m_children, m_pool, {}, m_crossovers);
+            lap(Stage::Crossover);
+            if (interrupted()) break;
+
+            // la génération construite devient la courante : aucune recopie
+            m_population.swap(m_children);
+            // les sommes de l'ancienne génération servent de référence aux évaluations par delta de la nouvelle,
+            // sauf sur disque où l'ancienne génération est abandonnée ci-dessous
+            if constexpr (UseDeltaFitness) {
+                m_reference_sums.swap(m_sums);
+                m_sums.assign(m_population.size(), std::numeric_limits<real>::quiet_NaN());
+                m_delta = !m_children.outOfCore() && (m_generation + 1) % DeltaRefreshInterval != 0;
+            }
+            // sur disque, l'ancienne génération est abandonnée sans être réécrite : le prochain croisement l'écrase
+            m_children.advise(PlacedBuffer::Advice::Discard, 0, m_children.capacity());
+            mutations(&m_population, m_pool, m_mutations);
+            m_generation++;
+            lap(Stage::Mutation);
+        }
+
+        if (m_bred) {
+            // les couples sont formés : la fitness de leurs parents est relevée avant que la réduction de la
+            // population ne tronque m_parents
+            m_parent_fitness.resize(m_parents.size());
+            for (size_t j = 0; j < m_parents.size(); j++) m_parent_fitness[j] = m_previous_fitness[m_parents[j]];
+        }
+
+        resizePopulation();
+        lap(Stage::Resize);
+
+        // la génération est complète : un arrêt ne fait plus que sauter les étapes qui évaluent
+        if (m_params.surrogateEnabled() && !interrupted()) {
+            screenOffspring();
+            lap(Stage::Surrogate);
+        }
+
+        if (m_params.memetic_elite > 0 && !interrupted()) {
+            // l'évaluation de la nouvelle génération sert à choisir l'élite, puis aux tournois suivants
+            fitness();
+            if (m_fitness_generation == m_generation) {
+                // les opérateurs sont crédités avant que la recherche locale n'améliore l'élite
+                if (m_bred) creditOperators(m_fitness.data(), nullptr);
+                // le budget borne la recherche locale d'avance ; l'échéance et l'arrêt l'interrompent entre deux blocs
+                size_t budget = std::min(m_params.memetic_budget, evaluationsLeft() / m_params.memetic_elite);
+                m_evaluations += localSearch(budget);
+                trackBest(m_fitness.data(), nullptr);
+            }
+            lap(Stage::Memetic);
+        }
+
+        if (NumberOfObjectives == 1 && metrics.watched.load(std::memory_order_relaxed) && !m_params.surrogateEnabled()
+            && !interrupted()) {
+            // pour publier la fitness, la génération est évaluée maintenant plutôt que dans les tournois suivants
+            fitness();
+            lap(Stage::Selection);
+        }
+
+        // critère d'arrêt : la population a perdu sa diversité génotypique
+        if (m_params.min_hamming_ratio > 0 && diversityMetrics().mean_hamming_ratio < m_params.min_hamming_ratio) {
+            m_converged = true;
+        }
+        lap(Stage::Diversity);
+
+        if constexpr (save) {
+            if (m_generation % save_interval == 0) saveGeneration(m_generation);
+        }
+
+        interrupted();
+        publishMetrics(std::chrono::duration<double>(clock::now() - start).count(), m_evaluations - evaluations);
+        evaluations = m_evaluations;
+    }
+
+    // une génération abandonnée : les évaluations déjà faites restent comptées
+    if (m_stop != StopReason::Running && m_evaluations != evaluations) {
+        publishMetrics(std::chrono::duration<double>(clock::now() - start).count(), m_evaluations - evaluations);
+    }
+}
+
+StopReason GeneticEngine::stopReason() const {
+    if (m_stop != StopReason::Running)       return m_stop;
+    if (m_converged)                         return StopReason::Converged;
+    return Optimizer::stopReason();
+}
+
+size_t GeneticEngine::evaluateBatch(std::span<const size_t> indices, real* out, uint8_t* exact) {
+    std::vector<size_t> done(m_pool ? m_pool->size() : 1, 0);
+    std::atomic<bool> stop { false };
+
+    parallel_for(m_pool, indices.size(), [&](size_t begin, size_t end, size_t w) {
+        size_t count = 0;
+        real values[fx::block];
+        // par blocs de fx::block agents, évalués ensemble par eval_agents ;
+        // l'horloge n'est relue qu'entre deux blocs : elle coûte autant qu'une fitness simple
+        for (size_t k=begin; k<end; k+=fx::block) {
+            if (stop.load(std::memory_order_relaxed) || expired()) {
+                stop.store(true, std::memory_order_relaxed);
+                break;
+            }
+            size_t n = std::min(fx::block, end - k);
+            evaluateBlock(m_population, indices.subspan(k, n), values, m_sums.data(),
+                          m_children, m_reference_sums.data(), m_delta);
+            for (size_t j=0; j<n; j++) {
+                size_t i = indices[k + j];
+                out[i] = values[j];
+                if (exact) exact[i] = 1;
+            }
+            count += n;
+        }
+        done[w] = count;
+    });
+    return std::accumulate(done.begin(), done.end(), size_t(0));
+}
+
+size_t GeneticEngine::localSearch(size_t budget) {
+    // chaque candidat ne diffère de son agent d'élite que d'un gène : avec UseDeltaFitness, il est évalué à partir de
+    // la somme de celui-ci, et un agent amélioré reçoit la somme de son candidat
+    CandidateEvaluator evaluate = [this](const Population& candidates, std::span<const size_t> references,
+                                         real* values, real* sums) {
+        std::vector<size_t> indices(candidates.size());
+        std::iota(indices.begin(), indices.end(), size_t(0));
+        std::vector<size_t> done(m_pool ? m_pool->size() : 1, 0);
+        std::atomic<bool> stop { false };
+
+        // comme evaluateBatch : par blocs de fx::block candidats, l'horloge relue entre deux blocs
+        parallel_for(m_pool, indices.size(), [&](size_t begin, size_t end, size_t w) {
+            size_t count = 0;
+            for (size_t k = begin; k < end; k += fx::block) {
+                if (stop.load(std::memory_order_relaxed) || expired()) {
+                    stop.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                const size_t n = std::min(fx::block, end - k);
+                evaluateBlock(candidates, { indices.data() + k, n }, values + k, sums, m_population, m_sums.data(),
+                              UseDeltaFitness, references.subspan(k, n));
+                count += n;
+            }
+            done[w] = count;
+        });
+        return std::accumulate(done.begin(), done.end(), size_t(0));
+    };
+    return local_search(m_population, m_fitness.data(), m_params.memetic_elite, budget, evaluate,
+                        UseDeltaFitness ? m_sums.data() : nullptr);
+}
+
+void GeneticEngine::evaluateBlock(const Population& p, std::span<const size_t> indices, real* values, real* sums,
+                                  const Population& previous, const real* previous_sums, bool delta,
+                                  std::span<const size_t> references) const {
+    const Domain& domain = m_params.domain;
+    if (UseDeltaFitness && domain.benchmark == Benchmark::None) {
+        // chaque agent part de la somme de son parent, s'il a été évalué
+        for (size_t j=0; j<indices.size(); j++) {
+            const size_t i = indices[j];
+            size_t r = size_t(-1);
+            if (delta && !references.empty()) {
+                if (!std::isnan(previous_sums[references[j]])) r = references[j];
+            } else if (delta) {
+                r = referenceOf(p[i], i, previous, previous_sums);
+            }
+            const real sum = r != size_t(-1)
+                           ? contribution_sum_delta(p[i], previous[r], previous_sums[r], domain)
+                           : contribution_sum(p[i], domain);
+            sums[i] = sum;
+            values[j] = eval_sum(sum);
+        }
+    } else {
+        eval_agents(p, indices, domain, values);
+    }
+}
+
+size_t GeneticEngine::referenceOf(const Agent& a, size_t i, const Population& previous, const real* previous_sums) const {
+    // le couple k a produit les agents 4k à 4k+3 (cross_over_half_pop) : ses deux parents, gardés tels quels, puis
+    // leurs enfants, faits de gènes de l'un et de l'autre. La référence est celui des deux, de somme connue, dont
+    // l'agent diffère sur le moins de coordonnées (mutations comprises) ; un parent seul donne les deux derniers agents
+    const size_t first = std::min(2 * (i / 4), m_parents.size() - 1);
+    const size_t last  = std::min(first + 1, m_parents.size() - 1);
+    // une coordonnée diffère si et seulement si son gène diffère : la comparaison se fait sans décodage
+    constexpr size_t coords = NumberOfVectors * Dimension;
+
+    size_t best = size_t(-1), fewest = coords + 1;
+    for (size_t k = first; k <= last; k++) {
+        const size_t r = m_parents[k];
+        if (std::isnan(previous_sums[r])) continue;
+        const Agent& y = previous[r];
+        size_t changed = 0;
+        for (size_t c = 0; c < coords; c++) changed += a.getGene(c / Dimension, c % Dimension) != y.getGene(c / Dimension, c % Dimension);
+        if (changed < fewest) { best = r; fewest = changed; }
+    }
+    return best;
+}
+
+void GeneticEngine::breedFused() {
+    // les tournois ont déjà tiré les parents : m_parents est le plan de la génération, la fitness de l'ancienne
+    // n'est plus lue. Chaque tuile de couples est croisée, mutée puis évaluée tant qu'elle est en cache : la
+    // génération n'est plus relue qu'une fois, par les parents, et écrite une fois, par les enfants
+    const size_t n = m_children.size();
+    const bool delta = UseDeltaFitness && !m_children.outOfCore() && (m_generation + 1) % DeltaRefreshInterval != 0;
+    m_fitness.assign(n, std::numeric_limits<real>::quiet_NaN());
+    // les sommes des enfants sont écrites à côté de celles des parents, qui leur servent de référence
+    if constexpr (UseDeltaFitness) m_reference_sums.assign(n, std::numeric_limits<real>::quiet_NaN());
+
+    // la politique Linear va tronquer la génération : les agents qu'elle écartera ne sont pas évalués
+    const size_t kept = m_params.size_policy == PopulationPolicy::Linear
+                      ? std::min(n, 2 * linearHalfSize(m_generation + 1)) : n;
+    const size_t allowed = evaluationsLeft();
+    std::atomic<size_t> reserved { 0 }, evaluated { 0 };
+    std::atomic<bool> stop { false };
+
+    cross_over_half_pop(m_population, m_parents, m_children, m_pool, [&](size_t first, size_t count) {
+        for (size_t i = first; i < first + count; i++) {
+            if (m_mutations.empty()) m_children[i].Mutate();
+            else                     mutate(m_children[i], Mutation(m_mutations[i]));
+        }
+
+        // une tuile hors budget ou après l'échéance reste à NaN : fitness() la reprendra
+        if (first >= kept) return;
+        count = std::min(count, kept - first);
+        if (stop.load(std::memory_order_relaxed) || reserved.fetch_add(count) + count > allowed) return;
+        size_t indices[4 * FusedTile];
+        std::iota(indices, indices + count, first);
+        real values[fx::block];
+        for (size_t k = 0; k < count; k += fx::block) {
+            if (expired()) {
+                stop.store(true, std::memory_order_relaxed);
+                return;
+            }
+            const size_t b = std::min(fx::block, count - k);
+            evaluateBlock(m_children, { indices + k, b }, values, m_reference_sums.data(), m_population, m_sums.data(), delta);
+            std::copy(values, values + b, m_fitness.begin() + std::ptrdiff_t(first + k));
+            evaluated.fetch_add(b, std::memory_order_relaxed);
+        }
+    }, m_crossovers);
+
+    // la génération construite devient la courante, avec sa fitness et ses sommes
+    m_population.swap(m_children);
+    if constexpr (UseDeltaFitness) {
+        m_sums.swap(m_reference_sums);
+        m_delta = delta; // les agents restés à NaN sont repris à partir des mêmes parents
+    }
+    m_children.advise(PlacedBuffer::Advice::Discard, 0, m_children.capacity());
+    m_generation++;
+
+    m_evaluations += evaluated.load();
+    m_fitness_partial = m_generation;
+    if (evaluated.load() == n) m_fitness_generation = m_generation; // sinon fitness() complète les NaN
+    trackBest(m_fitness.data(), nullptr);
+}
+
+void GeneticEngine::assignOperators(const real* known, const uint8_t* exact) {
+    // la fitness des parents est gardée pour le crédit : la génération qui la porte va être remplacée
+    m_previous_fitness.assign(known, known + m_population.size());
+    if (exact) {
+        for (size_t i = 0; i < m_previous_fitness.size(); i++) {
+            if (!exact[i]) m_previous_fitness[i] = std::numeric_limits<real>::quiet_NaN(); // une prédiction du substitut
+        }
+    }
+    const size_t parents = m_parents.size();
+    m_crossovers.resize((parents + 1) / 2);
+    m_mutations.resize(2 * parents);
+    m_crossover_bandit.assign(m_crossovers);
+    m_mutation_bandit.assign(m_mutations);
+    m_bred = 2 * parents;
+}
+
+void GeneticEngine::creditOperators(const real* values, const uint8_t* exact) {
+    // le couple k a produit les agents 4k et 4k+1, ses parents mutés, puis 4k+2 et 4k+3, ses enfants mutés
+    // (cross_over_half_pop) ; un parent seul donne son double muté puis un enfant avec le premier parent.
+    // Un parent muté crédite sa mutation de ce qu'il a gagné sur lui-même, un enfant crédite le croisement de
+    // son couple de ce qu'il a gagné sur le meilleur de ses parents. La population a pu être réduite depuis :
+    // ses derniers agents ne sont plus là
+    const size_t parents = m_bred / 2;
+    const size_t count = std::min(m_bred, m_population.size());
+    for (size_t i = 0; i < count; i++) {
+        if ((exact && !exact[i]) || std::isnan(values[i])) continue;
+        const size_t k = i / 4;
+        const size_t a = 2 * k;
+        const size_t b = a + 1 < parents ? a + 1 : 0;
+        const real fa = m_parent_fitness[a];
+        const real fb = m_parent_fitness[b];
+        if (i % 4 == 0 || (i % 4 == 1 && b != 0)) {
+            const real before = i % 4 == 0 ? fa : fb;
+            if (!std::isnan(before)) m_mutation_bandit.credit(m_mutations[i], values[i] - before);
+        } else if (!std::isnan(fa) && !std::isnan(fb)) {
+            m_crossover_bandit.credit(m_crossovers[k], values[i] - std::max(fa, fb));
+        }
+    }
+    m_crossover_bandit.update();
+    m_mutation_bandit.update();
+    m_bred = 0;
+}
+
+void GeneticEngine::trackBest(const real* values, const uint8_t* exact) {
+    size_t best = size_t(-1);
+    real f = m_best_so_far.agent ? m_best_so_far.fitness : -std::numeric_limits<real>::infinity();
+    for (size_t i = 0; i < m_population.size(); i++) {
+        if ((exact && !exact[i]) || !(values[i] > f)) continue; // NaN : agent pas encore évalué
+        f = values[i];
+        best = i;
+    }
+    if (best == size_t(-1)) return;
+
+    m_best_agent = m_population[best];
+    m_best_so_far.index = best;
+    m_best_so_far.fitness = f;
+    m_best_so_far.agent = &m_best_agent;
+    m_best_so_far.generation = m_generation;
+}
+
+BestAgent GeneticEngine::bestSoFar() const {
+    BestAgent b = m_best_so_far;
+    if (b.agent) b.agent = &m_best_agent; // le moteur a pu être déplacé depuis
+    return b;
+}
+
+Solution GeneticEngine::bestSolution() const {
+    Solution s;
+    if (!m_best_so_far.agent) return s;
+    s.found = true;
+    s.fitness = m_best_so_far.fitness;
+    s.generation = m_best_so_far.generation;
+    s.vectors = phenotype_in(m_best_agent, m_params.domain);
+    return s;
+}
+
+void GeneticEngine::publishMetrics(double seconds, size_t evaluations) {
+    // la fitness publiée est celle que le moteur connaît déjà : toute la génération, ou les agents évalués par le substitut
+    real best = std::numeric_limits<real>::quiet_NaN(), mean = best;
+    const bool all = (m_fitness_generation == m_generation);
+    const bool screened = !all && (m_screen_generation == m_generation);
+    if (all || screened) {
+        real sum = 0;
+        size_t count = 0;
+        for (size_t i = 0; i < m_population.size(); i++) {
+            if (screened && !m_screen_exact[i]) continue;
+            real f = all ? m_fitness[i] : m_screen[i];
+            if (count == 0 || f > best) best = f;
+            sum += f;
+            count++;
+        }
+        if (count > 0) mean = sum / real(count);
+    }
+    publish(seconds, evaluations, best, mean, m_population.size(),
+            m_population.buffer().bytes() + m_parents.capacity() * sizeof(ParentIndex) + m_children.buffer().bytes()
+            + (m_fitness.capacity() + m_sums.capacity() + m_reference_sums.capacity()) * sizeof(real)
+            + m_screen.capacity() * sizeof(real)
+            + m_screen_exact.capacity() + m_surrogate.memory());
+}
+
+void GeneticEngine::resizePopulation() {
+    const size_t initial = m_params.half_population_size;
+    const size_t minimum = m_params.min_half_population_size;
+    const size_t current = m_parents.size();
+    size_t target = current;
+
+    switch (m_params.size_policy) {
+    case PopulationPolicy::Fixed:
+        return;
+
+    case PopulationPolicy::Linear:
+        target = linearHalfSize(m_generation);
+        break;
+
+    case PopulationPolicy::Diversity: {
+        // une population qui converge n'a plus besoin de tous ses agents, une population qui se diversifie en regagne
+        real d = m_initial_diversity > 0 ? diversity(m_population, m_pool) / m_initial_diversity : 1;
+        target = size_t(std::llround(double(minimum) + double(initial - minimum) * std::min(1.0, double(d))));
+        // hystérésis : on ignore les variations de moins de 5 %
+        size_t gap = target > current ? target - current : current - target;
+        if (20 * gap < current) return;
+        break;
+    }
+    }
+
+    target = std::clamp(target, minimum, initial);
+    if (target == current) return;
+
+    const size_t old_size = m_population.size();
+    m_population.resize(2 * target);
+    if constexpr (UseDeltaFitness) m_sums.resize(2 * target, std::numeric_limits<real>::quiet_NaN());
+    m_delta = false; // les indices des parents ne correspondent plus
+    m_parents.resize(target);
+    m_children.resize(2 * target);
+
+    if (2 * target > old_size) {
+        // croissance : de nouveaux agents aléatoires (immigrants) complètent la population
+        populate(m_population, m_params.initial_mutation_proba, m_pool, old_size);
+        m_fitness_generation = m_fitness_partial = size_t(-1);
+    } else if (m_fitness_generation == m_generation || m_fitness_partial == m_generation) {
+        m_fitness.resize(m_population.size()); // les agents gardés conservent leur fitness
+    }
+}
+
+size_t GeneticEngine::linearHalfSize(size_t generation) const {
+    // de la taille initiale à la taille minimale, atteinte à la dernière génération
+    const size_t initial = m_params.half_population_size;
+    const size_t minimum = m_params.min_half_population_size;
+    double t = double(generation) / double(m_params.max_gen);
+    size_t target = size_t(std::llround(double(initial) + (double(minimum) - double(initial)) * t));
+    return std::clamp(target, minimum, initial);
+}
+
+void GeneticEngine::screenOffspring() {
+    const size_t n = m_population.size();
+    if (m_surrogate.size() < m_surrogate.neighbours()) return; // trop peu d'agents connus : la génération sera évaluée en entier
+
+    const Population& p = m_population;
+    const Surrogate& model = m_surrogate;
+    m_screen.resize(n);
+    m_screen_exact.assign(n, 0);
+    real* screen = m_screen.data();
+    parallel_for(m_pool, n, [&p, &model, screen](size_t begin, size_t end, size_t) {
+        for (size_t i=begin; i<end; i++) {
+            screen[i] = model.predict(p[i]);
+        }
+    });
+
+    // les plus prometteurs, puis une part tirée au hasard parmi les autres pour corriger les erreurs du substitut
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), size_t(0));
+    const size_t keep = std::min(n, size_t(std::ceil(m_params.surrogate_keep * real(n))));
+    std::nth_element(order.begin(), order.begin() + keep, order.end(),
+                     [screen](size_t a, size_t b) { return screen[a] > screen[b] || (screen[a] == screen[b] && a < b); });
+    const size_t explore = std::min(n - keep, size_t(std::llround(m_params.surrogate_exploration * real(n))));
+    Randomizer::shuffle(order.begin() + keep, order.end());
+    order.resize(std::min(keep + explore, evaluationsLeft()));
+
+    // interrompus par l'échéance, les agents restants gardent leur fitness prédite
+    m_evaluations += evaluateBatch(order, screen, m_screen_exact.data());
+
+    std::sort(order.begin(), order.end()); // l'archive reçoit les agents dans l'ordre de la population
+    for (size_t i : order) {
+        if (m_screen_exact[i]) m_surrogate.add(p[i], screen[i]);
+    }
+    m_surrogate.commit();
+    m_screen_generation = m_generation;
+    trackBest(screen, m_screen_exact.data());
+}
+
+std::span<const real> GeneticEngine::fitness() {
+    if (m_fitness_generation != m_generation) {
+        const Population& p = m_population;
+        if (m_fitness_partial != m_generation) {
+            // les agents déjà évalués par le substitut gardent leur vraie fitness
+            m_fitness.assign(p.size(), std::numeric_limits<real>::quiet_NaN());
+            if (m_screen_generation == m_generation) {
+                for (size_t i=0; i<p.size(); i++) {
+                    if (m_screen_exact[i]) m_fitness[i] = m_screen[i];
+                }
+            }
+            m_fitness_partial = m_generation;
+        }
+
+        // une génération interrompue reprend là où elle s'était arrêtée
+        m_pending.clear();
+        for (size_t i=0; i<p.size(); i++) {
+            if (std::isnan(m_fitness[i])) m_pending.push_back(i);
+        }
+        const size_t allowed = std::min(m_pending.size(), evaluationsLeft());
+        const size_t evaluated = evaluateBatch({ m_pending.data(), allowed }, m_fitness.data(), nullptr);
+
+        if (m_params.surrogateEnabled()) {
+            for (size_t k=0; k<allowed; k++) {
+                size_t i = m_pending[k];
+                if (!std::isnan(m_fitness[i])) m_surrogate.add(p[i], m_fitness[i]);
+            }
+            m_surrogate.commit();
+        }
+
+        m_evaluations += evaluated;
+        trackBest(m_fitness.data(), nullptr);
+        if (evaluated == m_pending.size()) m_fitness_generation = m_generation;
+        else interrupted();
+    }
+    return m_fitness;
+}
+
+const DiversityMetrics& GeneticEngine::diversityMetrics() {
+    if (m_diversity_generation != m_generation) {
+        m_diversity = diversity_metrics(m_population, m_pool);
+        m_diversity_generation = m_generation;
+    }
+    return m_diversity;
+}
+
+BestAgent GeneticEngine::best() {
+    std::span<const real> f = fitness();
+
+    // premier maximum, comme best_agent_index ; les agents laissés sans évaluation par un arrêt sont ignorés
+    BestAgent res;
+    res.generation = m_generation;
+    for (size_t i = 0; i < f.size(); i++) {
+        if (std::isnan(f[i]) || (res.agent && !(f[i] > res.fitness))) continue;
+        res.fitness = f[i];
+        res.index = i;
+        res.agent = &m_population[i];
+    }
+    return res;
+}
+
+size_t GeneticEngine::bestIndex(real* best_eval) {
+    BestAgent b = best();
+    if (best_eval) *best_eval = b.fitness;
+    return b.index;
+}
+
+void GeneticEngine::printBest(std::ostream& os) {
+    if constexpr (NumberOfObjectives > 1) {
+        m_evaluations += m_population.size();
+        print_best_agent(m_population, m_params.domain, os);
+    } else {
+        // la fitness de la génération est gardée : les tournois suivants la relisent sans la réévaluer
+        BestAgent b = best();
+        if (!b.agent) {
+            os << "best : aucun agent évalué";
+            return;
+        }
+        os << "best :\n";
+        print_vectors(os, *b.agent, m_params.domain);
+        os << "\nfitness : " << b.fitness;
+    }
+}
+
+// les mots des gènes compactés d'un agent, en hexadécimal
+static void write_genes(std::ostream& os, const Agent& a) {
+    std::span<const integer> words = a.packedGenes();
+    for (size_t k = 0; k < words.size(); k++) {
+        if (k > 0) os << ' ';
+        os << std::hex << std::setw(2 * sizeof(integer)) << std::setfill('0') << words[k] << std::dec;
+    }
+}
+
+void GeneticEngine::saveCheckpoint(const std::string& folder) const {
+    fs::path dir = folder;
+    if (fs::create_directories(dir)) {
+        std::cout << "Structure de dossiers '" << dir << "' créée." << std::endl;
+    }
+
+    fs::path gen = dir / (std::string("population") + std::string(extension_generations));
+    std::ofstream file (gen);
+    if (!file.is_open()) {
+        throw std::runtime_error("impossible d'écrire " + gen.string());
+    }
+
+    // une ligne de paramètres, puis chaque individu sur une ligne
+    file << std::setprecision(std::numeric_limits<real>::max_digits10)
+         << "seed " << m_params.seed << " generation " << m_generation << " evaluations " << m_evaluations
+         << " half_population_size " << m_parents.size() << " min_real " << m_params.domain.min
+         << " max_real " << m_params.domain.max << " stop " << to_string(stopReason()) << '\n';
+    for (const Agent& a : m_population) {
+        write_genes(file, a);
+        file << '\n';
+    }
+
+    if (!m_best_so_far.agent) return;
+
+    fs::path ind = dir / (std::string("best") + std::string(extension_individuals));
+    std::ofstream best (ind);
+    if (!best.is_open()) {
+        throw std::runtime_error("impossible d'écrire " + ind.string());
+    }
+    best << std::setprecision(std::numeric_limits<real>::max_digits10)
+         << "generation " << m_best_so_far.generation << "\nfitness " << m_best_so_far.fitness << '\n';
+    print_vectors(best, m_best_agent, m_params.domain);
+    best << "\ngenes ";
+    write_genes(best, m_best_agent);
+    best << '\n';
+}
+
+void GeneticEngine::saveGeneration(size_t indice) const {
+    fs::path gen = ".";
+    gen /= directory;
+    gen /= std::string("generation_") + std::to_string(indice);
+    saveCheckpoint(gen.string());
+}
@@ -1,24 +1,39 @@
-#include <fstream>
+#include <iostream>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
 #include <utility>
+#include <vector>
 #include <cstdint>
-#include <filesystem>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <numeric>
 #include <string>
 
 
 #include "Vec.h"
+#include "benchmarks.h"
+#include "expression.h"
 #include "settings.h"
 #include "utils.h"
 #include "randomizer.h"
+#include "sampling.h"
 #include "Individu.h"
+#include "kernels.h"
+#include "metrics.h"
+#include "multiobjective.h"
+#include "parallel.h"
+#include "stop.h"
 
 
 #include "genetic.h"
+#include "engine.h"
 
 
 
 
-namespace fs = std::filesystem; // alias pour avoir à moins écrire
 
 
 
@@ -50,227 +65,710 @@ inline float fitness (const std::array<Vec<Dimension>, NumberOfVectors>& vecteur
 
 
 
+/* 
+    Mode multi-objectif (NumberOfObjectives > 1) : chaque objectif est maximisé.
+*   dans notre cas, l'objectif k vaut -(somme des coordonnées - 100k)² : les objectifs sont contradictoires et
+*   le front de Pareto est formé des individus dont la somme est comprise entre 0 et 100(NumberOfObjectives-1)
+!   DO NOT CHANGE THE DEFINITION OF THE FUNCTION, CHANGE THE CODE INSIDE !
+*/
+inline Objectives fitness_objectives (const std::array<Vec<Dimension>, NumberOfVectors>& vecteurs) {   //? les fonctions objectifs
+    real sum = 0;
+    for(size_t i=0; i<NumberOfVectors; i++) {
+        for(size_t j=0; j<vecteurs[i].size(); j++) {
+            sum += vecteurs[i][j];
+        }
+    }
 
+    Objectives res;
+    for(size_t k=0; k<NumberOfObjectives; k++) {
+        real d = sum - real(100*k);
+        res[k] = -d*d;
+    }
+    return res;
+};
 
 
 
+/*
+    Fitness décomposable (UseDeltaFitness = true dans settings.h) : la fitness vaut fitness_from_sum(S), où S est la somme
+    des fitness_contribution de chaque coordonnée. Un agent qui ne diffère de son parent que par quelques gènes est alors
+    évalué à partir de la somme de ce parent, en ne recalculant que les contributions des coordonnées modifiées.
+*   dans notre cas, la même fonction que fitness : S est la somme des coordonnées, et la fitness vaut -S²
+!   DO NOT CHANGE THE DEFINITION OF THE FUNCTIONS, CHANGE THE CODE INSIDE !
+*/
+inline real fitness_contribution (size_t vecteur, size_t coordonnee, real x) {                      //? la contribution d'une coordonnée
+    (void)vecteur; (void)coordonnee;
+    return x;
+};
 
+inline real fitness_from_sum (real sum) {                                                            //? la fitness d'après la somme des contributions
+    return -sum*sum;
+};
 
+/*
+    MAP-Elites (Algorithm::MapElites) : les caractéristiques de comportement d'un agent, DescriptorDims réels dans [0, 1].
+    La grille de l'archive découpe chacun en Parameters::map_cells cases ; une valeur hors de [0, 1] tombe dans la case du bord.
+*   dans notre cas, la moyenne des coordonnées de chacun des deux premiers vecteurs, rapportée au domaine
+!   DO NOT CHANGE THE DEFINITION OF THE FUNCTION, CHANGE THE CODE INSIDE !
+*/
+inline Descriptor descriptor (const std::array<Vec<Dimension>, NumberOfVectors>& vecteurs, const Domain& domain) {   //? les caractéristiques de comportement
+    Descriptor res {};
+    for(size_t k=0; k<DescriptorDims && k<NumberOfVectors; k++) {
+        real sum = 0;
+        for(size_t j=0; j<Dimension; j++) sum += vecteurs[k][j];
+        res[k] = (sum / real(Dimension) - domain.min) / (domain.max - domain.min);
+    }
+    return res;
+};
 
 
 
+static_assert(!(UseDeltaFitness && UseFitnessExpression), "UseDeltaFitness et UseFitnessExpression s'excluent");
+static_assert(!UseDeltaFitness || NumberOfObjectives == 1, "UseDeltaFitness n'a qu'un objectif");
 
-real eval_agent (const Agent& a) {
-    // on doit transformer l'écriture binaire de chaque vecteur en une écriture réelle
-    std::array<Vec<Dimension>, NumberOfVectors> vecteurs; // initialisé à 0
 
-    for (size_t i=0; i<NumberOfVectors; i++) {
-        auto vec = a.getGenome()[i];
-        for (size_t j=0; j<Dimension; j++) {
-            vecteurs[i] += bin_to_real(vec[j]) * Vec<Dimension>::unit(j);
+
+
+
+
+
+
+
+
+
+
+
+void populate (Population& p, real mutation_proba, ThreadPool* pool, size_t first, Initialization strategy) {
+    Agent* agents = p.data() + first;
+    if (strategy == Initialization::Uniform) {
+        // chaque worker construit sa tranche : la politique "first-touch" du noyau la place sur son noeud NUMA
+        parallel_for(pool, p.size() - first, [agents, mutation_proba](size_t begin, size_t end, size_t) {
+            for (size_t i=begin; i<end; i++) {
+                new (agents + i) Agent(mutation_proba);
+            }
+        });
+        return;
+    }
+
+    // le plan (clés, décalages) est tiré sur le thread appelant ; chaque worker en calcule ses propres points
+    const UnitDesign design(strategy, p.size() - first, Agent::proba_offset);
+    parallel_for(pool, p.size() - first, [agents, mutation_proba, &design](size_t begin, size_t end, size_t) {
+        constexpr real scale = real(uint64_t(1) << Nb_bin);
+        constexpr uint64_t top = (uint64_t(1) << Nb_bin) - 1;
+        for (size_t i=begin; i<end; i++) {
+            Agent::genome g;
+            for (size_t c = 0; c < NumberOfVectors; c++) {
+                for (size_t j = 0; j < Dimension; j++) {
+                    const uint64_t gene = uint64_t(design.coordinate(i, c * Dimension + j) * scale);
+                    g[c][j] = integer(std::min(gene, top)); // un point à 1 - epsilon peut s'arrondir à 1
+                }
+            }
+            new (agents + i) Agent(g, mutation_proba);
+        }
+    });
+}
+
+void populate_blank (Population& p, ThreadPool* pool) {
+    if (p.outOfCore()) return; // écrire des agents vierges dans le fichier ne ferait que l'agrandir sur le disque
+
+    Agent* agents = p.data();
+    parallel_for(pool, p.capacity(), [agents](size_t begin, size_t end, size_t) {
+        for (size_t i=begin; i<end; i++) {
+            new (agents + i) Agent();
+        }
+    });
+}
+
+
+
+Agent::phenotype phenotype_in (const Agent& a, const Domain& domain) {
+    Agent::phenotype res = a.getPhenotype();
+    if (domain.isCanonical()) return res;
+
+    // même transformation que Domain::toDomain, sur chaque vecteur d'un coup
+    const real scale = (domain.max - domain.min) / real_size;
+    for (auto& v : res) {
+        kernels().remap(&v[0], v.size(), min_real, scale, domain.min, &v[0]);
+    }
+    return res;
+}
+
+// fitness_expression sur un bloc d'au plus fx::block agents : les coordonnées sont rangées coordonnée par coordonnée
+static void eval_block (const Agent* const* agents, size_t count, const Domain& domain, real* out) {
+    alignas(64) real x[fx::coordinate_count * fx::block] = {}; // les voies inutilisées valent 0 : pas de NaN parasite
+    for (size_t l = 0; l < count; l++) {
+        const auto c = agents[l]->coordinates(); // sans CachePhenotype, décodées ici directement
+        for (size_t k = 0; k < fx::coordinate_count; k++) x[k * fx::block + l] = c[k];
+    }
+    if (!domain.isCanonical()) {
+        // même transformation que phenotype_in, sur tout le bloc d'un coup
+        const real scale = (domain.max - domain.min) / real_size;
+        kernels().remap(x, fx::coordinate_count * fx::block, min_real, scale, domain.min, x);
+    }
+    kernels().fitness_block(x, count, out);
+}
+
+// la somme des contributions de vecteurs déjà dans le domaine du run
+static real sum_contributions (const Agent::phenotype& vectors) {
+    real sum = 0;
+    for (size_t i = 0; i < NumberOfVectors; i++) {
+        for (size_t j = 0; j < Dimension; j++) sum += fitness_contribution(i, j, vectors[i][j]);
+    }
+    return sum;
+}
+
+real contribution_sum (const Agent& a, const Domain& domain) {
+    if (domain.isCanonical()) return sum_contributions(a.getPhenotype());
+    return sum_contributions(phenotype_in(a, domain));
+}
+
+real contribution_sum_delta (const Agent& a, const Agent& reference, real reference_sum, const Domain& domain) {
+    // les coordonnées décodées suivent les gènes : une coordonnée modifiée est un gène modifié
+    const auto x = a.coordinates();
+    const auto y = reference.coordinates();
+    size_t changed = 0;
+    for (size_t k = 0; k < x.size(); k++) changed += x[k] != y[k];
+    if (2 * changed > x.size()) return contribution_sum(a, domain); // plus court, et sans arrondi hérité
+
+    const bool canonical = domain.isCanonical(); // comme contribution_sum : les coordonnées telles quelles
+    real delta = 0;
+    for (size_t k = 0; k < x.size() && changed > 0; k++) {
+        if (x[k] == y[k]) continue;
+        const size_t i = k / Dimension, j = k % Dimension;
+        const real now    = canonical ? x[k] : domain.toDomain(x[k]);
+        const real before = canonical ? y[k] : domain.toDomain(y[k]);
+        delta += fitness_contribution(i, j, now) - fitness_contribution(i, j, before);
+        changed--;
+    }
+    return reference_sum + delta;
+}
+
+real eval_sum (real sum) {
+    return fitness_from_sum(sum);
+}
+
+real eval_agent (const Agent& a, const Domain& domain) {
+    if (domain.benchmark != Benchmark::None) {
+        const Agent::phenotype v = phenotype_in(a, domain);
+        return evaluate_benchmark(domain.benchmark, &v[0][0], domain.benchmarkDims());
+    }
+    if constexpr (UseDeltaFitness) return fitness_from_sum(contribution_sum(a, domain));
+    if constexpr (UseFitnessExpression) {
+        if (domain.isCanonical()) return kernels().fitness_agent(a.coordinates().data());
+        real x[fx::coordinate_count];
+        const real scale = (domain.max - domain.min) / real_size;
+        kernels().remap(a.coordinates().data(), fx::coordinate_count, min_real, scale, domain.min, x);
+        return kernels().fitness_agent(x);
+    }
+    // avec CachePhenotype, le phénotype est tenu à jour par l'agent lui-même : aucun décodage ici
+    if (domain.isCanonical()) return fitness(a.getPhenotype());
+    return fitness(phenotype_in(a, domain));
+}
+
+real eval_vectors (const Agent::phenotype& vectors, const Domain& domain) {
+    if (domain.benchmark != Benchmark::None) {
+        return evaluate_benchmark(domain.benchmark, &vectors[0][0], domain.benchmarkDims());
+    }
+    if constexpr (UseDeltaFitness) return fitness_from_sum(sum_contributions(vectors));
+    if constexpr (UseFitnessExpression) return kernels().fitness_agent(&vectors[0][0]); // le phénotype est contigu
+    return fitness(vectors);
+}
+
+Descriptor eval_descriptor (const Agent::phenotype& vectors, const Domain& domain) {
+    Descriptor d = descriptor(vectors, domain);
+    for (real& x : d) x = std::isnan(x) ? 0 : std::clamp(x, real(0), real(1));
+    return d;
+}
+
+void eval_agents (const Population& p, std::span<const size_t> indices, const Domain& domain, real* out) {
+    if (UseFitnessExpression && domain.benchmark == Benchmark::None) {
+        const Agent* agents[fx::block];
+        for (size_t first = 0; first < indices.size(); first += fx::block) {
+            size_t count = std::min(fx::block, indices.size() - first);
+            for (size_t l = 0; l < count; l++) agents[l] = &p[indices[first + l]];
+            eval_block(agents, count, domain, out + first);
         }
+        return;
     }
+    for (size_t k = 0; k < indices.size(); k++) out[k] = eval_agent(p[indices[k]], domain);
+}
+
+Objectives eval_agent_objectives (const Agent& a, const Domain& domain) {
+    if (domain.isCanonical()) return fitness_objectives(a.getPhenotype());
+    return fitness_objectives(phenotype_in(a, domain));
+}
+
+
+
+// rang de Pareto et distance de crowding de chaque agent de la population (mode multi-objectif)
+struct ParetoRanking {
+    std::vector<Objectives> objectives;
+    std::vector<size_t> rank;
+    std::vector<real> crowding;
+};
+
+static ParetoRanking rank_population (const Population& p, const Domain& domain, ThreadPool* pool) {
+    ParetoRanking r;
+    r.objectives.resize(p.size());
+    parallel_for(pool, p.size(), [&](size_t begin, size_t end, size_t) {
+        for (size_t i=begin; i<end; i++) {
+            r.objectives[i] = eval_agent_objectives(p[i], domain);
+        }
+    });
 
-    // normalement à cette ligne, la variable vecteur représente correctement la même information déjà stockée dans l'agent a
-    return fitness(vecteurs);
+    const real* flat = r.objectives.data()->data(); // std::array est contigu : matrice taille × NumberOfObjectives
+    non_dominated_sort(flat, p.size(), NumberOfObjectives, r.rank);
+    crowding_distance(flat, p.size(), NumberOfObjectives, r.rank, r.crowding);
+    return r;
 }
 
-HalfPopulation selection_tournoi(const Population& p) {
-    HalfPopulation hp {}; // initialisé à 0
+size_t selection_tournoi(const Population& p, std::span<ParentIndex> parents, const Domain& domain, ThreadPool* pool, const real* fitness) {
+    const int last = int(p.size()) - 1;
 
     bool best_has_been_selectionned = false; // on laisse comme ça pour le moment, on essai d'éviter la convergence prématurée (c.f [1])
-    for (size_t i=0; i<HalfPopulationSize; i++) {
-        // on prend 2 indices :
-        int iA = Randomizer::getInt(0, PopulationSize - 1);
-        int iB = Randomizer::getInt(0, PopulationSize - 1);
 
-        // on prend le meilleur des 2 agents
-        float evalA = eval_agent(p[iA]);
-        float evalB = eval_agent(p[iB]);
+    // les indices des tournois sont tirés en masse, par blocs : tape[2t] et tape[2t+1] sont les adversaires du tournoi t
+    constexpr size_t block = 256;
+
+    // population sur disque : les adversaires du parent k sont tirés dans la tuile de l'agent 2k, un bloc ne
+    // chevauche jamais deux tuiles ; en mémoire, une seule fenêtre couvre toute la population
+    const size_t window = p.tile() ? p.tile() / 2 : parents.size();
+    auto opponents = [&](size_t b, size_t end, size_t& count, int& lo, int& hi) {
+        size_t w = b / window;
+        count = std::min({ block, end - b, (w + 1) * window - b });
+        lo = p.tile() ? int(w * p.tile()) : 0;
+        hi = p.tile() ? int(std::min(size_t(lo) + p.tile(), p.size())) - 1 : last;
+    };
 
-        if(evalA > evalB)   hp[i] = p[iA];
-        else                hp[i] = p[iB];
+    if constexpr (NumberOfObjectives > 1) {
+        // le classement est calculé une seule fois, les tournois ne font que le lire
+        ParetoRanking r = rank_population(p, domain, pool);
+        parallel_for(pool, parents.size(), [&](size_t begin, size_t end, size_t) {
+            int tape[2 * block];
+            size_t count;
+            int lo, hi;
+            for (size_t b=begin; b<end; b+=count) {
+                opponents(b, end, count, lo, hi);
+                Randomizer::fillInts(tape, 2 * count, lo, hi);
+
+                for (size_t t=0; t<count; t++) {
+                    int iA = tape[2*t];
+                    int iB = tape[2*t + 1];
+
+                    if (crowded_better(r.rank[iA], r.crowding[iA], r.rank[iB], r.crowding[iB]))  parents[b + t] = ParentIndex(iA);
+                    else                                                                           parents[b + t] = ParentIndex(iB);
+                }
+            }
+        });
+        return p.size();
     }
 
-    return hp;
+    parallel_for(pool, parents.size(), [&](size_t begin, size_t end, size_t) {
+        int tape[2 * block];
+        size_t count;
+        int lo, hi;
+        for (size_t b=begin; b<end; b+=count) {
+            opponents(b, end, count, lo, hi);
+            if (!fitness && p.tile() && (b == begin || b % window == 0)) {
+                p.advise(PlacedBuffer::Advice::WillNeed, size_t(lo), size_t(hi - lo + 1)); // les agents sont évalués
+            }
+            Randomizer::fillInts(tape, 2 * count, lo, hi);
+
+            for (size_t t=0; t<count; t++) {
+                // on prend 2 indices :
+                int iA = tape[2*t];
+                int iB = tape[2*t + 1];
+
+                // on prend le meilleur des 2 agents
+                float evalA = fitness ? float(fitness[iA]) : float(eval_agent(p[iA], domain));
+                float evalB = fitness ? float(fitness[iB]) : float(eval_agent(p[iB], domain));
+
+                if(evalA > evalB)   parents[b + t] = ParentIndex(iA);
+                else                parents[b + t] = ParentIndex(iB);
+            }
+        }
+    });
+
+    return fitness ? 0 : 2 * parents.size();
 
     // ===== Dans le cas où on souhaite garder le meilleur agent =====//
 
     if(!best_has_been_selectionned) {
         // on veut au moins garder le meilleur.
         // On choisi quelqu'un a remplacer au hasard
-        //hp[Randomizer::getInt(0, HalfPopulationSize - 1)] = p[best_indice];
+        //parents[Randomizer::getInt(0, HalfPopulationSize - 1)] = best_indice;
     }
 }
 
-// Fonction helper générique pour crossover au niveau des bits
-template<typename GetterFunc, typename SetterFunc>
-static void bit_level_crossover(
-    const Agent& p1, const Agent& p2,
-    Agent& child1, Agent& child2,
-    size_t num_elements, size_t element_size_bits,
-    GetterFunc getter, SetterFunc setter)
-{
-    size_t indice_decoupe = Randomizer::getInt(0, num_elements * element_size_bits - 1);
-    size_t k = indice_decoupe / element_size_bits;
-    size_t k_prime = indice_decoupe % element_size_bits;
-    
-    // Recopier les éléments avant le k-ième
-    for (size_t i = 0; i < k; i++) {
-        setter(child1, i, getter(p1, i));
-        setter(child2, i, getter(p2, i));
-    }
-    
-    // Traiter l'élément k (celui qui est coupé)
-    if (k < num_elements) {
-        integer e1 = getter(p1, k);
-        integer e2 = getter(p2, k);
-        
-        integer mask1 = (integer(1) << k_prime) - 1;  // Bits [0, k_prime-1]
-        integer mask2 = ~mask1;                        // Bits [k_prime, Nb_bin-1]
-        
-        setter(child1, k, (e1 & mask1) | (e2 & mask2));
-        setter(child2, k, (e2 & mask1) | (e1 & mask2));
-    }
-    
-    // Recopier les éléments après le k-ième (de l'autre parent)
-    for (size_t i = k + 1; i < num_elements; i++) {
-        setter(child1, i, getter(p2, i));
-        setter(child2, i, getter(p1, i));
-    }
-}
-
-// Fonction cross_over simplifiée
+// Fonction cross_over : un point de coupure par chromosome, appliqué directement sur les gènes compactés
 std::pair<Agent, Agent> cross_over(const Agent& p1, const Agent& p2) {
     Agent child1{};
     Agent child2{};
-    
-    // ========== CROSSOVER DES CHROMOSOMES DE DONNÉES ==========
-    for (size_t chromo = 0; chromo < NumberOfVectors; chromo++) {
-        // Lambdas pour accéder aux gènes du chromosome 'chromo'
-        auto getter = [chromo](const Agent& agent, size_t gene_idx) -> integer {
-            return agent.getGene(chromo, gene_idx);
-        };
-        
-        auto setter = [chromo](Agent& agent, size_t gene_idx, integer value) {
-            agent.setGene(chromo, gene_idx, value);
-        };
-        
-        bit_level_crossover(p1, p2, child1, child2, 
-                           Dimension, Nb_bin, 
-                           getter, setter);
-    }
-    
-    // ========== CROSSOVER DU CHROMOSOME DES PROBAS ==========
-    auto getter_proba = [](const Agent& agent, size_t idx) -> integer {
-        return agent.getMutationProba(idx);
-    };
-    
-    auto setter_proba = [](Agent& agent, size_t idx, integer value) {
-        agent.setMutationProba(idx, value);
-    };
-    
-    bit_level_crossover(p1, p2, child1, child2,
-                       NumberOfVectors + 1, Nb_bin,
-                       getter_proba, setter_proba);
-    
+    cross_over(p1, p2, child1, child2);
     return std::pair<Agent, Agent>(child1, child2);
 }
 
-Population cross_over_half_pop (HalfPopulation& hp) {
-    Population res {};
-
-    // on veut générer une liste de couples aléatoirement :
-    // on mélange la population, puis on prend tout les i et i+1
-    Randomizer::shuffle(hp);
-
-    size_t cur = 0;
-    for (size_t i=0; i<HalfPopulationSize; i+=2) {
-        // on sélectionne les deux parents i et i+1 :
-        res[cur] = hp[i];
-        cur++;
+void cross_over(const Agent& p1, const Agent& p2, Agent& child1, Agent& child2, Crossover op) {
+    if (op == Crossover::Uniform) {
+        Agent::crossUniform(p1, p2, child1, child2);
+        return;
+    }
+    // ========== CROSSOVER DES CHROMOSOMES DE DONNÉES PUIS DU CHROMOSOME DES PROBAS ==========
+    for (size_t chromo = 0; chromo < NumberOfVectors + 1; chromo++) {
+        const int bits = int(Agent::chromosomeBits(chromo));
+        size_t cut = Randomizer::getInt(0, bits - 1);
+        if (op == Crossover::OnePoint) {
+            Agent::crossChromosome(p1, p2, child1, child2, chromo, cut);
+        } else {
+            size_t second = Randomizer::getInt(0, bits - 1);
+            if (second < cut) std::swap(cut, second);
+            Agent::crossChromosome(p1, p2, child1, child2, chromo, cut, second);
+        }
+    }
+}
 
-        res[cur] = hp[i+1];
-        cur++;
+std::string to_string(Crossover op) {
+    switch (op) {
+        case Crossover::OnePoint: return "one-point";
+        case Crossover::TwoPoint: return "two-point";
+        case Crossover::Uniform:  return "uniform";
+    }
+    return "?";
+}
 
-        // on ajoute les enfants
-        auto [child1, child2] = cross_over(hp[i], hp[i+1]);
-        res[cur] = child1;
-        cur++;
+std::string to_string(Mutation op) {
+    return op == Mutation::Creep ? "creep" : "bit-flip";
+}
 
-        res[cur] = child2;
-        cur++;
+void cross_over_half_pop (const Population& p, std::span<ParentIndex> parents, Population& res, ThreadPool* pool,
+                          const std::function<void(size_t, size_t)>& finish, std::span<const uint8_t> crossovers) {
+    // on veut générer une liste de couples aléatoirement :
+    // on mélange les indices des parents, puis on prend tout les i et i+1
+    // population sur disque : le mélange reste dans chaque tuile, les couples d'une tuile y ont été sélectionnés
+    const size_t window = p.tile() ? p.tile() / 2 : parents.size();
+    for (size_t first = 0; first < parents.size(); first += window) {
+        Randomizer::shuffle(parents.begin() + first, parents.begin() + std::min(first + window, parents.size()));
     }
 
-    return res;
+    // le couple k (parents 2k et 2k+1) produit les agents 4k à 4k+3 : les couples sont indépendants.
+    // Chaque parent est lu une fois, les enfants sont écrits directement à leur place dans la génération suivante
+    const size_t couples = parents.size() / 2;
+    parallel_for(pool, couples, [&](size_t begin, size_t end, size_t) {
+        size_t tile = begin; // le premier couple de la tuile en cours
+        for (size_t k=begin; k<end; k++) {
+            if (p.tile() && (k == begin || (2*k) % window == 0)) {
+                // les parents de la tuile sont lus dans le désordre : on la demande au disque d'un bloc
+                size_t first = (2*k) / window * p.tile();
+                p.advise(PlacedBuffer::Advice::WillNeed, first, std::min(p.tile(), p.size() - first));
+            }
+            const Agent& a = p[parents[2*k]];
+            const Agent& b = p[parents[2*k + 1]];
+            size_t cur = 4*k;
+
+            // on garde les deux parents, puis on ajoute leurs enfants
+            res[cur]   = a;
+            res[cur+1] = b;
+            cross_over(a, b, res[cur+2], res[cur+3], crossovers.empty() ? Crossover::OnePoint : Crossover(crossovers[k]));
+
+            if (finish && (k + 1 - tile == FusedTile || k + 1 == end)) {
+                finish(4*tile, 4*(k + 1 - tile));
+                tile = k + 1;
+            }
+        }
+    });
+
+    // taille impaire : le dernier parent, resté seul, est gardé et croisé avec le premier pour donner un enfant
+    if (parents.size() % 2 == 1) {
+        const Agent& a = p[parents.back()];
+        Agent unused = a; // le second enfant n'est pas gardé : une copie évite des tirages aléatoires inutiles
+        res[4*couples] = a;
+        cross_over(a, p[parents[0]], res[4*couples + 1], unused,
+                   crossovers.empty() ? Crossover::OnePoint : Crossover(crossovers[couples]));
+        if (finish) finish(4*couples, 2);
+    }
 }
 
 
 // on modifie directement la population --> pointeur
-void mutations (Population* p) {
-    for (auto& agent : *p) {
-        agent.Mutate();
-    }
+void mutations (Population* p, ThreadPool* pool, std::span<const uint8_t> operators) {
+    parallel_for(pool, p->size(), [p, operators](size_t begin, size_t end, size_t) {
+        for (size_t i=begin; i<end; i++) {
+            if (operators.empty()) (*p)[i].Mutate();
+            else                   mutate((*p)[i], Mutation(operators[i]));
+        }
+    });
 }
 
 
-// on modifie directement la population --> pointeur
-void create_generation (size_t indice, Population* p, bool is_saving_in_file) {
-    HalfPopulation hp = selection_tournoi(*p);
-    *p = cross_over_half_pop(hp);
-
-    //std::cout << "je suis venu ici\n";
-    mutations(p);
-
-    if (is_saving_in_file) {
-        fs::path gen = ".";
-        gen /= directory;
-        gen /= std::string("generation_") + std::to_string(indice);
-        gen /= std::string("population") + std::string(extension_generations);
-        // Crée uniquement les dossiers parents
-        if (fs::create_directories(gen.parent_path())) {
-            std::cout << "Structure de dossiers '" << gen.parent_path() << "' créée." << std::endl;
+
+size_t local_search (Population& p, real* fitness, size_t elite, size_t budget, const CandidateEvaluator& evaluate,
+                     real* sums) {
+    constexpr size_t coords = NumberOfVectors * Dimension;
+    const real resolution = real_size / real(bin_max); // l'écart entre deux gènes consécutifs
+
+    elite = std::min(elite, p.size());
+    if (elite == 0 || budget == 0) return 0;
+
+    // les indices des agents d'élite
+    std::vector<size_t> order(p.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::partial_sort(order.begin(), order.begin() + elite, order.end(),
+                      [fitness](size_t a, size_t b) { return fitness[a] > fitness[b]; });
+    order.resize(elite);
+
+    // l'état de la recherche de chaque agent d'élite
+    std::vector<real>   step(elite, real_size / 64);  // le pas courant
+    std::vector<size_t> coord(elite, 0);               // la coordonnée essayée
+    std::vector<size_t> failures(elite, 0);            // les essais infructueux depuis la dernière amélioration
+    std::vector<size_t> spent(elite, 0);               // les évaluations réellement faites
+
+    // un lot par tour : au plus deux candidats (+pas et -pas) par agent d'élite
+    Population candidates(2 * elite);
+    std::vector<size_t> owner;      // l'agent d'élite (dans order) de chaque candidat
+    std::vector<size_t> reference;  // et son indice dans p
+    std::vector<real> values, candidate_sums;
+    owner.reserve(2 * elite);
+    reference.reserve(2 * elite);
+
+    size_t evaluations = 0;
+    for (;;) {
+        owner.clear();
+        reference.clear();
+
+        for (size_t e = 0; e < elite; e++) {
+            if (step[e] < resolution || spent[e] >= budget) continue; // convergé ou budget épuisé
+
+            const Agent& a = p[order[e]];
+            size_t i = coord[e] / Dimension;
+            size_t j = coord[e] % Dimension;
+            real x = a.getPhenotype()[i][j];
+            integer current = a.getChromosome(i)[j];
+
+            // seuls les candidats poussés sont comptés ; s'il ne reste qu'une évaluation, seul +pas est essayé
+            for (real delta : { step[e], -step[e] }) {
+                if (spent[e] == budget) break;
+                integer moved = real_to_bin(x + delta);
+                if (moved == current) continue; // bord du domaine : le gène ne bouge pas
+                Agent* c = new (&candidates[owner.size()]) Agent(a);
+                c->setGene(i, j, moved);
+                owner.push_back(e);
+                reference.push_back(order[e]);
+                spent[e]++;
+            }
+
+            if (owner.empty() || owner.back() != e) {
+                // aucun candidat possible sur cette coordonnée : on passe à la suivante
+                coord[e] = (coord[e] + 1) % coords;
+                if (++failures[e] == coords) { step[e] /= 2; failures[e] = 0; }
+            }
+        }
+
+        bool active = false;
+        for (size_t e = 0; e < elite; e++) active |= step[e] >= resolution && spent[e] < budget;
+        if (owner.empty()) {
+            if (!active) break;
+            continue;
         }
 
-        std::ofstream file (gen);
-        if (!file.is_open()) {
-            throw "cannot open file!\n";
+        const size_t n = owner.size();
+        candidates.resize(n);
+        values.assign(n, std::numeric_limits<real>::quiet_NaN()); // un candidat laissé par une interruption reste à NaN
+        candidate_sums.assign(n, std::numeric_limits<real>::quiet_NaN());
+        const size_t evaluated = evaluate(candidates, reference, values.data(), candidate_sums.data());
+        evaluations += evaluated;
+
+        // chaque agent garde son meilleur candidat évalué s'il s'améliore
+        for (size_t c = 0; c < n; ) {
+            size_t e = owner[c];
+            size_t best = c;
+            size_t next = c + 1;
+            while (next < n && owner[next] == e) {
+                if (std::isnan(values[best]) || values[next] > values[best]) best = next;
+                next++;
+            }
+
+            size_t idx = order[e];
+            if (values[best] > fitness[idx]) {
+                p[idx] = candidates[best];
+                fitness[idx] = values[best];
+                if (sums) sums[idx] = candidate_sums[best];
+                failures[e] = 0; // on insiste dans la même direction
+            } else {
+                coord[e] = (coord[e] + 1) % coords;
+                if (++failures[e] == coords) { step[e] /= 2; failures[e] = 0; }
+            }
+            c = next;
         }
 
-        // on sauvegarde chaque individus sur une ligne
-        // on pense à ajouter une ligne de paramètresau début du fichier
+        if (evaluated < n) break; // interrompue : les améliorations déjà trouvées sont gardées
     }
+
+    return evaluations;
+}
+
+size_t local_search (Population& p, real* fitness, size_t elite, size_t budget, const Domain& domain, ThreadPool* pool) {
+    return local_search(p, fitness, elite, budget,
+                        [&](const Population& candidates, std::span<const size_t>, real* values, real*) {
+        std::vector<size_t> indices(candidates.size());
+        std::iota(indices.begin(), indices.end(), size_t(0));
+        parallel_for(pool, indices.size(), [&](size_t begin, size_t end, size_t) {
+            for (size_t k = begin; k < end; k += fx::block) {
+                const size_t n = std::min(fx::block, end - k);
+                eval_agents(candidates, { indices.data() + k, n }, domain, values + k);
+            }
+        });
+        return candidates.size();
+    });
 }
 
 
 
-void print_best_agent(const Population& p) {
+size_t best_agent_index(const Population& p, const Domain& domain, real* best_eval) {
     size_t best_indice = 0;
-    real best_eval = eval_agent(p[best_indice]);
-    for(size_t i = 1; i < PopulationSize; i++) {
-        real eval = eval_agent(p[i]);
-        if (eval > best_eval) {
-            best_eval = eval;
+    real best = eval_agent(p[best_indice], domain);
+    for(size_t i = 1; i < p.size(); i++) {
+        real eval = eval_agent(p[i], domain);
+        if (eval > best) {
+            best = eval;
             best_indice = i;
         }
     }
 
-    std::cout << "best :\n" << p[best_indice];
-    std::cout << "\nfitness : " << eval_agent(p[best_indice]);
+    if (best_eval) *best_eval = best;
+    return best_indice;
+}
+
+void print_vectors(std::ostream& os, const Agent& a, const Domain& domain) {
+    print_vectors(os, phenotype_in(a, domain));
+}
+
+void print_vectors(std::ostream& os, const Agent::phenotype& vecteurs) {
+    for (size_t i=0; i<NumberOfVectors; i++) {
+        os << vecteurs[i];
+        if (i < NumberOfVectors - 1) os << '\n';
+    }
+}
+
+void print_best_agent(const Population& p, const Domain& domain, std::ostream& os) {
+    if constexpr (NumberOfObjectives > 1) {
+        ParetoRanking r = rank_population(p, domain, nullptr);
+        size_t front_size = std::count(r.rank.begin(), r.rank.end(), size_t(0));
+        os << "front de Pareto : " << front_size << " agents";
+
+        for (size_t k=0; k<NumberOfObjectives; k++) {
+            size_t best = 0;
+            for (size_t i=1; i<p.size(); i++) {
+                if (r.objectives[i][k] > r.objectives[best][k]) best = i;
+            }
+            os << "\nmeilleur sur l'objectif " << k << " :\n";
+            print_vectors(os, p[best], domain);
+            os << "\nobjectifs :";
+            for (real o : r.objectives[best]) os << ' ' << o;
+        }
+        return;
+    }
+
+    real best_eval = 0;
+    size_t best_indice = best_agent_index(p, domain, &best_eval);
+
+    os << "best :\n";
+    print_vectors(os, p[best_indice], domain);
+    os << "\nfitness : " << best_eval;
 }
 
 
 
 void genetic_algorithm () {
-    Population generation {};
-    for (size_t step = 1; step<maxGen + 1; step++) {
-        create_generation(step, &generation, false);
-        std::cout << "step : " << step  << "/" << maxGen << '\n';
-        print_best_agent(generation);
+    // GENETIC_ALGORITHM=genetic|de|cmaes : l'algorithme d'optimisation, sans recompiler
+    Parameters params;
+    if (const char* name = std::getenv("GENETIC_ALGORITHM"); name && *name) params.algorithm = parse_algorithm(name);
+    // GENETIC_BENCHMARK=rastrigin[:dimension] : une fonction de test standard (benchmarks.h) sur son intervalle
+    if (const char* name = std::getenv("GENETIC_BENCHMARK"); name && *name) {
+        const std::string text = name;
+        const size_t colon = text.find(':');
+        params.domain.benchmark = parse_benchmark(text.substr(0, colon));
+        if (colon != std::string::npos) params.domain.benchmark_dims = std::stoul(text.substr(colon + 1));
+        benchmark_interval(params.domain.benchmark, params.domain.min, params.domain.max);
+    }
+    std::unique_ptr<Optimizer> engine = make_optimizer(params);
+    GeneticEngine* genetic = dynamic_cast<GeneticEngine*>(engine.get()); // nullptr pour DE et CMA-ES
+
+    // Ctrl-C ou SIGTERM : le run s'arrête proprement, avec son meilleur agent et une sauvegarde finale
+    install_stop_handlers();
+
+    // GENETIC_METRICS=/chemin/de/socket (ou tcp:port) : les métriques du run sont lisibles pendant qu'il tourne
+    std::unique_ptr<MetricsServer> server;
+    if (const char* address = std::getenv("GENETIC_METRICS"); address && *address) {
+        server = std::make_unique<MetricsServer>(address);
+        server->watch(engine->metrics());
+        std::cout << "métriques Prometheus servies sur " << server->address() << '\n';
+    }
+
+    engine->init();
+
+    if (genetic) {
+        ThreadPool::global().printPlacement(std::cout, genetic->population().size(), genetic->population().buffer());
+    } else {
+        std::cout << "algorithme : " << to_string(params.algorithm) << '\n';
+    }
+    std::cout << '\n';
+
+    const size_t last = engine->parameters().max_gen;
+    while (!engine->finished()) {
+        const size_t previous = engine->generation();
+        engine->step();
+        if (engine->generation() == previous) break; // arrêté avant la fin de la génération
+
+        std::cout << "step : " << engine->generation() << "/" << last << '\n';
+        engine->printBest(std::cout);
+
+        if (genetic) {
+            const DiversityMetrics& d = genetic->diversityMetrics();
+            std::cout << "\ndiversité : hamming moyen " << d.mean_hamming << " bits (" << 100 * d.mean_hamming_ratio
+                      << " %), doublons " << 100 * d.duplicate_ratio << " %";
+        }
+        if (genetic && params.operator_policy != OperatorPolicy::Fixed) {
+            // la part des enfants que le bandit a confiée à chaque opérateur pour cette génération
+            std::cout << "\nopérateurs :";
+            std::span<const real> c = genetic->crossoverOperators().shares();
+            for (size_t k = 0; k < c.size(); k++) std::cout << ' ' << to_string(Crossover(k)) << ' ' << 100 * c[k] << " %";
+            std::cout << " ;";
+            std::span<const real> m = genetic->mutationOperators().shares();
+            for (size_t k = 0; k < m.size(); k++) std::cout << ' ' << to_string(Mutation(k)) << ' ' << 100 * m[k] << " %";
+        }
 
         std::cout << "\n\n<><><><><><><><><><><><><><><><><><><><><><><><><><>\n\n";
     }
 
-    // on veut afficher le meilleur élément de cette génération
-    print_best_agent(generation); std::cout << std::endl;
-}
\ No newline at end of file
+    switch (engine->stopReason()) {
+    case StopReason::Converged:
+        if (genetic) std::cout << "arrêt : la population a convergé (diversité sous le seuil)\n\n";
+        else         std::cout << "arrêt : la distribution a convergé (pas ou conditionnement à la limite)\n\n";
+        break;
+    case StopReason::Deadline:
+    case StopReason::Evaluations:
+    case StopReason::Signal:
+        std::cout << "arrêt anticipé (" << to_string(engine->stopReason()) << ") à la génération " << engine->generation()
+                  << " après " << engine->evaluations() << " évaluations\n";
+        engine->saveCheckpoint(std::string(directory) + "/final");
+        std::cout << "sauvegarde finale dans " << directory << "/final\n\n";
+        break;
+    default:
+        break;
+    }
+
+    if constexpr (NumberOfObjectives > 1) {
+        engine->printBest(std::cout); std::cout << std::endl;
+    } else {
+        // on veut afficher le meilleur élément du run, quelle que soit sa génération
+        Solution b = engine->bestSolution();
+        if (!b.found) {
+            std::cout << "aucun agent évalué" << std::endl;
+            return;
+        }
+        std::cout << "meilleur agent du run (génération " << b.generation << ", " << engine->evaluations()
+                  << " évaluations) :\n";
+        print_vectors(std::cout, b.vectors);
+        std::cout << "\nfitness : " << b.fitness << std::endl;
+    }
+}
@@ -0,0 +1,360 @@
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "genetic_c.h"
+#include "engine.h"
+#include "optimizer.h"
+#include "stop.h"
+
+
+// l'interface C expose directement les tampons du moteur : les types doivent coïncider
+static_assert(std::is_same_v<real, double>,      "the C interface exposes reals as double");
+static_assert(std::is_same_v<integer, uint32_t>, "the C interface exposes genes as uint32_t");
+
+
+
+struct genetic_engine {
+    std::unique_ptr<ThreadPool> pool;   // pool privé (threads > 1), sinon nul
+    std::unique_ptr<Optimizer> engine;
+    GeneticEngine* genetic;             // le même moteur s'il s'agit de l'AG, sinon nul
+    bool initialized = false;
+    mutable std::vector<real> best;     // les coordonnées rendues par genetic_best_so_far (DE, CMA-ES, et l'AG sans CachePhenotype)
+    mutable std::vector<real> coordinates; // les coordonnées décodées par genetic_coordinates sans CachePhenotype
+    std::unique_ptr<MetricsServer> server;  // détruit en premier : il lit le pool et le moteur
+
+    genetic_engine(const Parameters& params, std::unique_ptr<ThreadPool> own, ThreadPool* used)
+        : pool(std::move(own)), engine(make_optimizer(params, used)),
+          genetic(dynamic_cast<GeneticEngine*>(engine.get())) {}
+};
+
+
+static thread_local std::string last_error;
+
+// exécute f en convertissant toute exception en code d'erreur
+template <typename F>
+static int guarded(F&& f) {
+    try {
+        f();
+        last_error.clear();
+        return 0;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+    } catch (...) {
+        last_error = "erreur inconnue";
+    }
+    return -1;
+}
+
+static void require_init(const genetic_engine* e) {
+    if (!e) throw std::invalid_argument("moteur nul");
+    if (!e->initialized) throw std::logic_error("genetic_init n'a pas été appelé");
+}
+
+// les vues sur la population n'existent qu'avec l'AG
+static GeneticEngine& require_genetic(const genetic_engine* e) {
+    require_init(e);
+    if (!e->genetic) throw std::logic_error("disponible uniquement avec l'algorithme génétique");
+    return *e->genetic;
+}
+
+static void require_agent(const genetic_engine* e, size_t agent) {
+    if (agent >= require_genetic(e).population().size()) throw std::out_of_range("indice d'agent hors de la population");
+}
+
+
+
+
+// ==================================================================================================================
+// Cycle de vie
+// ==================================================================================================================
+
+extern "C" void genetic_default_params(genetic_params* params) {
+    if (!params) return;
+
+    Parameters p;
+    params->half_population_size   = p.half_population_size;
+    params->max_gen                = p.max_gen;
+    params->initial_mutation_proba = p.initial_mutation_proba;
+    params->min_real               = p.domain.min;
+    params->max_real               = p.domain.max;
+    params->seed                   = p.seed;
+    params->threads                = 0;
+    params->memetic_elite          = p.memetic_elite;
+    params->memetic_budget         = p.memetic_budget;
+    params->population_policy      = int(p.size_policy);
+    params->min_half_population_size = p.min_half_population_size;
+    params->min_hamming_ratio      = p.min_hamming_ratio;
+    params->surrogate_keep         = p.surrogate_keep;
+    params->surrogate_exploration  = p.surrogate_exploration;
+    params->time_limit             = p.time_limit;
+    params->max_evaluations        = p.max_evaluations;
+    params->storage                = PopulationStorage;
+    params->algorithm              = int(p.algorithm);
+    params->continuous_population  = p.continuous_population;
+    params->de_weight              = p.de_weight;
+    params->de_crossover           = p.de_crossover;
+    params->initialization         = int(p.initialization);
+    params->benchmark              = int(p.domain.benchmark);
+    params->benchmark_dims         = p.domain.benchmark_dims;
+    params->fused_generation       = int(p.fused_generation);
+    params->map_cells              = p.map_cells;
+    params->operator_policy        = int(p.operator_policy);
+}
+
+extern "C" genetic_engine* genetic_create(const genetic_params* params) {
+    genetic_engine* res = nullptr;
+    guarded([&] {
+        if (!params) throw std::invalid_argument("paramètres nuls");
+
+        Parameters p;
+        p.half_population_size   = params->half_population_size;
+        p.max_gen                = params->max_gen;
+        p.initial_mutation_proba = params->initial_mutation_proba;
+        p.domain.min             = params->min_real;
+        p.domain.max             = params->max_real;
+        p.seed                   = params->seed;
+        p.memetic_elite          = params->memetic_elite;
+        p.memetic_budget         = params->memetic_budget;
+        p.min_half_population_size = params->min_half_population_size;
+        p.min_hamming_ratio      = params->min_hamming_ratio;
+        p.surrogate_keep         = params->surrogate_keep;
+        p.surrogate_exploration  = params->surrogate_exploration;
+        p.time_limit             = real(params->time_limit);
+        p.max_evaluations        = params->max_evaluations;
+        p.storage                = params->storage ? params->storage : "";
+        if (params->population_policy < 0 || params->population_policy > 2) {
+            throw std::invalid_argument("population_policy doit valoir 0, 1 ou 2");
+        }
+        p.size_policy = PopulationPolicy(params->population_policy);
+        if (params->algorithm < 0 || params->algorithm > 3) {
+            throw std::invalid_argument("algorithm doit valoir 0, 1, 2 ou 3");
+        }
+        p.algorithm             = Algorithm(params->algorithm);
+        p.continuous_population = params->continuous_population;
+        p.de_weight             = real(params->de_weight);
+        p.de_crossover          = real(params->de_crossover);
+        if (params->initialization < 0 || params->initialization > 2) {
+            throw std::invalid_argument("initialization doit valoir 0, 1 ou 2");
+        }
+        p.initialization        = Initialization(params->initialization);
+        if (params->benchmark < 0 || params->benchmark >= int(BenchmarkCount)) {
+            throw std::invalid_argument("benchmark doit valoir de 0 à 6");
+        }
+        p.domain.benchmark      = Benchmark(params->benchmark);
+        p.domain.benchmark_dims = params->benchmark_dims;
+        p.fused_generation      = params->fused_generation != 0;
+        p.map_cells             = params->map_cells;
+        if (params->operator_policy < 0 || params->operator_policy > 2) {
+            throw std::invalid_argument("operator_policy doit valoir 0, 1 ou 2");
+        }
+        p.operator_policy       = OperatorPolicy(params->operator_policy);
+
+        std::unique_ptr<ThreadPool> own;
+        ThreadPool* used = nullptr;
+        if (params->threads == 0) {
+            used = &ThreadPool::global();
+        } else if (params->threads > 1) {
+            own  = std::make_unique<ThreadPool>(params->threads, affinity_policy);
+            used = own.get();
+        }
+        res = new genetic_engine(p, std::move(own), used);
+    });
+    return res;
+}
+
+extern "C" void genetic_destroy(genetic_engine* engine) {
+    delete engine;
+}
+
+extern "C" int genetic_init(genetic_engine* engine) {
+    return guarded([&] {
+        if (!engine) throw std::invalid_argument("moteur nul");
+        engine->engine->init();
+        engine->initialized = true;
+    });
+}
+
+extern "C" int genetic_step(genetic_engine* engine, size_t n) {
+    return guarded([&] {
+        require_init(engine);
+        engine->engine->step(n);
+    });
+}
+
+
+
+
+// ==================================================================================================================
+// État du run
+// ==================================================================================================================
+
+extern "C" int genetic_finished(const genetic_engine* engine) {
+    return engine && engine->engine->finished() ? 1 : 0;
+}
+
+extern "C" int genetic_stop_reason(const genetic_engine* engine) {
+    return engine ? int(engine->engine->stopReason()) : 0;
+}
+
+extern "C" void genetic_request_stop(void) {
+    request_stop();
+}
+
+extern "C" void genetic_clear_stop(void) {
+    clear_stop_request();
+}
+
+extern "C" size_t genetic_generation(const genetic_engine* engine) {
+    return engine ? engine->engine->generation() : 0;
+}
+
+extern "C" size_t genetic_evaluations(const genetic_engine* engine) {
+    return engine ? engine->engine->evaluations() : 0;
+}
+
+extern "C" size_t genetic_population_size(const genetic_engine* engine) {
+    return engine && engine->initialized ? engine->engine->populationSize() : 0;
+}
+
+extern "C" uint64_t genetic_seed(const genetic_engine* engine) {
+    return engine ? engine->engine->parameters().seed : 0;
+}
+
+
+
+
+// ==================================================================================================================
+// Vues sur la population
+// ==================================================================================================================
+
+extern "C" int genetic_diversity(genetic_engine* engine, double* mean_hamming_ratio, double* duplicate_ratio) {
+    return guarded([&] {
+        const DiversityMetrics& d = require_genetic(engine).diversityMetrics();
+        if (mean_hamming_ratio) *mean_hamming_ratio = d.mean_hamming_ratio;
+        if (duplicate_ratio)    *duplicate_ratio = d.duplicate_ratio;
+    });
+}
+
+extern "C" int genetic_metrics_listen(genetic_engine* engine, const char* address) {
+    return guarded([&] {
+        if (!engine) throw std::invalid_argument("moteur nul");
+        if (!address) throw std::invalid_argument("adresse nulle");
+        engine->server.reset(); // libère l'adresse avant d'en ouvrir une autre
+        engine->server = std::make_unique<MetricsServer>(address);
+        engine->server->watch(engine->engine->metrics());
+    });
+}
+
+extern "C" int genetic_best(genetic_engine* engine, size_t* index, double* fitness) {
+    return guarded([&] {
+        BestAgent b = require_genetic(engine).best();
+        if (index)   *index = b.index;
+        if (fitness) *fitness = b.fitness;
+    });
+}
+
+extern "C" const double* genetic_best_so_far(const genetic_engine* engine, double* fitness, size_t* generation, size_t* count) {
+    const double* res = nullptr;
+    guarded([&] {
+        if (!engine) throw std::invalid_argument("moteur nul");
+        if (engine->genetic) {
+            BestAgent b = engine->genetic->bestSoFar();
+            if (!b.agent) return;
+            if (fitness)    *fitness = b.fitness;
+            if (generation) *generation = b.generation;
+            if constexpr (CachePhenotype) {
+                if (count) *count = b.agent->coordinates().size();
+                res = b.agent->coordinates().data();
+            } else {
+                const auto c = b.agent->coordinates();
+                engine->best.assign(c.begin(), c.end());
+                if (count) *count = engine->best.size();
+                res = engine->best.data();
+            }
+            return;
+        }
+
+        // DE et CMA-ES travaillent dans le domaine : le point est ramené dans l'intervalle canonique, comme un agent
+        Solution s = engine->engine->bestSolution();
+        if (!s.found) return;
+        const Domain& d = engine->engine->parameters().domain;
+        engine->best.clear();
+        for (const auto& v : s.vectors) {
+            for (size_t j = 0; j < Dimension; j++) engine->best.push_back(d.toCanonical(v[j]));
+        }
+        if (fitness)    *fitness = s.fitness;
+        if (generation) *generation = s.generation;
+        if (count)      *count = engine->best.size();
+        res = engine->best.data();
+    });
+    return res;
+}
+
+extern "C" int genetic_checkpoint(const genetic_engine* engine, const char* folder) {
+    return guarded([&] {
+        require_init(engine);
+        if (!folder) throw std::invalid_argument("dossier nul");
+        engine->engine->saveCheckpoint(folder);
+    });
+}
+
+extern "C" const double* genetic_fitness(genetic_engine* engine, size_t* count) {
+    const double* res = nullptr;
+    guarded([&] {
+        std::span<const real> f = require_genetic(engine).fitness();
+        if (count) *count = f.size();
+        res = f.data();
+    });
+    return res;
+}
+
+extern "C" const uint32_t* genetic_genes(const genetic_engine* engine, size_t agent, size_t* word_count) {
+    const uint32_t* res = nullptr;
+    guarded([&] {
+        require_agent(engine, agent);
+        std::span<const integer> words = engine->genetic->agents()[agent].packedGenes();
+        if (word_count) *word_count = words.size();
+        res = words.data();
+    });
+    return res;
+}
+
+extern "C" const double* genetic_coordinates(const genetic_engine* engine, size_t agent, size_t* count) {
+    const double* res = nullptr;
+    guarded([&] {
+        require_agent(engine, agent);
+        const auto coords = engine->genetic->agents()[agent].coordinates();
+        if constexpr (CachePhenotype) {
+            res = coords.data();
+        } else {
+            engine->coordinates.assign(coords.begin(), coords.end()); // décodées à la demande : gardées par le handle
+            res = engine->coordinates.data();
+        }
+        if (count) *count = coords.size();
+    });
+    return res;
+}
+
+
+
+
+// ==================================================================================================================
+// Forme d'un agent
+// ==================================================================================================================
+
+extern "C" size_t genetic_vectors(void)   { return NumberOfVectors; }
+extern "C" size_t genetic_dimension(void) { return Dimension; }
+extern "C" size_t genetic_gene_bits(void) { return Nb_bin; }
+
+extern "C" void genetic_canonical_domain(double* min, double* max) {
+    if (min) *min = min_real;
+    if (max) *max = max_real;
+}
+
+extern "C" const char* genetic_last_error(void) {
+    return last_error.c_str();
+}
@@ -0,0 +1,266 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "expression.h"
+#include "kernels.h"
+#include "utils.h"
+
+
+// les variantes compilées dans ce binaire (kernels_*.cpp)
+namespace kernels_scalar { extern const KernelTable table; }
+#if defined(GENETIC_KERNELS_X86)
+namespace kernels_avx2   { extern const KernelTable table; }
+namespace kernels_avx512 { extern const KernelTable table; }
+#endif
+
+
+
+
+// ==================================================================================================================
+// Détection du processeur
+// ==================================================================================================================
+
+static bool cpu_supports(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return true;
+#if defined(GENETIC_KERNELS_X86)
+    // __builtin_cpu_supports vérifie aussi que le système sauvegarde les registres étendus (XGETBV)
+    case Isa::Avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+            && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt");
+    case Isa::Avx512:
+        return cpu_supports(Isa::Avx2)
+            && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+            && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+    default:
+        return false;
+    }
+}
+
+const KernelTable* kernel_variant(Isa isa) {
+    if (!cpu_supports(isa)) return nullptr;
+
+    switch (isa) {
+    case Isa::Scalar: return &kernels_scalar::table;
+#if defined(GENETIC_KERNELS_X86)
+    case Isa::Avx2:   return &kernels_avx2::table;
+    case Isa::Avx512: return &kernels_avx512::table;
+#endif
+    default:          return nullptr;
+    }
+}
+
+static const char* isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar: return "scalar";
+    case Isa::Avx2:   return "avx2";
+    case Isa::Avx512: return "avx512";
+    }
+    return "?";
+}
+
+// de la plus rapide à la plus lente
+static constexpr Isa preference[] = { Isa::Avx512, Isa::Avx2, Isa::Scalar };
+
+const KernelTable* kernel_variant(const char* name) {
+    for (Isa isa : preference) {
+        const KernelTable* t = kernel_variant(isa);
+        if (t && std::strcmp(t->name, name) == 0) return t;
+    }
+    return nullptr;
+}
+
+static const KernelTable& select_kernels() {
+    const KernelTable* best = nullptr;
+    for (Isa isa : preference) {
+        if ((best = kernel_variant(isa))) break;
+    }
+
+    const char* forced = std::getenv("GENETIC_ISA");
+    if (forced && *forced) {
+        if (const KernelTable* t = kernel_variant(forced)) {
+            std::clog << "noyaux de calcul : " << t->name << " (imposé par GENETIC_ISA)" << std::endl;
+            return *t;
+        }
+        std::clog << "GENETIC_ISA=" << forced << " n'est pas disponible sur ce processeur, repli sur "
+                  << best->name << std::endl;
+        return *best;
+    }
+
+    std::clog << "noyaux de calcul : " << best->name << std::endl;
+    return *best;
+}
+
+const KernelTable& kernels() {
+    static const KernelTable& selected = select_kernels();
+    return selected;
+}
+
+
+
+
+// ==================================================================================================================
+// Vérification croisée des variantes
+// ==================================================================================================================
+
+// des entrées dont le résultat est connu d'avance, sur assez de mots pour passer par les boucles vectorielles et
+// leurs restes : décodage des bornes, comptage de bits, distance de Hamming (les bits inversés à la main sont ceux
+// que hamming compte) et masque de croisement (splice d'un parent nul et d'un parent plein)
+static size_t known_answer_failures(const KernelTable& t) {
+    constexpr size_t n = 67;
+    constexpr size_t bits = sizeof(integer) * 8;
+    size_t failures = 0;
+
+    // décodage : 0 et bin_max donnent exactement les bornes du domaine
+    std::vector<integer> genes(n);
+    std::vector<real> decoded(n);
+    for (size_t k = 0; k < n; k++) genes[k] = k % 2 ? integer(bin_max) : integer(0);
+    t.decode_genes(genes.data(), n, decoded.data());
+    for (size_t k = 0; k < n; k++) failures += decoded[k] != (k % 2 ? max_real : min_real);
+
+    // comptage : des mots pleins, puis un seul bit par mot
+    const std::vector<integer> zeros(n, integer(0)), ones(n, integer(~integer(0)));
+    std::vector<integer> single(n);
+    for (size_t k = 0; k < n; k++) single[k] = integer(integer(1) << (k % bits));
+    failures += t.popcount(ones.data(), n) != n * bits;
+    failures += t.popcount(single.data(), n) != n;
+    failures += t.popcount(zeros.data(), n) != 0;
+
+    // distance de Hamming : un bit inversé par xor dans un mot sur trois, puis tous les bits
+    std::vector<integer> mutated = genes;
+    size_t flipped = 0;
+    for (size_t k = 0; k < n; k += 3, flipped++) mutated[k] ^= integer(integer(1) << (k % bits));
+    failures += t.hamming(genes.data(), mutated.data(), n) != flipped;
+    failures += t.hamming(zeros.data(), ones.data(), n) != n * bits;
+    failures += t.hamming(genes.data(), genes.data(), n) != 0;
+
+    // masque de croisement : dans [first, last), c1 reçoit les 0 de a avant cut et les 1 de b ensuite ; c2 l'inverse
+    const size_t first = 5, cut = 70, last = 2000;
+    std::vector<integer> c1(n, integer(0x5A5A5A5A)), c2(n, integer(0xA5A5A5A5));
+    const std::vector<integer> o1 = c1, o2 = c2;
+    t.splice(zeros.data(), ones.data(), c1.data(), c2.data(), first, cut, last);
+    for (size_t i = 0; i < n * bits; i++) {
+        const bool inside = i >= first && i < last;
+        const size_t e1 = inside ? i >= cut : (o1[i / bits] >> (i % bits)) & 1;
+        const size_t e2 = inside ? i < cut  : (o2[i / bits] >> (i % bits)) & 1;
+        failures += ((c1[i / bits] >> (i % bits)) & 1) != e1 || ((c2[i / bits] >> (i % bits)) & 1) != e2;
+    }
+    return failures;
+}
+
+bool kernels_self_check(std::ostream& os, const KernelTable* only) {
+    const KernelTable& ref = kernels_scalar::table;
+    std::mt19937_64 rng(12345);
+
+    // des tailles qui couvrent les boucles vectorielles et leurs restes
+    constexpr size_t max_n = 131;
+    std::vector<integer> a(max_n), b(max_n);
+    for (size_t k = 0; k < max_n; k++) {
+        a[k] = integer(rng());
+        b[k] = integer(rng());
+    }
+    a[0] = 0; a[1] = integer(bin_max); // les bornes du décodage
+
+    std::vector<real> in(max_n);
+    ref.decode_genes(a.data(), max_n, in.data());
+
+    // la variante scalaire elle-même, comparée aux définitions élémentaires
+    bool all_ok = true;
+    {
+        size_t failures = 0;
+        uint64_t ones = 0, diff = 0;
+        for (size_t k = 0; k < max_n; k++) {
+            failures += in[k] != bin_to_real(a[k]);
+            for (size_t bit = 0; bit < sizeof(integer) * 8; bit++) {
+                ones += (a[k] >> bit) & 1;
+                diff += ((a[k] ^ b[k]) >> bit) & 1;
+            }
+        }
+        failures += ref.popcount(a.data(), max_n) != ones;
+        failures += ref.hamming(a.data(), b.data(), max_n) != diff;
+
+        // croisement : bit à bit
+        const size_t bits = sizeof(integer) * 8;
+        auto bit_of = [bits](const std::vector<integer>& v, size_t i) { return (v[i / bits] >> (i % bits)) & 1; };
+        std::vector<integer> c1(max_n, integer(0x5A5A5A5A)), c2(max_n, integer(0xA5A5A5A5));
+        const std::vector<integer> o1 = c1, o2 = c2;
+        const size_t first = 37, cut = 1000, last = 3001;
+        ref.splice(a.data(), b.data(), c1.data(), c2.data(), first, cut, last);
+        for (size_t i = 0; i < max_n * bits; i++) {
+            bool inside = i >= first && i < last;
+            size_t e1 = !inside ? bit_of(o1, i) : (i < cut ? bit_of(a, i) : bit_of(b, i));
+            size_t e2 = !inside ? bit_of(o2, i) : (i < cut ? bit_of(b, i) : bit_of(a, i));
+            failures += bit_of(c1, i) != e1 || bit_of(c2, i) != e2;
+        }
+
+        failures += known_answer_failures(ref);
+        os << "  scalar (définitions) : " << (failures == 0 ? "ok" : "ERREUR") << '\n';
+        all_ok &= failures == 0;
+    }
+
+    for (Isa isa : preference) {
+        const KernelTable* t = kernel_variant(isa);
+        if (only && t != only) continue; // une seule variante à vérifier : les autres ne sont pas citées
+        if (!t) {
+            os << "  " << isa_name(isa) << " : non disponible\n";
+            continue;
+        }
+
+        size_t failures = known_answer_failures(*t);
+        for (size_t n = 0; n <= max_n; n++) {
+            std::vector<real> r1(n), r2(n);
+            ref.decode_genes(a.data(), n, r1.data());
+            t->decode_genes(a.data(), n, r2.data());
+            failures += std::memcmp(r1.data(), r2.data(), n * sizeof(real)) != 0;
+
+            ref.remap(in.data(), n, min_real, real(0.37), real(-5), r1.data());
+            t->remap(in.data(), n, min_real, real(0.37), real(-5), r2.data());
+            failures += std::memcmp(r1.data(), r2.data(), n * sizeof(real)) != 0;
+
+            failures += ref.popcount(a.data(), n) != t->popcount(a.data(), n);
+            failures += ref.hamming(a.data(), b.data(), n) != t->hamming(a.data(), b.data(), n);
+        }
+
+        // fitness par blocs : les coordonnées décodées, réparties sur les agents du bloc
+        for (size_t count = 0; count <= fx::block; count++) {
+            real coords[fx::coordinate_count * fx::block];
+            for (size_t k = 0; k < fx::coordinate_count * fx::block; k++) coords[k] = in[k % max_n];
+            real f1[fx::block] = {}, f2[fx::block] = {};
+            ref.fitness_block(coords, count, f1);
+            t->fitness_block(coords, count, f2);
+            failures += std::memcmp(f1, f2, sizeof(f1)) != 0;
+
+            // un agent seul donne la même valeur que sa voie du bloc
+            for (size_t l = 0; l < count; l++) {
+                real agent[fx::coordinate_count];
+                for (size_t k = 0; k < fx::coordinate_count; k++) agent[k] = coords[k * fx::block + l];
+                real g1 = ref.fitness_agent(agent), g2 = t->fitness_agent(agent);
+                failures += std::memcmp(&g1, &f1[l], sizeof(real)) != 0 || std::memcmp(&g2, &f1[l], sizeof(real)) != 0;
+            }
+        }
+
+        const size_t total_bits = max_n * sizeof(integer) * 8;
+        for (size_t trial = 0; trial < 2000; trial++) {
+            size_t p[3] = { size_t(rng() % (total_bits + 1)), size_t(rng() % (total_bits + 1)), size_t(rng() % (total_bits + 1)) };
+            if (p[0] > p[1]) std::swap(p[0], p[1]);
+            if (p[1] > p[2]) std::swap(p[1], p[2]);
+            if (p[0] > p[1]) std::swap(p[0], p[1]);
+
+            std::vector<integer> c1(max_n, integer(0x5A5A5A5A)), c2(max_n, integer(0xA5A5A5A5));
+            std::vector<integer> d1 = c1, d2 = c2;
+            ref.splice(a.data(), b.data(), c1.data(), c2.data(), p[0], p[1], p[2]);
+            t->splice(a.data(), b.data(), d1.data(), d2.data(), p[0], p[1], p[2]);
+            failures += c1 != d1 || c2 != d2;
+        }
+
+        os << "  " << t->name << " : " << (failures == 0 ? "ok" : "ERREUR") << '\n';
+        all_ok &= failures == 0;
+    }
+    return all_ok;
+}
@@ -0,0 +1,5 @@
+// variante avx2 des noyaux de calcul (voir kernels.h et CMakeLists.txt pour les options de compilation)
+#define KERNEL_NAMESPACE kernels_avx2
+#define KERNEL_ISA Isa::Avx2
+#define KERNEL_NAME "avx2"
+#include "kernels_impl.h"
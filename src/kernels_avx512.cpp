@@ -0,0 +1,5 @@
+// variante avx512 des noyaux de calcul (voir kernels.h et CMakeLists.txt pour les options de compilation)
+#define KERNEL_NAMESPACE kernels_avx512
+#define KERNEL_ISA Isa::Avx512
+#define KERNEL_NAME "avx512"
+#include "kernels_impl.h"
@@ -0,0 +1,5 @@
+// variante scalar des noyaux de calcul (voir kernels.h et CMakeLists.txt pour les options de compilation)
+#define KERNEL_NAMESPACE kernels_scalar
+#define KERNEL_ISA Isa::Scalar
+#define KERNEL_NAME "scalar"
+#include "kernels_impl.h"
@@ -79,10 +79,27 @@ Bibliographie :
 
 
 #include "genetic.h"
+#include "kernels.h"
 #include "randomizer.h"
+#include <cstdlib>
 #include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    // genetic --check-kernels : compare à la variante scalaire toutes les variantes des noyaux de calcul disponibles
+    // sur ce processeur, ou seulement celle qu'impose GENETIC_ISA
+    if (argc > 1 && std::string(argv[1]) == "--check-kernels") {
+        // une variante imposée que ce processeur n'a pas : rien à vérifier (77, le code des tests sautés par CTest)
+        const char* forced = std::getenv("GENETIC_ISA");
+        const KernelTable* only = forced && *forced ? kernel_variant(forced) : nullptr;
+        if (forced && *forced && !only) {
+            std::cout << "GENETIC_ISA=" << forced << " : variante non disponible, vérification sautée\n";
+            return 77;
+        }
+        std::cout << "variante utilisée : " << kernels().name << '\n';
+        return kernels_self_check(std::cout, only) ? 0 : 1;
+    }
 
-int main(int argc, char* argv) {
     Randomizer::Init();
     genetic_algorithm();
 
@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "map_elites.h"
+#include "randomizer.h"
+
+
+namespace fs = std::filesystem;
+
+static_assert((MapElitesHashCapacity & (MapElitesHashCapacity - 1)) == 0, "MapElitesHashCapacity doit être une puissance de 2");
+static_assert(MapElitesHashCapacity < uint32_t(-1) && MapElitesDenseCells < uint32_t(-1), "les emplacements sont numérotés sur 32 bits");
+
+
+
+
+// ==================================================================================================================
+// Archive
+// ==================================================================================================================
+
+EliteArchive::EliteArchive(size_t cells_per_dim) : m_cells_per_dim(cells_per_dim) {
+    // Parameters::validate garantit que la grille tient sur 64 bits
+    m_cells = 1;
+    for (size_t k = 0; k < DescriptorDims; k++) m_cells *= cells_per_dim;
+    m_hashed = m_cells > MapElitesDenseCells;
+    m_capacity = m_hashed ? MapElitesHashCapacity : size_t(m_cells);
+
+    m_agents.resize(m_capacity);
+    m_fitness.assign(m_capacity, std::numeric_limits<real>::quiet_NaN());
+    m_descriptors.assign(m_capacity, Descriptor{});
+    m_stamps.assign(m_capacity, 0);
+    m_claims = std::make_unique<std::atomic<uint32_t>[]>(m_capacity);
+    for (size_t s = 0; s < m_capacity; s++) m_claims[s].store(free_claim, std::memory_order_relaxed);
+    if (m_hashed) {
+        m_keys = std::make_unique<std::atomic<uint64_t>[]>(m_capacity);
+        for (size_t s = 0; s < m_capacity; s++) m_keys[s].store(empty_key, std::memory_order_relaxed);
+    }
+    m_occupied.reserve(m_capacity);
+}
+
+uint64_t EliteArchive::cellOf(const Descriptor& d) const {
+    uint64_t cell = 0;
+    for (size_t k = DescriptorDims; k-- > 0; ) {
+        // eval_descriptor ramène chaque caractéristique dans [0, 1] : 1 tombe dans la dernière case
+        const size_t c = std::min(m_cells_per_dim - 1, size_t(d[k] * real(m_cells_per_dim)));
+        cell = cell * m_cells_per_dim + c;
+    }
+    return cell;
+}
+
+size_t EliteArchive::slotOf(uint64_t cell) {
+    if (!m_hashed) return size_t(cell);
+
+    // adressage ouvert, sondage linéaire ; un emplacement libre est pris par compare-and-swap
+    uint64_t h = cell * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+    const size_t mask = m_capacity - 1;
+    size_t slot = size_t(h) & mask;
+    for (size_t probe = 0; probe < m_capacity; probe++, slot = (slot + 1) & mask) {
+        uint64_t key = m_keys[slot].load(std::memory_order_relaxed);
+        if (key == empty_key && m_keys[slot].compare_exchange_strong(key, cell, std::memory_order_relaxed)) return slot;
+        if (key == cell) return slot; // la case est déjà là, ou un autre candidat vient de la créer
+    }
+    return size_t(-1);
+}
+
+size_t EliteArchive::insert(std::span<const Agent> agents, std::span<const real> fitness,
+                            std::span<const Descriptor> descriptors, size_t stamp, ThreadPool* pool) {
+    const size_t n = agents.size();
+    constexpr auto relaxed = std::memory_order_relaxed;
+    m_slots.assign(n, size_t(-1));
+    m_fresh.assign(n, 0);
+
+    // le candidat a bat le candidat b : meilleure fitness, puis plus petit indice (indépendant de l'ordonnancement)
+    auto beats = [&fitness](size_t a, size_t b) { return fitness[a] > fitness[b] || (fitness[a] == fitness[b] && a < b); };
+
+    // 1. chaque candidat qui bat l'élite en place revendique sa case ; il y reste s'il bat aussi tous les autres
+    std::atomic<size_t> full { 0 };
+    parallel_for(pool, n, [&](size_t begin, size_t end, size_t) {
+        for (size_t k = begin; k < end; k++) {
+            if (std::isnan(fitness[k])) continue;
+            const size_t slot = slotOf(cellOf(descriptors[k]));
+            if (slot == size_t(-1)) {
+                full.fetch_add(1, relaxed);
+                continue;
+            }
+            m_slots[k] = slot;
+            if (!std::isnan(m_fitness[slot]) && !(fitness[k] > m_fitness[slot])) continue;
+
+            std::atomic<uint32_t>& claim = m_claims[slot];
+            uint32_t current = claim.load(relaxed);
+            while (current == free_claim || beats(k, current)) {
+                if (claim.compare_exchange_weak(current, uint32_t(k), relaxed)) break;
+            }
+        }
+    });
+
+    // 2. chaque vainqueur s'installe dans sa case et la libère pour le lot suivant
+    std::vector<size_t> done(pool ? pool->size() : 1, 0);
+    parallel_for(pool, n, [&](size_t begin, size_t end, size_t w) {
+        size_t count = 0;
+        for (size_t k = begin; k < end; k++) {
+            const size_t slot = m_slots[k];
+            if (slot == size_t(-1) || m_claims[slot].load(relaxed) != uint32_t(k)) continue;
+            m_fresh[k] = std::isnan(m_fitness[slot]);
+            m_agents[slot] = agents[k];
+            m_fitness[slot] = fitness[k];
+            m_descriptors[slot] = descriptors[k];
+            m_stamps[slot] = stamp;
+            m_claims[slot].store(free_claim, relaxed);
+            count++;
+        }
+        done[w] = count;
+    });
+
+    // les nouvelles cases, dans l'ordre du lot : le tirage des parents reste reproductible
+    for (size_t k = 0; k < n; k++) {
+        if (m_fresh[k]) m_occupied.push_back(uint32_t(m_slots[k]));
+    }
+    m_dropped += full.load();
+
+    size_t improved = 0;
+    for (size_t c : done) improved += c;
+    return improved;
+}
+
+size_t EliteArchive::sample() const {
+    return m_occupied[Randomizer::bounded(m_occupied.size())];
+}
+
+size_t EliteArchive::memory() const {
+    return m_capacity * (sizeof(Agent) + sizeof(real) + sizeof(Descriptor) + sizeof(size_t) + sizeof(std::atomic<uint32_t>)
+                         + (m_hashed ? sizeof(std::atomic<uint64_t>) : 0))
+         + m_occupied.capacity() * sizeof(uint32_t)
+         + m_slots.capacity() * sizeof(size_t) + m_fresh.capacity();
+}
+
+void EliteArchive::writeChanges(std::ostream& os, size_t since, const Domain& domain) const {
+    for (uint32_t slot : m_occupied) {
+        if (m_stamps[slot] < since) continue;
+        os << m_stamps[slot] << ',' << cell(slot) << ',' << m_fitness[slot];
+        for (real x : m_descriptors[slot]) os << ',' << x;
+        const Agent::phenotype v = phenotype_in(m_agents[slot], domain);
+        for (const auto& vector : v) {
+            for (size_t j = 0; j < vector.size(); j++) os << ',' << vector[j];
+        }
+        os << '\n';
+    }
+}
+
+
+
+
+// ==================================================================================================================
+// Moteur
+// ==================================================================================================================
+
+MapElites::MapElites(const Parameters& params, ThreadPool* pool)
+    : Optimizer(params, pool) {}
+
+void MapElites::init() {
+    beginRun();
+    m_best = Solution{};
+    m_snapshot = 0;
+
+    const size_t n = m_params.populationSize();
+    m_archive = EliteArchive(m_params.map_cells);
+    m_batch = Population(n);
+    m_plan.assign(n, 0);
+    m_points.assign(n, Agent::phenotype{});
+    m_values.assign(n, std::numeric_limits<real>::quiet_NaN());
+    m_descriptors.assign(n, Descriptor{});
+
+    // la génération 0 : des agents répartis dans le domaine selon Parameters::initialization
+    populate(m_batch, m_params.initial_mutation_proba, m_pool, 0, m_params.initialization);
+
+    const auto start = std::chrono::steady_clock::now();
+    const size_t done = evaluateAndInsert(std::min(n, evaluationsLeft()), 0);
+    m_evaluations += done;
+    interrupted();
+    publishMetrics(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), done);
+}
+
+void MapElites::step(size_t n) {
+    using clock = std::chrono::steady_clock;
+    EngineMetrics& metrics = *m_metrics;
+    const size_t size = m_batch.size();
+
+    for (size_t k = 0; k < n && !finished(); k++) {
+        if (interrupted()) break;
+        if (m_archive.size() == 0) {
+            m_stop = StopReason::Evaluations; // aucun agent évalué : pas de parents
+            break;
+        }
+        const clock::time_point start = clock::now();
+        clock::time_point last = start;
+        auto lap = [&](Stage s) {
+            clock::time_point now = clock::now();
+            metrics.addStage(s, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+            last = now;
+        };
+
+        // les parents : deux élites tirées au hasard par couple, sur le thread appelant
+        for (uint32_t& slot : m_plan) slot = uint32_t(m_archive.sample());
+        lap(Stage::Selection);
+
+        // chaque couple donne deux enfants, mutés aussitôt
+        const EliteArchive& archive = m_archive;
+        parallel_for(m_pool, size / 2, [&](size_t begin, size_t end, size_t) {
+            for (size_t c = begin; c < end; c++) {
+                Agent& a = m_batch[2*c];
+                Agent& b = m_batch[2*c + 1];
+                cross_over(archive.elite(m_plan[2*c]), archive.elite(m_plan[2*c + 1]), a, b);
+                a.Mutate();
+                b.Mutate();
+            }
+        });
+        lap(Stage::Crossover);
+
+        const size_t evaluations = m_evaluations;
+        const size_t done = evaluateAndInsert(std::min(size, evaluationsLeft()), m_generation + 1);
+        m_evaluations += done;
+        lap(Stage::Selection);
+
+        // une génération interrompue n'est pas comptée, mais ses élites sont gardées : l'archive reste valide
+        if (done == size) m_generation++;
+        if constexpr (save) {
+            if (done == size && m_generation % save_interval == 0) {
+                appendSnapshot((fs::path(".") / directory / "archive.csv").string());
+            }
+        }
+        interrupted();
+        publishMetrics(std::chrono::duration<double>(clock::now() - start).count(), m_evaluations - evaluations);
+        if (done < size) break;
+    }
+}
+
+size_t MapElites::evaluateAndInsert(size_t count, size_t stamp) {
+    const Domain& domain = m_params.domain;
+    const Population& batch = m_batch;
+    Agent::phenotype* points = m_points.data();
+    parallel_for(m_pool, count, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) points[i] = phenotype_in(batch[i], domain);
+    });
+
+    const size_t done = evaluateVectors(std::span(m_points).first(count), m_values.data());
+
+    Descriptor* descriptors = m_descriptors.data();
+    const real* values = m_values.data();
+    parallel_for(m_pool, count, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            if (!std::isnan(values[i])) descriptors[i] = eval_descriptor(points[i], domain);
+        }
+    });
+
+    m_archive.insert({ batch.data(), count }, { values, count }, { descriptors, count }, stamp, m_pool);
+
+    for (size_t i = 0; i < count; i++) {
+        if (std::isnan(values[i]) || (m_best.found && !(values[i] > m_best.fitness))) continue;
+        m_best.found = true;
+        m_best.fitness = values[i];
+        m_best.generation = m_generation;
+        m_best.vectors = points[i];
+    }
+    return done;
+}
+
+void MapElites::publishMetrics(double seconds, size_t evaluations) {
+    // la fitness publiée est celle des élites de l'archive
+    real best = std::numeric_limits<real>::quiet_NaN(), mean = best;
+    real sum = 0;
+    for (uint32_t slot : m_archive.occupied()) {
+        const real f = m_archive.fitness(slot);
+        if (std::isnan(best) || f > best) best = f;
+        sum += f;
+    }
+    if (m_archive.size() > 0) mean = sum / real(m_archive.size());
+    publish(seconds, evaluations, best, mean, m_archive.size(),
+            m_archive.memory() + m_batch.buffer().bytes() + m_plan.capacity() * sizeof(uint32_t)
+            + m_points.capacity() * sizeof(Agent::phenotype) + m_values.capacity() * sizeof(real)
+            + m_descriptors.capacity() * sizeof(Descriptor));
+}
+
+void MapElites::printBest(std::ostream& os) {
+    size_t best = size_t(-1);
+    for (uint32_t slot : m_archive.occupied()) {
+        if (best == size_t(-1) || m_archive.fitness(slot) > m_archive.fitness(best)) best = slot;
+    }
+    if (best == size_t(-1)) {
+        os << "aucun agent évalué" << std::endl;
+        return;
+    }
+    os << "Meilleure élite :" << std::endl;
+    print_vectors(os, m_archive.elite(best), m_params.domain);
+    os << "\nfitness : " << m_archive.fitness(best) << std::endl;
+    os << "cases occupées : " << m_archive.size() << " / " << m_archive.cells();
+    if (m_archive.dropped() > 0) os << " (" << m_archive.dropped() << " candidats écartés, archive pleine)";
+    os << std::endl;
+}
+
+void MapElites::saveCheckpoint(const std::string& folder) const {
+    fs::path dir = folder;
+    fs::create_directories(dir);
+
+    fs::path gen = dir / (std::string("population") + std::string(extension_generations));
+    std::ofstream file (gen);
+    if (!file.is_open()) {
+        throw std::runtime_error("impossible d'écrire " + gen.string());
+    }
+
+    // une ligne de paramètres, puis chaque élite sur une ligne
+    file << std::setprecision(std::numeric_limits<real>::max_digits10)
+         << "seed " << m_params.seed << " generation " << m_generation << " evaluations " << m_evaluations
+         << " algorithm " << to_string(m_params.algorithm) << " cells " << m_params.map_cells
+         << " occupied " << m_archive.size() << " dropped " << m_archive.dropped()
+         << " min_real " << m_params.domain.min << " max_real " << m_params.domain.max
+         << " stop " << to_string(stopReason()) << '\n';
+    m_archive.writeChanges(file, 0, m_params.domain);
+
+    write_solution(folder, m_best);
+}
+
+void MapElites::appendSnapshot(const std::string& path) {
+    const fs::path file_path = path;
+    if (file_path.has_parent_path()) fs::create_directories(file_path.parent_path());
+
+    // le premier appel du run recommence le fichier
+    std::ofstream file (file_path, m_snapshot == 0 ? std::ios::trunc : std::ios::app);
+    if (!file.is_open()) {
+        throw std::runtime_error("impossible d'écrire " + path);
+    }
+    file << std::setprecision(std::numeric_limits<real>::max_digits10);
+    if (m_snapshot == 0) {
+        file << "stamp,cell,fitness";
+        for (size_t k = 0; k < DescriptorDims; k++) file << ",d" << k;
+        for (size_t k = 0; k < NumberOfVectors * Dimension; k++) file << ",x" << k;
+        file << '\n';
+    }
+    m_archive.writeChanges(file, m_snapshot, m_params.domain);
+    m_snapshot = m_generation + 1;
+}
@@ -0,0 +1,239 @@
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define GENETIC_METRICS_SOCKETS 1
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS
+#endif
+#endif
+
+#include "metrics.h"
+
+
+
+
+// ==================================================================================================================
+// Format d'exposition
+// ==================================================================================================================
+
+const char* to_string(Stage s) {
+    switch (s) {
+        case Stage::Selection: return "selection";
+        case Stage::Crossover: return "crossover";
+        case Stage::Mutation:  return "mutation";
+        case Stage::Resize:    return "resize";
+        case Stage::Surrogate: return "surrogate";
+        case Stage::Memetic:   return "memetic";
+        default:               return "diversity";
+    }
+}
+
+// la mémoire résidente du processus, 0 si inconnue
+static uint64_t resident_bytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    uint64_t pages = 0, resident = 0;
+    if (statm >> pages >> resident) return resident * uint64_t(sysconf(_SC_PAGESIZE));
+#endif
+    return 0;
+}
+
+static void write_value(std::ostream& os, double v) {
+    if (std::isnan(v))      os << "NaN";
+    else if (std::isinf(v)) os << (v > 0 ? "+Inf" : "-Inf");
+    else                    os << v;
+}
+
+void write_prometheus(std::ostream& os, const std::vector<std::pair<std::string, std::shared_ptr<EngineMetrics>>>& runs) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    os << std::setprecision(17);
+
+    // une famille de métriques : son en-tête, puis un échantillon par moteur
+    auto family = [&](const char* name, const char* type, const char* help, auto value) {
+        os << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+        for (const auto& [run, m] : runs) {
+            os << name << "{run=\"" << run << "\"} ";
+            write_value(os, double(value(*m)));
+            os << '\n';
+        }
+    };
+
+    family("genetic_generation", "gauge", "Current generation of the run.",
+           [&](const EngineMetrics& m) { return m.generation.load(relaxed); });
+    family("genetic_evaluations_total", "counter", "Fitness evaluations since the start of the run.",
+           [&](const EngineMetrics& m) { return m.evaluations.load(relaxed); });
+    family("genetic_evaluations_per_second", "gauge", "Fitness evaluations per second over the last generation.",
+           [&](const EngineMetrics& m) { return m.evaluations_per_second.load(relaxed); });
+    family("genetic_best_fitness", "gauge", "Best fitness of the current generation.",
+           [&](const EngineMetrics& m) { return m.best_fitness.load(relaxed); });
+    family("genetic_mean_fitness", "gauge", "Mean fitness of the current generation.",
+           [&](const EngineMetrics& m) { return m.mean_fitness.load(relaxed); });
+    family("genetic_population_size", "gauge", "Number of agents of the current generation.",
+           [&](const EngineMetrics& m) { return m.population.load(relaxed); });
+    family("genetic_memory_bytes", "gauge", "Memory reserved by the engine.",
+           [&](const EngineMetrics& m) { return m.memory_bytes.load(relaxed); });
+    family("genetic_pool_workers", "gauge", "Worker threads of the engine's pool (0 = serial).",
+           [&](const EngineMetrics& m) { return m.pool ? m.pool->size() : 0; });
+    family("genetic_pool_busy_workers", "gauge", "Workers still running the current parallel job.",
+           [&](const EngineMetrics& m) { return m.pool ? m.pool->busy() : 0; });
+
+    os << "# HELP genetic_stage_seconds_total Time spent in each stage of the generations.\n"
+          "# TYPE genetic_stage_seconds_total counter\n";
+    for (const auto& [run, m] : runs) {
+        for (size_t s = 0; s < StageCount; s++) {
+            os << "genetic_stage_seconds_total{run=\"" << run << "\",stage=\"" << to_string(Stage(s)) << "\"} ";
+            write_value(os, double(m->stage_nanoseconds[s].load(relaxed)) * 1e-9);
+            os << '\n';
+        }
+    }
+
+    os << "# HELP genetic_process_resident_bytes Resident memory of the process.\n"
+          "# TYPE genetic_process_resident_bytes gauge\n"
+          "genetic_process_resident_bytes " << resident_bytes() << '\n';
+}
+
+
+
+
+// ==================================================================================================================
+// Serveur
+// ==================================================================================================================
+
+#if defined(GENETIC_METRICS_SOCKETS)
+
+static std::runtime_error socket_error(const std::string& what) {
+    return std::runtime_error("serveur de métriques : " + what + " (" + std::strerror(errno) + ")");
+}
+
+MetricsServer::MetricsServer(const std::string& address) : m_address(address) {
+    if (address.rfind("tcp:", 0) == 0) {
+        int port = 0;
+        try {
+            port = std::stoi(address.substr(4));
+        } catch (const std::exception&) {
+            port = -1;
+        }
+        if (port < 0 || port > 65535) throw std::runtime_error("serveur de métriques : port invalide '" + address + "'");
+
+        m_listen = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listen < 0) throw socket_error("socket");
+        int yes = 1;
+        ::setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(uint16_t(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // jamais exposé hors de la machine
+        if (::bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(m_listen);
+            throw socket_error("impossible d'écouter sur " + address);
+        }
+    } else {
+        m_socket_path = address.rfind("unix:", 0) == 0 ? address.substr(5) : address;
+
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        if (m_socket_path.empty() || m_socket_path.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("serveur de métriques : chemin de socket invalide '" + m_socket_path + "'");
+        }
+        std::memcpy(addr.sun_path, m_socket_path.c_str(), m_socket_path.size() + 1);
+
+        m_listen = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_listen < 0) throw socket_error("socket");
+        ::unlink(m_socket_path.c_str()); // une socket laissée par un run précédent
+        if (::bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(m_listen);
+            throw socket_error("impossible de créer " + m_socket_path);
+        }
+    }
+
+    if (::listen(m_listen, 16) < 0 || ::pipe(m_wake) < 0) {
+        ::close(m_listen);
+        if (!m_socket_path.empty()) ::unlink(m_socket_path.c_str());
+        throw socket_error("listen");
+    }
+
+    m_thread = std::thread([this] { serve(); });
+}
+
+MetricsServer::~MetricsServer() {
+    char c = 0;
+    if (::write(m_wake[1], &c, 1) < 0) {} // le thread se réveille et s'arrête
+    m_thread.join();
+
+    ::close(m_wake[0]);
+    ::close(m_wake[1]);
+    ::close(m_listen);
+    if (!m_socket_path.empty()) ::unlink(m_socket_path.c_str());
+}
+
+void MetricsServer::serve() {
+    for (;;) {
+        pollfd fds[2] = { { m_wake[0], POLLIN, 0 }, { m_listen, POLLIN, 0 } };
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[0].revents) return;
+        if (!(fds[1].revents & POLLIN)) continue;
+
+        int client = ::accept(m_listen, nullptr, nullptr);
+        if (client < 0) continue;
+
+        // un client HTTP envoie sa requête aussitôt ; un client brut (socat, nc) peut ne rien envoyer
+        char request[1024];
+        ssize_t got = 0;
+        pollfd in { client, POLLIN, 0 };
+        if (::poll(&in, 1, 100) > 0) got = ::recv(client, request, sizeof(request), 0);
+        bool http = got >= 4 && std::memcmp(request, "GET ", 4) == 0;
+
+        std::ostringstream body;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            write_prometheus(body, m_runs);
+        }
+        std::string text = body.str();
+        if (http) {
+            text = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                 + std::to_string(text.size()) + "\r\nConnection: close\r\n\r\n" + text;
+        }
+
+        for (size_t sent = 0; sent < text.size(); ) {
+            ssize_t n = ::send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += size_t(n);
+        }
+        ::close(client);
+    }
+}
+
+#else
+
+MetricsServer::MetricsServer(const std::string& address) : m_address(address) {
+    throw std::runtime_error("serveur de métriques : sockets POSIX indisponibles sur cette plateforme");
+}
+
+MetricsServer::~MetricsServer() = default;
+
+void MetricsServer::serve() {}
+
+#endif
+
+void MetricsServer::watch(std::shared_ptr<EngineMetrics> metrics, const std::string& run) {
+    metrics->watched.store(true, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_runs.emplace_back(run, std::move(metrics));
+}
@@ -0,0 +1,191 @@
+#include "multiobjective.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <numeric>
+
+
+
+
+// ==================================================================================================================
+// Outils
+// ==================================================================================================================
+
+// a domine b : a >= b sur tous les objectifs et a > b sur au moins un
+static bool dominates(const real* a, const real* b, size_t m) {
+    bool strictly = false;
+    for (size_t k = 0; k < m; k++) {
+        if (a[k] < b[k]) return false;
+        if (a[k] > b[k]) strictly = true;
+    }
+    return strictly;
+}
+
+static bool same_point(const real* a, const real* b, size_t m) {
+    return std::equal(a, a + m, b);
+}
+
+
+
+
+// ==================================================================================================================
+// Tri non dominé
+// ==================================================================================================================
+
+/*
+    Balayage pour m <= 3 objectifs.
+    On parcourt les points par ordre lexicographique décroissant : tout point déjà vu a un premier objectif >= à celui
+    du point courant p, donc p est dominé par un point déjà vu q si et seulement si q est >= p sur les objectifs 2 et 3
+    (et q != p, ce que garantit le regroupement des doublons).
+    Chaque front garde l'"escalier" de ses points maximaux dans le plan (objectif 2, objectif 3) : une map triée par
+    objectif 2 croissant, dont l'objectif 3 est alors décroissant. Savoir si un front domine p coûte un lower_bound.
+    Si le front k domine p, le front k-1 le domine aussi : le front de p se trouve par recherche dichotomique.
+*/
+static void sweep_sort(const real* obj, size_t n, size_t m, std::vector<size_t>& rank) {
+    auto row = [&](size_t i) { return obj + i * m; };
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::lexicographical_compare(row(b), row(b) + m, row(a), row(a) + m);
+    });
+
+    // objectif 2 et 3 (0 quand ils n'existent pas : les escaliers dégénèrent alors sans cas particulier)
+    auto y_of = [&](size_t i) { return m > 1 ? obj[i * m + 1] : real(0); };
+    auto z_of = [&](size_t i) { return m > 2 ? obj[i * m + 2] : real(0); };
+
+    std::vector<std::map<real, real>> fronts;
+    for (size_t pos = 0; pos < n; pos++) {
+        size_t i = order[pos];
+        if (pos > 0 && same_point(row(order[pos - 1]), row(i), m)) {
+            rank[i] = rank[order[pos - 1]]; // un doublon a le même rang que son jumeau
+            continue;
+        }
+
+        real y = y_of(i);
+        real z = z_of(i);
+        auto dominated_by = [&](const std::map<real, real>& front) {
+            auto it = front.lower_bound(y); // le point d'objectif 2 >= y ayant le plus grand objectif 3
+            return it != front.end() && it->second >= z;
+        };
+
+        size_t lo = 0, hi = fronts.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (dominated_by(fronts[mid])) lo = mid + 1;
+            else                           hi = mid;
+        }
+        if (lo == fronts.size()) fronts.emplace_back();
+
+        // on retire de l'escalier les points que p domine dans le plan (objectif 2, objectif 3)
+        auto& front = fronts[lo];
+        auto it = front.upper_bound(y);
+        while (it != front.begin()) {
+            auto prev = std::prev(it);
+            if (prev->second > z) break;
+            it = front.erase(prev);
+        }
+        front[y] = z;
+        rank[i] = lo;
+    }
+}
+
+/*
+    Tri rapide non dominé de Deb et al. (NSGA-II), en O(m N²) : utilisé au-delà de 3 objectifs.
+*/
+static void fast_sort(const real* obj, size_t n, size_t m, std::vector<size_t>& rank) {
+    std::vector<std::vector<size_t>> dominated(n); // dominated[i] = points dominés par i
+    std::vector<size_t> count(n, 0);               // count[i]     = nombre de points dominant i
+
+    for (size_t a = 0; a < n; a++) {
+        for (size_t b = a + 1; b < n; b++) {
+            if (dominates(obj + a * m, obj + b * m, m))      { dominated[a].push_back(b); count[b]++; }
+            else if (dominates(obj + b * m, obj + a * m, m)) { dominated[b].push_back(a); count[a]++; }
+        }
+    }
+
+    std::vector<size_t> current;
+    for (size_t i = 0; i < n; i++) {
+        if (count[i] == 0) { rank[i] = 0; current.push_back(i); }
+    }
+
+    for (size_t r = 1; !current.empty(); r++) {
+        std::vector<size_t> next;
+        for (size_t a : current) {
+            for (size_t b : dominated[a]) {
+                if (--count[b] == 0) { rank[b] = r; next.push_back(b); }
+            }
+        }
+        current.swap(next);
+    }
+}
+
+void non_dominated_sort(const real* objectives, size_t n, size_t m, std::vector<size_t>& rank) {
+    rank.assign(n, 0);
+    if (n == 0) return;
+
+    if (m <= 3) sweep_sort(objectives, n, m, rank);
+    else        fast_sort(objectives, n, m, rank);
+}
+
+
+
+
+// ==================================================================================================================
+// Distance de crowding
+// ==================================================================================================================
+
+void crowding_distance(const real* objectives, size_t n, size_t m,
+                       const std::vector<size_t>& rank, std::vector<real>& crowding)
+{
+    constexpr real infinity = std::numeric_limits<real>::infinity();
+    crowding.assign(n, 0);
+    if (n == 0) return;
+
+    // points regroupés par front (tri par dénombrement), puis bornes de chaque front
+    size_t nb_fronts = *std::max_element(rank.begin(), rank.end()) + 1;
+    std::vector<size_t> start(nb_fronts + 1, 0);
+    for (size_t i = 0; i < n; i++) start[rank[i] + 1]++;
+    std::partial_sum(start.begin(), start.end(), start.begin());
+
+    std::vector<size_t> by_front(n);
+    {
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < n; i++) by_front[fill[rank[i]]++] = i;
+    }
+
+    std::vector<size_t> idx(n);
+    std::vector<real> col(n);   // valeurs de l'objectif k dans l'ordre de idx
+    std::vector<real> gap(n);   // contribution de l'objectif k, dans l'ordre de idx
+
+    for (size_t k = 0; k < m; k++) {
+        idx = by_front;
+        for (size_t f = 0; f < nb_fronts; f++) {
+            std::sort(idx.begin() + start[f], idx.begin() + start[f + 1], [&](size_t a, size_t b) {
+                return objectives[a * m + k] < objectives[b * m + k];
+            });
+        }
+
+        for (size_t p = 0; p < n; p++) col[p] = objectives[idx[p] * m + k];
+
+        for (size_t f = 0; f < nb_fronts; f++) {
+            size_t first = start[f], last = start[f + 1]; // le front f occupe [first, last)
+            if (first == last) continue;
+
+            real range = col[last - 1] - col[first];
+            real inv = range > 0 ? real(1) / range : real(0);
+
+            // boucle sans dépendance ni branche : vectorisable
+            for (size_t p = first + 1; p + 1 < last; p++) {
+                gap[p] = (col[p + 1] - col[p - 1]) * inv;
+            }
+            for (size_t p = first + 1; p + 1 < last; p++) {
+                crowding[idx[p]] += gap[p];
+            }
+
+            crowding[idx[first]]    = infinity;
+            crowding[idx[last - 1]] = infinity;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "operators.h"
+#include "randomizer.h"
+
+
+
+OperatorBandit::OperatorBandit(OperatorPolicy policy, size_t arms)
+    : m_policy(policy), m_quality(arms, 0), m_share(arms, arms ? real(1) / real(arms) : 0),
+      m_pulls(arms, 0), m_gain(arms, 0), m_count(arms, 0)
+{
+    if (arms == 0 || arms > 255) throw std::invalid_argument("OperatorBandit: 1 to 255 operators");
+}
+
+
+void OperatorBandit::assign(std::span<uint8_t> out) {
+    const size_t k = arms();
+    if (m_policy == OperatorPolicy::Fixed || k == 1) {
+        std::fill(out.begin(), out.end(), uint8_t(0));
+        return;
+    }
+
+    if (m_policy == OperatorPolicy::AdaptivePursuit) {
+        // tirage selon les parts : les opérateurs sont peu nombreux, un parcours linéaire suffit
+        for (uint8_t& o : out) {
+            real u = Randomizer::getProb();
+            size_t a = 0;
+            while (a + 1 < k && u >= m_share[a]) u -= m_share[a++];
+            o = uint8_t(a);
+        }
+        return;
+    }
+
+    // Ucb : chaque enfant va à l'opérateur de plus grande borne supérieure, ses tirages comptés au fur et à mesure.
+    // Le logarithme est celui du total à la fin du lot : il varie à peine d'un enfant à l'autre, et un logarithme
+    // par enfant et par opérateur coûterait plus cher que tout le reste de la tenue des comptes
+    std::vector<size_t> given(k, 0);
+    real total = real(out.size());
+    for (real n : m_pulls) total += n;
+    const real exploration = OperatorExploration * OperatorExploration * 2 * std::log(total);
+    for (uint8_t& o : out) {
+        size_t best = 0;
+        real best_bound = -1;
+        for (size_t a = 0; a < k; a++) {
+            if (m_pulls[a] < 1) { best = a; break; } // jamais essayé (ou oublié) : il passe en premier
+            real bound = m_quality[a] + std::sqrt(exploration / m_pulls[a]);
+            if (bound > best_bound) { best = a; best_bound = bound; }
+        }
+        o = uint8_t(best);
+        m_pulls[best] += 1;
+        given[best]++;
+    }
+    if (!out.empty()) {
+        for (size_t a = 0; a < k; a++) m_share[a] = real(given[a]) / real(out.size());
+    }
+}
+
+
+void OperatorBandit::update() {
+    const size_t k = arms();
+    real best_mean = 0;
+    for (size_t a = 0; a < k; a++) {
+        if (m_count[a]) best_mean = std::max(best_mean, m_gain[a] / real(m_count[a]));
+    }
+    // récompense : l'amélioration moyenne relative à celle du meilleur opérateur ; sans enfant crédité, rien n'est appris
+    for (size_t a = 0; a < k; a++) {
+        if (m_count[a] == 0) continue;
+        real reward = best_mean > 0 ? m_gain[a] / real(m_count[a]) / best_mean : 0;
+        m_quality[a] += OperatorLearningRate * (reward - m_quality[a]);
+    }
+    std::fill(m_gain.begin(), m_gain.end(), real(0));
+    std::fill(m_count.begin(), m_count.end(), size_t(0));
+
+    if (m_policy == OperatorPolicy::Ucb) {
+        for (real& n : m_pulls) n *= 1 - OperatorLearningRate;
+    } else if (m_policy == OperatorPolicy::AdaptivePursuit) {
+        const size_t best = size_t(std::max_element(m_quality.begin(), m_quality.end()) - m_quality.begin());
+        const real p_min = std::min(OperatorMinShare, real(1) / real(k));
+        const real p_max = 1 - real(k - 1) * p_min;
+        for (size_t a = 0; a < k; a++) {
+            m_share[a] += OperatorPursuitRate * ((a == best ? p_max : p_min) - m_share[a]);
+        }
+    }
+}
@@ -0,0 +1,297 @@
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cmaes.h"
+#include "differential_evolution.h"
+#include "engine.h"
+#include "expression.h"
+#include "map_elites.h"
+#include "optimizer.h"
+#include "randomizer.h"
+#include "stop.h"
+
+
+namespace fs = std::filesystem;
+
+
+
+
+// ==================================================================================================================
+// Paramètres
+// ==================================================================================================================
+
+void Parameters::validate() const {
+    if (half_population_size < 1) {
+        throw std::invalid_argument("half_population_size doit être au moins égal à 1");
+    }
+    if (size_policy != PopulationPolicy::Fixed
+        && (min_half_population_size < 1 || min_half_population_size > half_population_size)) {
+        throw std::invalid_argument("min_half_population_size doit être compris entre 1 et half_population_size");
+    }
+    if (!(domain.max > domain.min)) {
+        throw std::invalid_argument("le domaine doit vérifier min_real < max_real");
+    }
+    if (!(initial_mutation_proba >= 0 && initial_mutation_proba <= 1)) {
+        throw std::invalid_argument("initial_mutation_proba doit être dans [0, 1]");
+    }
+    if (!(min_hamming_ratio >= 0 && min_hamming_ratio < 1)) {
+        throw std::invalid_argument("min_hamming_ratio doit être dans [0, 1[");
+    }
+    if (memetic_elite > populationSize()) {
+        throw std::invalid_argument("memetic_elite ne peut pas dépasser la taille de la population");
+    }
+    if (memetic_elite > 0 && NumberOfObjectives > 1) {
+        throw std::invalid_argument("le mode mémétique n'est disponible qu'avec un seul objectif");
+    }
+    if (!(surrogate_keep > 0 && surrogate_keep <= 1)) {
+        throw std::invalid_argument("surrogate_keep doit être dans ]0, 1]");
+    }
+    if (!(surrogate_exploration >= 0 && surrogate_exploration <= 1)) {
+        throw std::invalid_argument("surrogate_exploration doit être dans [0, 1]");
+    }
+    if (surrogateEnabled() && NumberOfObjectives > 1) {
+        throw std::invalid_argument("le substitut n'est disponible qu'avec un seul objectif");
+    }
+    if (fused_generation && NumberOfObjectives > 1) {
+        throw std::invalid_argument("la génération fusionnée n'est disponible qu'avec un seul objectif");
+    }
+    if (fused_generation && surrogateEnabled()) {
+        // le substitut choisit les enfants à évaluer parmi toute la génération : il ne peut pas suivre les tuiles
+        throw std::invalid_argument("la génération fusionnée et le substitut s'excluent");
+    }
+    if (operator_policy != OperatorPolicy::Fixed && NumberOfObjectives > 1) {
+        // le crédit d'un opérateur est une amélioration de fitness : il lui faut un seul objectif
+        throw std::invalid_argument("le choix adaptatif des opérateurs n'est disponible qu'avec un seul objectif");
+    }
+    if (!(time_limit >= 0)) {
+        throw std::invalid_argument("time_limit doit être positif ou nul");
+    }
+    if (populationSize() > size_t(std::numeric_limits<int>::max())) {
+        throw std::invalid_argument("la population ne peut pas dépasser 2^31 - 1 agents");
+    }
+    if (domain.benchmark != Benchmark::None) {
+        const size_t dims = domain.benchmarkDims();
+        if (NumberOfObjectives > 1) {
+            throw std::invalid_argument("une fonction de test n'a qu'un objectif");
+        }
+        if (dims > NumberOfVectors * Dimension) {
+            throw std::invalid_argument("benchmark_dims ne peut pas dépasser NumberOfVectors * Dimension ("
+                                        + std::to_string(NumberOfVectors * Dimension) + ")");
+        }
+        if (domain.benchmark == Benchmark::Rosenbrock && dims < 2) {
+            throw std::invalid_argument("rosenbrock demande au moins 2 coordonnées");
+        }
+    }
+
+    if (algorithm == Algorithm::Genetic) return;
+
+    // ces options portent sur les générations successives de l'AG : dans les autres moteurs, elles n'auraient aucun effet
+    const char* genetic_only = nullptr;
+    if (NumberOfObjectives > 1)                     genetic_only = "le mode multi-objectif";
+    else if (memetic_elite > 0)                     genetic_only = "le mode mémétique";
+    else if (surrogateEnabled())                    genetic_only = "le substitut";
+    else if (size_policy != PopulationPolicy::Fixed) genetic_only = "une population de taille variable";
+    else if (min_hamming_ratio > 0)                 genetic_only = "min_hamming_ratio";
+    else if (!storage.empty())                      genetic_only = "la population sur disque";
+    else if (fused_generation)                      genetic_only = "la génération fusionnée";
+    else if (operator_policy != OperatorPolicy::Fixed) genetic_only = "le choix adaptatif des opérateurs";
+    if (genetic_only) {
+        throw std::invalid_argument(std::string(genetic_only) + " n'est disponible qu'avec l'algorithme génétique");
+    }
+
+    if (algorithm == Algorithm::MapElites) {
+        // les cases se numérotent sur 64 bits, même quand l'archive n'en garde que les occupées
+        size_t cells = 1;
+        for (size_t k = 0; k < DescriptorDims; k++) {
+            if (map_cells == 0 || cells > (size_t(1) << 62) / map_cells) {
+                throw std::invalid_argument("map_cells doit valoir au moins 1, et la grille compter au plus 2^62 cases");
+            }
+            cells *= map_cells;
+        }
+        return;
+    }
+
+    const size_t minimum = (algorithm == Algorithm::DifferentialEvolution) ? 4 : 2;
+    if (continuous_population != 0 && continuous_population < minimum) {
+        throw std::invalid_argument(std::string("continuous_population doit valoir 0 ou au moins ") + std::to_string(minimum)
+                                    + " pour " + to_string(algorithm));
+    }
+    if (!(de_weight > 0 && de_weight <= 2)) {
+        throw std::invalid_argument("de_weight doit être dans ]0, 2]");
+    }
+    if (!(de_crossover >= 0 && de_crossover <= 1)) {
+        throw std::invalid_argument("de_crossover doit être dans [0, 1]");
+    }
+}
+
+
+
+// ==================================================================================================================
+// Noms
+// ==================================================================================================================
+
+const char* to_string(StopReason r) {
+    switch (r) {
+        case StopReason::Running:     return "running";
+        case StopReason::Generations: return "generations";
+        case StopReason::Converged:   return "converged";
+        case StopReason::Deadline:    return "deadline";
+        case StopReason::Evaluations: return "evaluations";
+        default:                      return "signal";
+    }
+}
+
+const char* to_string(Algorithm a) {
+    switch (a) {
+        case Algorithm::DifferentialEvolution: return "de";
+        case Algorithm::CmaEs:                 return "cmaes";
+        case Algorithm::MapElites:             return "map-elites";
+        default:                               return "genetic";
+    }
+}
+
+Algorithm parse_algorithm(const std::string& name) {
+    for (Algorithm a : { Algorithm::Genetic, Algorithm::DifferentialEvolution, Algorithm::CmaEs, Algorithm::MapElites }) {
+        if (name == to_string(a)) return a;
+    }
+    throw std::invalid_argument("algorithme inconnu : " + name + " (genetic, de, cmaes ou map-elites)");
+}
+
+
+
+
+// ==================================================================================================================
+// Socle commun des moteurs
+// ==================================================================================================================
+
+uint64_t Optimizer::deriveSeed(uint64_t seed, uint64_t stream) {
+    // splitmix64 : deux flux voisins donnent des graines décorrélées
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (stream + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+Optimizer::Optimizer(const Parameters& params, ThreadPool* pool)
+    : m_params(params), m_pool(pool), m_metrics(std::make_shared<EngineMetrics>())
+{
+    m_params.validate();
+    m_metrics->pool = pool;
+}
+
+void Optimizer::beginRun() {
+    if (m_params.seed == 0) {
+        // graine aléatoire, conservée pour pouvoir rejouer le run
+        std::random_device rd;
+        m_params.seed = (uint64_t(rd()) << 32) | rd();
+    }
+
+    // le flux 0 est celui du thread appelant, le flux w+1 celui du worker w
+    const uint64_t seed = m_params.seed;
+    Randomizer::Init(deriveSeed(seed, 0));
+    if (m_pool) {
+        m_pool->parallel_for(m_pool->size(), [seed](size_t, size_t, size_t w) {
+            Randomizer::Init(deriveSeed(seed, w + 1));
+        });
+    }
+
+    m_generation  = 0;
+    m_evaluations = 0;
+    m_stop = StopReason::Running;
+    m_deadline = std::chrono::steady_clock::now()
+               + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(m_params.time_limit));
+    for (auto& t : m_metrics->stage_nanoseconds) t.store(0, std::memory_order_relaxed);
+}
+
+StopReason Optimizer::stopReason() const {
+    if (m_stop != StopReason::Running)       return m_stop;
+    if (m_generation >= m_params.max_gen)    return StopReason::Generations;
+    return StopReason::Running;
+}
+
+bool Optimizer::expired() const {
+    return stop_requested() || (m_params.time_limit > 0 && std::chrono::steady_clock::now() >= m_deadline);
+}
+
+bool Optimizer::interrupted() {
+    if (m_stop == StopReason::Running) {
+        if (stop_requested())                                                  m_stop = StopReason::Signal;
+        else if (expired())                                                    m_stop = StopReason::Deadline;
+        else if (m_params.max_evaluations > 0 && evaluationsLeft() == 0)       m_stop = StopReason::Evaluations;
+    }
+    return m_stop != StopReason::Running;
+}
+
+size_t Optimizer::evaluationsLeft() const {
+    if (m_params.max_evaluations == 0) return std::numeric_limits<size_t>::max();
+    return m_params.max_evaluations > m_evaluations ? m_params.max_evaluations - m_evaluations : 0;
+}
+
+size_t Optimizer::evaluateVectors(std::span<const Agent::phenotype> points, real* out) {
+    std::fill(out, out + points.size(), std::numeric_limits<real>::quiet_NaN());
+    std::vector<size_t> done(m_pool ? m_pool->size() : 1, 0);
+    std::atomic<bool> stop { false };
+
+    parallel_for(m_pool, points.size(), [&](size_t begin, size_t end, size_t w) {
+        size_t count = 0;
+        for (size_t k=begin; k<end; k++) {
+            // l'horloge n'est relue que tous les fx::block points, comme dans les lots de l'AG
+            if ((k - begin) % fx::block == 0 && (stop.load(std::memory_order_relaxed) || expired())) {
+                stop.store(true, std::memory_order_relaxed);
+                break;
+            }
+            out[k] = eval_vectors(points[k], m_params.domain);
+            count++;
+        }
+        done[w] = count;
+    });
+    return std::accumulate(done.begin(), done.end(), size_t(0));
+}
+
+void Optimizer::publish(double seconds, size_t evaluations, real best, real mean, size_t population, size_t memory) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    EngineMetrics& m = *m_metrics;
+    m.best_fitness.store(best, relaxed);
+    m.mean_fitness.store(mean, relaxed);
+    m.generation.store(m_generation, relaxed);
+    m.evaluations.store(m_evaluations, relaxed);
+    m.evaluations_per_second.store(seconds > 0 ? double(evaluations) / seconds : 0, relaxed);
+    m.population.store(population, relaxed);
+    m.memory_bytes.store(memory, relaxed);
+}
+
+
+
+std::unique_ptr<Optimizer> make_optimizer(const Parameters& params, ThreadPool* pool) {
+    switch (params.algorithm) {
+        case Algorithm::DifferentialEvolution: return std::make_unique<DifferentialEvolution>(params, pool);
+        case Algorithm::CmaEs:                 return std::make_unique<CmaEs>(params, pool);
+        case Algorithm::MapElites:             return std::make_unique<MapElites>(params, pool);
+        default:                               return std::make_unique<GeneticEngine>(params, pool);
+    }
+}
+
+void write_solution(const std::string& folder, const Solution& s) {
+    if (!s.found) return;
+
+    fs::path dir = folder;
+    fs::create_directories(dir);
+    fs::path ind = dir / (std::string("best") + std::string(extension_individuals));
+    std::ofstream best (ind);
+    if (!best.is_open()) {
+        throw std::runtime_error("impossible d'écrire " + ind.string());
+    }
+    best << std::setprecision(std::numeric_limits<real>::max_digits10)
+         << "generation " << s.generation << "\nfitness " << s.fitness << '\n';
+    print_vectors(best, s.vectors);
+    best << '\n';
+}
@@ -0,0 +1,383 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// après <filesystem> : settings.h définit la macro "directory"
+#include "parallel.h"
+
+
+namespace fs = std::filesystem;
+
+
+
+
+// ==================================================================================================================
+// Topologie
+// ==================================================================================================================
+
+// lit une liste de cpus au format du noyau Linux, par exemple "0-3,8-11"
+static std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last  = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for (int c = first; c <= last; c++) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+CpuTopology CpuTopology::detect() {
+    CpuTopology topo;
+
+#if defined(__linux__)
+    // on ne garde que les cpus sur lesquels le processus a le droit de tourner (conteneurs, taskset...)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool has_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    std::vector<std::pair<int, std::vector<int>>> found;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4) continue;
+        if (!std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) continue;
+
+        std::ifstream file(entry.path() / "cpulist");
+        std::string text;
+        if (!std::getline(file, text)) continue;
+
+        std::vector<int> cpus;
+        for (int c : parse_cpu_list(text)) {
+            if (!has_mask || CPU_ISSET(c, &allowed)) cpus.push_back(c);
+        }
+        if (!cpus.empty()) found.emplace_back(std::stoi(name.substr(4)), std::move(cpus));
+    }
+
+    std::sort(found.begin(), found.end());
+    for (auto& [id, cpus] : found) topo.nodes.push_back(std::move(cpus));
+
+    if (topo.nodes.empty() && has_mask) {
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed)) cpus.push_back(c);
+        }
+        if (!cpus.empty()) topo.nodes.push_back(std::move(cpus));
+    }
+#endif
+
+    if (topo.nodes.empty()) {
+        // repli : un seul noeud contenant tous les threads matériels
+        std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t c = 0; c < cpus.size(); c++) cpus[c] = int(c);
+        topo.nodes.push_back(std::move(cpus));
+    }
+
+    return topo;
+}
+
+size_t CpuTopology::cpuCount() const {
+    size_t n = 0;
+    for (const auto& node : nodes) n += node.size();
+    return n;
+}
+
+
+
+
+// ==================================================================================================================
+// Mémoire placée
+// ==================================================================================================================
+
+PlacedBuffer::PlacedBuffer(size_t bytes, HugePages pages) {
+    if (bytes == 0) bytes = 1;
+
+#if defined(__linux__)
+    size_t page = size_t(sysconf(_SC_PAGESIZE));
+
+    if (pages == HugePages::Explicit) {
+        constexpr size_t huge_page = size_t(2) << 20; // 2 Mio, la taille par défaut sur x86-64 et arm64
+        size_t len = (bytes + huge_page - 1) / huge_page * huge_page;
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            m_data = p; m_bytes = len; m_mapped = true; m_pages = HugePages::Explicit;
+            return;
+        }
+        // pas de pages réservées par l'administrateur : on se replie sur les pages transparentes
+    }
+
+    size_t len = (bytes + page - 1) / page * page;
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    m_data = p; m_bytes = len; m_mapped = true;
+
+    if (pages != HugePages::None && madvise(p, len, MADV_HUGEPAGE) == 0) {
+        m_pages = HugePages::Transparent;
+    }
+#else
+    (void)pages;
+    constexpr size_t page = 4096;
+    m_bytes = (bytes + page - 1) / page * page;
+    m_data  = ::operator new(m_bytes, std::align_val_t(page));
+#endif
+}
+
+PlacedBuffer::PlacedBuffer(size_t bytes, const std::string& folder) {
+    if (bytes == 0) bytes = 1;
+
+#if defined(__linux__)
+    size_t page = size_t(sysconf(_SC_PAGESIZE));
+    size_t len = (bytes + page - 1) / page * page;
+
+    auto fail = [&folder](const char* what) {
+        throw std::runtime_error(std::string("population sur disque (") + folder + ") : " + what + " : " + std::strerror(errno));
+    };
+
+    std::string path = (fs::path(folder) / "population-XXXXXX").string();
+    int fd = mkstemp(path.data());
+    if (fd < 0) fail("création du fichier impossible");
+    unlink(path.c_str()); // le fichier disparaît avec la dernière référence : la projection
+
+    // fichier creux : aucun bloc n'est écrit sur le disque avant qu'un agent le soit
+    if (ftruncate(fd, off_t(len)) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        fail("dimensionnement du fichier impossible");
+    }
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd); // la projection garde le fichier ouvert
+    errno = err;
+    if (p == MAP_FAILED) fail("projection impossible");
+
+    m_data = p; m_bytes = len; m_mapped = true; m_file = true;
+    advise(Advice::Sequential, 0, len);
+#else
+    (void)bytes;
+    throw std::runtime_error("population sur disque (" + folder + ") : non disponible sur ce système");
+#endif
+}
+
+void PlacedBuffer::advise(Advice advice, size_t offset, size_t length) const {
+    if (!m_file || offset >= m_bytes) return;
+    length = std::min(length, m_bytes - offset);
+
+#if defined(__linux__)
+    size_t page = size_t(sysconf(_SC_PAGESIZE));
+    size_t first = offset / page * page;
+    size_t last  = (offset + length + page - 1) / page * page;
+    int flag = MADV_SEQUENTIAL;
+    switch (advice) {
+        case Advice::Sequential: flag = MADV_SEQUENTIAL; break;
+        case Advice::WillNeed:   flag = MADV_WILLNEED; break;
+        case Advice::Discard:
+            // seulement les pages entièrement couvertes : les voisines gardent leur contenu
+            first = (offset + page - 1) / page * page;
+            last  = std::min((offset + length) / page * page, m_bytes);
+            flag  = MADV_REMOVE;
+            break;
+    }
+    if (last <= first) return;
+    madvise(static_cast<char*>(m_data) + first, last - first, flag); // un simple conseil : un échec ne change rien
+#else
+    (void)advice;
+#endif
+}
+
+PlacedBuffer::~PlacedBuffer() {
+    if (!m_data) return;
+#if defined(__linux__)
+    if (m_mapped) { munmap(m_data, m_bytes); return; }
+#endif
+    ::operator delete(m_data, std::align_val_t(4096));
+}
+
+PlacedBuffer::PlacedBuffer(PlacedBuffer&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_bytes(std::exchange(other.m_bytes, 0)),
+      m_mapped(other.m_mapped), m_file(other.m_file), m_pages(other.m_pages) {}
+
+PlacedBuffer& PlacedBuffer::operator=(PlacedBuffer&& other) noexcept {
+    if (this != &other) {
+        PlacedBuffer tmp(std::move(*this)); // libère l'ancienne zone en sortant du bloc
+        m_data   = std::exchange(other.m_data, nullptr);
+        m_bytes  = std::exchange(other.m_bytes, 0);
+        m_mapped = other.m_mapped;
+        m_file   = other.m_file;
+        m_pages  = other.m_pages;
+    }
+    return *this;
+}
+
+
+
+
+// ==================================================================================================================
+// Pool de threads
+// ==================================================================================================================
+
+ThreadPool::ThreadPool(size_t threads, AffinityPolicy policy)
+    : m_topology(CpuTopology::detect()), m_policy(policy)
+{
+    if (threads == 0) threads = m_topology.cpuCount();
+
+    // ordre dans lequel les cpus sont distribués aux workers
+    std::vector<std::pair<int, int>> order; // (cpu, noeud)
+    if (policy == AffinityPolicy::Scatter) {
+        size_t widest = 0;
+        for (const auto& node : m_topology.nodes) widest = std::max(widest, node.size());
+        for (size_t k = 0; k < widest; k++) {
+            for (size_t n = 0; n < m_topology.nodes.size(); n++) {
+                if (k < m_topology.nodes[n].size()) order.emplace_back(m_topology.nodes[n][k], int(n));
+            }
+        }
+    } else {
+        for (size_t n = 0; n < m_topology.nodes.size(); n++) {
+            for (int c : m_topology.nodes[n]) order.emplace_back(c, int(n));
+        }
+    }
+
+    m_cpu.resize(threads, -1);
+    m_node.resize(threads, -1);
+    m_pinned = (policy != AffinityPolicy::None);
+
+    m_threads.reserve(threads);
+    for (size_t w = 0; w < threads; w++) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, w);
+        if (policy == AffinityPolicy::None) continue;
+
+        auto [cpu, node] = order[w % order.size()];
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(m_threads[w].native_handle(), sizeof(set), &set) == 0) {
+            m_cpu[w]  = cpu;
+            m_node[w] = node;
+            continue;
+        }
+#endif
+        (void)cpu; (void)node;
+        m_pinned = false;
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (auto& t : m_threads) t.join();
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool(NumberOfThreads, affinity_policy);
+    return pool;
+}
+
+void ThreadPool::workerLoop(size_t id) {
+    size_t seen = 0;
+    for (;;) {
+        const std::function<void(size_t)>* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&] { return m_stop || m_epoch != seen; });
+            if (m_stop) return;
+            seen = m_epoch;
+            job  = m_job;
+        }
+
+        try {
+            (*job)(id);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) m_done.notify_one();
+    }
+}
+
+void ThreadPool::run(const std::function<void(size_t)>& job) {
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_pending = m_threads.size();
+        m_error = nullptr;
+        m_epoch++;
+        m_start.notify_all();
+        m_done.wait(lock, [&] { return m_pending == 0; });
+        m_job = nullptr;
+        error = m_error;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+
+
+static const char* to_string(AffinityPolicy p) {
+    switch (p) {
+        case AffinityPolicy::Compact: return "Compact";
+        case AffinityPolicy::Scatter: return "Scatter";
+        default:                      return "None";
+    }
+}
+
+static const char* to_string(const PlacedBuffer& buffer) {
+    if (buffer.fileBacked()) return "fichier projeté en mémoire";
+    switch (buffer.pages()) {
+        case HugePages::Transparent: return "huge pages transparentes";
+        case HugePages::Explicit:    return "huge pages explicites";
+        default:                     return "pages normales";
+    }
+}
+
+void ThreadPool::printPlacement(std::ostream& os, size_t n, const PlacedBuffer& buffer) const {
+    os << "Topologie : " << m_topology.nodes.size() << " noeud(s) NUMA, " << m_topology.cpuCount() << " cpu(s)\n";
+    for (size_t node = 0; node < m_topology.nodes.size(); node++) {
+        os << "  noeud " << node << " : cpus";
+        for (int c : m_topology.nodes[node]) os << ' ' << c;
+        os << '\n';
+    }
+
+    os << "Threads : " << size() << ", politique d'affinité " << to_string(m_policy)
+       << (m_pinned ? " (épinglés)" : " (non épinglés)") << '\n';
+
+    std::vector<size_t> per_node(m_topology.nodes.size(), 0);
+    for (size_t w = 0; w < size(); w++) {
+        auto [begin, end] = chunk(n, w, size());
+        os << "  worker " << w << " -> ";
+        if (m_cpu[w] >= 0) os << "cpu " << m_cpu[w] << " (noeud " << m_node[w] << ")";
+        else               os << "cpu libre";
+        os << " : agents [" << begin << ", " << end << ")\n";
+        if (m_node[w] >= 0) per_node[m_node[w]] += end - begin;
+    }
+
+    os << "Population : " << buffer.bytes() << " octets, " << to_string(buffer) << '\n';
+    if (m_pinned) {
+        for (size_t node = 0; node < per_node.size(); node++) {
+            os << "  noeud " << node << " : " << per_node[node] << " agents\n";
+        }
+    }
+}
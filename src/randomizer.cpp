@@ -1,5 +1,109 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+
 #include "randomizer.h"
 
-std::mt19937 Randomizer::generator;
-std::uniform_real_distribution<real> Randomizer::distrib_proba;
-bool Randomizer::initialized = false;
\ No newline at end of file
+
+// nombre de mots de 64 bits tirés d'un coup par les remplissages en masse (multiple de XoshiroLanes::lanes)
+static constexpr size_t block_words = 128;
+
+
+
+void Randomizer::Init() {
+    std::random_device rd;
+    Init((uint64_t(rd()) << 32) | rd());
+}
+
+
+
+void Randomizer::fillWords(uint64_t* out, size_t n) {
+    XoshiroLanes& lanes = get().lanes;
+    constexpr size_t L = XoshiroLanes::lanes;
+
+    size_t i = 0;
+    for (; i + L <= n; i += L) lanes.next(out + i);
+
+    if (i < n) {
+        uint64_t tail[L];
+        lanes.next(tail);
+        for (size_t l = 0; i < n; i++, l++) out[i] = tail[l];
+    }
+}
+
+void Randomizer::fillProbs(real* out, size_t n) {
+    uint64_t words[block_words];
+    for (size_t i = 0; i < n; i += block_words) {
+        size_t count = std::min(block_words, n - i);
+        fillWords(words, count);
+        for (size_t k = 0; k < count; k++) {
+            out[i + k] = static_cast<real>((words[k] >> 11) * 0x1.0p-53);
+        }
+    }
+}
+
+void Randomizer::fillNormals(real* out, size_t n) {
+    // Box-Muller : chaque couple de mots donne deux tirages indépendants
+    uint64_t words[block_words];
+    for (size_t i = 0; i < n; i += block_words) {
+        size_t count = std::min(block_words, n - i);
+        fillWords(words, (count + 1) / 2 * 2);
+        for (size_t k = 0; k < count; k += 2) {
+            real u1 = static_cast<real>(((words[k] >> 11) + 1) * 0x1.0p-53);   // ]0, 1] : le logarithme reste fini
+            real u2 = static_cast<real>((words[k + 1] >> 11) * 0x1.0p-53);
+            real r = std::sqrt(-2 * std::log(u1));
+            real a = 2 * std::numbers::pi_v<real> * u2;
+            out[i + k] = r * std::cos(a);
+            if (k + 1 < count) out[i + k + 1] = r * std::sin(a);
+        }
+    }
+}
+
+void Randomizer::fillBits(integer* out, size_t n, int nbits) {
+    assert(nbits >= 1 && nbits <= 32 && "fillBits returns at most 32 bits per value");
+
+    // chaque mot de 64 bits fournit deux valeurs de 32 bits
+    uint64_t words[block_words];
+    for (size_t i = 0; i < n; i += 2 * block_words) {
+        size_t count = std::min(2 * block_words, n - i);
+        fillWords(words, (count + 1) / 2);
+        for (size_t k = 0; k < count; k++) {
+            uint32_t half = uint32_t(words[k / 2] >> (32 * (k & 1)));
+            out[i + k] = static_cast<integer>(half >> (32 - nbits));
+        }
+    }
+}
+
+void Randomizer::fillInts(int* out, size_t n, int min, int max) {
+    assert(min <= max && uint64_t(int64_t(max) - int64_t(min)) < (uint64_t(1) << 32) && "fillInts needs a range of at most 2^32 values");
+
+    const uint64_t range = uint64_t(int64_t(max) - int64_t(min)) + 1;
+
+    // méthode de Lemire sur 32 bits : x * range, partie haute = résultat, partie basse = test de rejet
+    // (range = 2^32 donne un seuil nul : aucun rejet, le résultat est x lui-même)
+    const uint32_t threshold = uint32_t((uint64_t(1) << 32) % range); // 2^32 mod range
+
+    uint64_t words[block_words];
+    for (size_t i = 0; i < n; i += 2 * block_words) {
+        size_t count = std::min(2 * block_words, n - i);
+        fillWords(words, (count + 1) / 2);
+
+        bool rejected = false;
+        for (size_t k = 0; k < count; k++) {
+            uint64_t m = (words[k / 2] >> (32 * (k & 1)) & 0xFFFFFFFFULL) * range;
+            out[i + k] = int(int64_t(min) + int64_t(m >> 32));
+            rejected |= uint32_t(m) < threshold;
+        }
+
+        // cas rare (probabilité < range / 2^32) : on refait les tirages biaisés un par un
+        if (rejected) {
+            for (size_t k = 0; k < count; k++) {
+                uint64_t m = (words[k / 2] >> (32 * (k & 1)) & 0xFFFFFFFFULL) * range;
+                if (uint32_t(m) < threshold) {
+                    out[i + k] = int(int64_t(min) + int64_t(bounded(range)));
+                }
+            }
+        }
+    }
+}
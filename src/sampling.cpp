@@ -0,0 +1,104 @@
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "randomizer.h"
+#include "sampling.h"
+
+
+
+namespace {
+
+constexpr int feistel_rounds = 4;
+
+uint64_t mix(uint64_t z) {
+    // finaliseur de splitmix64
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// les premiers nombres premiers, autant que de coordonnées
+std::vector<uint32_t> primes(size_t count) {
+    std::vector<uint32_t> res;
+    for (uint32_t n = 2; res.size() < count; n++) {
+        bool prime = true;
+        for (uint32_t p : res) {
+            if (p * p > n) break;
+            if (n % p == 0) { prime = false; break; }
+        }
+        if (prime) res.push_back(n);
+    }
+    return res;
+}
+
+real radical_inverse(uint64_t i, uint32_t base) {
+    const real inverse = real(1) / real(base);
+    real f = inverse, r = 0;
+    while (i > 0) {
+        r += f * real(i % base);
+        i /= base;
+        f *= inverse;
+    }
+    return r;
+}
+
+} // namespace
+
+
+
+const char* to_string(Initialization s) {
+    switch (s) {
+        case Initialization::LatinHypercube: return "lhs";
+        case Initialization::Halton:         return "halton";
+        default:                             return "uniform";
+    }
+}
+
+
+
+UnitDesign::UnitDesign(Initialization strategy, size_t count, size_t dims)
+    : m_strategy(strategy), m_count(count)
+{
+    if (strategy == Initialization::LatinHypercube) {
+        // le réseau travaille sur 2h bits, h = la moitié (arrondie au-dessus) des bits de count - 1 : au plus 4 count valeurs
+        const unsigned bits = count > 1 ? unsigned(std::bit_width(uint64_t(count - 1))) : 1;
+        m_half_bits = (bits + 1) / 2;
+        m_keys.resize(dims);
+        Randomizer::fillWords(m_keys.data(), dims);
+    }
+    else if (strategy == Initialization::Halton) {
+        m_bases = primes(dims);
+        m_shifts.resize(dims);
+        Randomizer::fillProbs(m_shifts.data(), dims);
+    }
+}
+
+size_t UnitDesign::permute(size_t i, uint64_t key) const {
+    const uint64_t mask = (uint64_t(1) << m_half_bits) - 1;
+    uint64_t x = i;
+    do {
+        // un réseau de Feistel est une bijection de [0, 2^2h) ; on le réapplique jusqu'à retomber dans [0, count)
+        uint64_t l = x >> m_half_bits, r = x & mask;
+        for (int round = 0; round < feistel_rounds; round++) {
+            const uint64_t t = l ^ (mix(r ^ (key + 0x9E3779B97F4A7C15ULL * uint64_t(round + 1))) & mask);
+            l = r;
+            r = t;
+        }
+        x = (l << m_half_bits) | r;
+    } while (x >= m_count);
+    return size_t(x);
+}
+
+real UnitDesign::coordinate(size_t i, size_t k) const {
+    switch (m_strategy) {
+        case Initialization::LatinHypercube:
+            return (real(permute(i, m_keys[k])) + Randomizer::getProb()) / real(m_count);
+        case Initialization::Halton: {
+            const real x = radical_inverse(uint64_t(i) + 1, m_bases[k]) + m_shifts[k];
+            return x < 1 ? x : x - 1;
+        }
+        default:
+            return Randomizer::getProb();
+    }
+}
@@ -0,0 +1,37 @@
+#include <atomic>
+#include <csignal>
+
+#include "stop.h"
+
+
+
+namespace {
+
+std::atomic<bool> requested { false };
+static_assert(std::atomic<bool>::is_always_lock_free, "le gestionnaire de signal ne doit prendre aucun verrou");
+
+void on_stop_signal(int sig) {
+    requested.store(true, std::memory_order_relaxed);
+    std::signal(sig, SIG_DFL); // le signal suivant termine le processus
+}
+
+} // namespace
+
+
+
+void install_stop_handlers() {
+    std::signal(SIGINT, on_stop_signal);
+    std::signal(SIGTERM, on_stop_signal);
+}
+
+void request_stop() noexcept {
+    requested.store(true, std::memory_order_relaxed);
+}
+
+bool stop_requested() noexcept {
+    return requested.load(std::memory_order_relaxed);
+}
+
+void clear_stop_request() noexcept {
+    requested.store(false, std::memory_order_relaxed);
+}
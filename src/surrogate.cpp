@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "surrogate.h"
+
+
+
+namespace {
+
+constexpr size_t leaf_size      = 32;   // nombre maximal de points d'une feuille
+constexpr size_t max_neighbours = 32;  // taille du tableau des plus proches voisins
+
+// recherche approchée : un sous-arbre n'est visité que s'il peut contenir un point (1 + SurrogateEpsilon) fois plus
+// proche que le pire voisin retenu. Loin d'un amas, tous ses points sont presque à la même distance et la recherche
+// exacte les parcourrait tous ; la pondération IDW ne fait presque pas la différence.
+static_assert(SurrogateEpsilon >= 0, "SurrogateEpsilon must be >= 0");
+constexpr real shrink = 1 / ((1 + SurrogateEpsilon) * (1 + SurrogateEpsilon));
+
+// au-delà de 12 coordonnées, un plan de coupe n'élimine presque plus rien : chaque noeud garde sa boule englobante
+constexpr bool use_balls = Surrogate::dims >= 12;
+
+real distance2(const real* a, const real* b) {
+    real d = 0;
+    for (size_t k = 0; k < Surrogate::dims; k++) {
+        real t = a[k] - b[k];
+        d += t * t;
+    }
+    return d;
+}
+
+} // namespace
+
+
+
+// les k plus proches voisins trouvés jusqu'ici, par distance croissante
+struct Surrogate::Nearest {
+    size_t k;
+    size_t count = 0;
+    std::array<real, max_neighbours> d2;
+    std::array<real, max_neighbours> value;
+
+    explicit Nearest(size_t k) : k(k) {}
+
+    real worst() const { return count < k ? std::numeric_limits<real>::infinity() : d2[count - 1]; }
+
+    void offer(real d, real v) {
+        if (d >= worst()) return;
+        size_t i = (count < k) ? count++ : k - 1;
+        while (i > 0 && d2[i - 1] > d) {
+            d2[i] = d2[i - 1];
+            value[i] = value[i - 1];
+            i--;
+        }
+        d2[i] = d;
+        value[i] = v;
+    }
+};
+
+
+
+Surrogate::Surrogate(size_t capacity, size_t neighbours)
+    : m_capacity(capacity), m_neighbours(neighbours)
+{
+    if (neighbours < 1 || neighbours > max_neighbours) {
+        throw std::invalid_argument("le nombre de voisins du substitut doit être compris entre 1 et 32");
+    }
+    if (capacity < neighbours) {
+        throw std::invalid_argument("l'archive du substitut doit pouvoir contenir au moins un voisinage");
+    }
+}
+
+void Surrogate::clear() {
+    m_points.clear();
+    m_values.clear();
+    m_main = Tree{};
+    m_recent = Tree{};
+    m_indexed = 0;
+    m_recent_end = 0;
+}
+
+void Surrogate::add(const Agent& a, real fitness) {
+    Point x;
+    const auto c = a.coordinates();
+    std::copy(c.begin(), c.end(), x.begin());
+    m_points.push_back(x);
+    m_values.push_back(fitness);
+}
+
+void Surrogate::commit() {
+    if (m_points.size() - m_indexed <= m_indexed / 8 + 64) {
+        // seul le petit arbre des points récents est reconstruit
+        index(m_recent, m_indexed, m_points.size());
+        m_recent_end = m_points.size();
+        return;
+    }
+
+    // les points les plus anciens sortent de l'archive, puis tout est réindexé dans l'arbre principal
+    if (m_points.size() > m_capacity) {
+        size_t drop = m_points.size() - m_capacity;
+        m_points.erase(m_points.begin(), m_points.begin() + drop);
+        m_values.erase(m_values.begin(), m_values.begin() + drop);
+    }
+    index(m_main, 0, m_points.size());
+    m_recent = Tree{};
+    m_indexed = m_recent_end = m_points.size();
+}
+
+void Surrogate::index(Tree& tree, size_t first, size_t last) {
+    std::vector<size_t> order(last - first);
+    std::iota(order.begin(), order.end(), first);
+    tree.nodes.clear();
+    tree.balls.clear();
+    if (!order.empty()) build(tree, order, 0, order.size());
+
+    tree.points.resize(order.size());
+    tree.values.resize(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        tree.points[i] = m_points[order[i]];
+        tree.values[i] = m_values[order[i]];
+    }
+}
+
+size_t Surrogate::build(Tree& tree, std::vector<size_t>& order, size_t begin, size_t end) {
+    const size_t id = tree.nodes.size();
+    tree.nodes.emplace_back();
+    if constexpr (use_balls) tree.balls.emplace_back();
+
+    Node node;
+    node.begin = begin;
+    node.end = end;
+
+    // l'étendue des points du noeud sur chaque coordonnée
+    Point lo = m_points[order[begin]], hi = lo;
+    for (size_t i = begin + 1; i < end; i++) {
+        const Point& x = m_points[order[i]];
+        for (size_t k = 0; k < dims; k++) {
+            lo[k] = std::min(lo[k], x[k]);
+            hi[k] = std::max(hi[k], x[k]);
+        }
+    }
+
+    if constexpr (use_balls) {
+        Ball ball;
+        for (size_t i = begin; i < end; i++) {
+            for (size_t k = 0; k < dims; k++) ball.center[k] += m_points[order[i]][k];
+        }
+        for (real& c : ball.center) c /= real(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            ball.radius = std::max(ball.radius, distance2(ball.center.data(), m_points[order[i]].data()));
+        }
+        ball.radius = std::sqrt(ball.radius);
+        tree.balls[id] = ball;
+    }
+
+    if (end - begin > leaf_size) {
+        // coupe à la médiane de la coordonnée la plus étendue
+        size_t axis = 0;
+        for (size_t k = 1; k < dims; k++) {
+            if (hi[k] - lo[k] > hi[axis] - lo[axis]) axis = k;
+        }
+        size_t mid = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                         [this, axis](size_t a, size_t b) { return m_points[a][axis] < m_points[b][axis]; });
+
+        node.axis = axis;
+        node.split = m_points[order[mid]][axis];
+        node.left = build(tree, order, begin, mid);
+        node.right = build(tree, order, mid, end);
+    }
+
+    tree.nodes[id] = node;
+    return id;
+}
+
+void Surrogate::search(const Tree& tree, size_t id, const real* x, Nearest& best) {
+    const Node& node = tree.nodes[id];
+
+    if (node.left == 0) {
+        for (size_t i = node.begin; i < node.end; i++) best.offer(distance2(x, tree.points[i].data()), tree.values[i]);
+        return;
+    }
+
+    if constexpr (use_balls) {
+        // distance minimale (au carré) entre x et la boule d'un enfant
+        auto bound = [x](const Ball& child) {
+            real d = std::max(real(0), std::sqrt(distance2(x, child.center.data())) - child.radius);
+            return d * d;
+        };
+        size_t near = node.left, far = node.right;
+        real near_bound = bound(tree.balls[near]), far_bound = bound(tree.balls[far]);
+        if (far_bound < near_bound) {
+            std::swap(near, far);
+            std::swap(near_bound, far_bound);
+        }
+        if (near_bound < shrink * best.worst()) search(tree, near, x, best);
+        if (far_bound < shrink * best.worst())  search(tree, far, x, best);
+    } else {
+        // les points de gauche sont <= split sur l'axe, ceux de droite >= split
+        real diff = x[node.axis] - node.split;
+        size_t near = diff < 0 ? node.left : node.right;
+        size_t far  = diff < 0 ? node.right : node.left;
+        search(tree, near, x, best);
+        if (diff * diff < shrink * best.worst()) search(tree, far, x, best);
+    }
+}
+
+size_t Surrogate::memory() const {
+    auto tree = [](const Tree& t) {
+        return t.points.capacity() * sizeof(Point) + t.values.capacity() * sizeof(real)
+             + t.nodes.capacity() * sizeof(Node) + t.balls.capacity() * sizeof(Ball);
+    };
+    return m_points.capacity() * sizeof(Point) + m_values.capacity() * sizeof(real) + tree(m_main) + tree(m_recent);
+}
+
+real Surrogate::predict(const Agent& a) const {
+    return predict(a.coordinates());
+}
+
+real Surrogate::predict(std::span<const real> x) const {
+    Nearest best(m_neighbours);
+    if (!m_main.nodes.empty())   search(m_main, 0, x.data(), best);
+    if (!m_recent.nodes.empty()) search(m_recent, 0, x.data(), best);
+    for (size_t i = m_recent_end; i < m_points.size(); i++) best.offer(distance2(x.data(), m_points[i].data()), m_values[i]);
+
+    // pondération par l'inverse du carré de la distance ; un point déjà évalué donne sa propre fitness
+    if (best.d2[0] == 0) return best.value[0];
+    real num = 0, den = 0;
+    for (size_t i = 0; i < best.count; i++) {
+        real w = 1 / best.d2[i];
+        num += w * best.value[i];
+        den += w;
+    }
+    return num / den;
+}
@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "sweep.h"
+#include "benchmarks.h"
+#include "engine.h"
+#include "sampling.h"
+#include "stop.h"
+
+
+
+
+// ==================================================================================================================
+// Lecture de la spécification
+// ==================================================================================================================
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static double to_number(const std::string& text, size_t line) {
+    try {
+        size_t used = 0;
+        double v = std::stod(trim(text), &used);
+        if (used == trim(text).size()) return v;
+    } catch (const std::exception&) {}
+    throw std::runtime_error("ligne " + std::to_string(line) + " : nombre invalide '" + trim(text) + "'");
+}
+
+static SweepAxis parse_axis(const std::string& value, size_t line) {
+    SweepAxis axis;
+
+    if (value.find(':') != std::string::npos) {
+        std::vector<std::string> parts;
+        std::stringstream ss(value);
+        std::string part;
+        while (std::getline(ss, part, ':')) parts.push_back(part);
+        if (parts.size() < 2 || parts.size() > 3) {
+            throw std::runtime_error("ligne " + std::to_string(line) + " : intervalle attendu sous la forme lo:hi ou lo:hi:step");
+        }
+
+        axis.lo = to_number(parts[0], line);
+        axis.hi = to_number(parts[1], line);
+        if (axis.hi < axis.lo) throw std::runtime_error("ligne " + std::to_string(line) + " : intervalle vide");
+
+        if (parts.size() == 3) {
+            double step = to_number(parts[2], line);
+            if (!(step > 0)) throw std::runtime_error("ligne " + std::to_string(line) + " : le pas doit être positif");
+            for (double v = axis.lo; v <= axis.hi + step * 1e-9; v += step) axis.values.push_back(v);
+        }
+        return axis;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) axis.values.push_back(to_number(item, line));
+    if (axis.values.empty()) throw std::runtime_error("ligne " + std::to_string(line) + " : aucune valeur");
+    return axis;
+}
+
+static const char* const axis_names[] = {
+    "half_population_size", "max_gen", "initial_mutation_proba", "min_real", "max_real",
+    "memetic_elite", "memetic_budget", "population_policy", "min_half_population_size",
+    "min_hamming_ratio", "surrogate_keep", "surrogate_exploration", "time_limit", "max_evaluations", "algorithm",
+    "initialization", "benchmark", "benchmark_dims", "fused_generation",
+    "map_cells", "operator_policy"
+};
+
+SweepSpec SweepSpec::parse(std::istream& in) {
+    SweepSpec spec;
+    std::string raw;
+    size_t line = 0;
+
+    while (std::getline(in, raw)) {
+        line++;
+        std::string text = trim(raw.substr(0, raw.find('#')));
+        if (text.empty()) continue;
+
+        size_t eq = text.find('=');
+        if (eq == std::string::npos) {
+            throw std::runtime_error("ligne " + std::to_string(line) + " : 'clé = valeur' attendu");
+        }
+        std::string key   = trim(text.substr(0, eq));
+        std::string value = trim(text.substr(eq + 1));
+
+        if (key == "mode") {
+            if      (value == "grid")   spec.mode = Mode::Grid;
+            else if (value == "random") spec.mode = Mode::Random;
+            else throw std::runtime_error("ligne " + std::to_string(line) + " : mode inconnu '" + value + "'");
+        }
+        else if (key == "samples") spec.samples = size_t(to_number(value, line));
+        else if (key == "repeats") spec.repeats = std::max<size_t>(1, size_t(to_number(value, line)));
+        else if (key == "seed")    spec.seed    = uint64_t(to_number(value, line));
+        else if (key == "output")  spec.output  = value;
+        else if (key == "targets") {
+            for (double v : parse_axis(value, line).values) spec.targets.push_back(real(v));
+        }
+        else if (std::find(std::begin(axis_names), std::end(axis_names), key) != std::end(axis_names)) {
+            spec.axes.emplace_back(key, parse_axis(value, line));
+        }
+        else throw std::runtime_error("ligne " + std::to_string(line) + " : clé inconnue '" + key + "'");
+    }
+
+    if (spec.mode == Mode::Grid) {
+        for (const auto& [name, axis] : spec.axes) {
+            if (axis.isRange()) throw std::runtime_error("l'axe " + name + " est un intervalle sans pas : seul le mode random peut le tirer");
+        }
+    }
+    return spec;
+}
+
+
+
+
+// ==================================================================================================================
+// Expansion en runs
+// ==================================================================================================================
+
+static void apply(Parameters& p, const std::string& name, double v) {
+    if      (name == "half_population_size")   p.half_population_size = size_t(std::llround(v));
+    else if (name == "max_gen")                p.max_gen = size_t(std::llround(v));
+    else if (name == "initial_mutation_proba") p.initial_mutation_proba = real(v);
+    else if (name == "min_real")               p.domain.min = real(v);
+    else if (name == "max_real")               p.domain.max = real(v);
+    else if (name == "memetic_elite")          p.memetic_elite = size_t(std::llround(v));
+    else if (name == "memetic_budget")         p.memetic_budget = size_t(std::llround(v));
+    else if (name == "population_policy")      p.size_policy = PopulationPolicy(std::clamp<long long>(std::llround(v), 0, 2));
+    else if (name == "min_half_population_size") p.min_half_population_size = size_t(std::llround(v));
+    else if (name == "min_hamming_ratio")      p.min_hamming_ratio = real(v);
+    else if (name == "surrogate_keep")         p.surrogate_keep = real(v);
+    else if (name == "surrogate_exploration")  p.surrogate_exploration = real(v);
+    else if (name == "time_limit")             p.time_limit = real(v);
+    else if (name == "max_evaluations")        p.max_evaluations = size_t(std::llround(v));
+    else if (name == "algorithm")              p.algorithm = Algorithm(std::clamp<long long>(std::llround(v), 0, 3));
+    else if (name == "initialization")         p.initialization = Initialization(std::clamp<long long>(std::llround(v), 0, 2));
+    else if (name == "benchmark") {
+        p.domain.benchmark = Benchmark(std::clamp<long long>(std::llround(v), 0, BenchmarkCount - 1));
+        benchmark_interval(p.domain.benchmark, p.domain.min, p.domain.max);
+    }
+    else if (name == "benchmark_dims")         p.domain.benchmark_dims = size_t(std::llround(v));
+    else if (name == "fused_generation")       p.fused_generation = v != 0;
+    else if (name == "map_cells")              p.map_cells = size_t(std::llround(v));
+    else if (name == "operator_policy")        p.operator_policy = OperatorPolicy(std::clamp<long long>(std::llround(v), 0, 2));
+}
+
+std::vector<Parameters> SweepSpec::expand(size_t* skipped) const {
+    std::vector<Parameters> configs;
+
+    if (mode == Mode::Grid) {
+        // produit cartésien : un compteur en base variable sur les axes
+        std::vector<size_t> digit(axes.size(), 0);
+        for (;;) {
+            Parameters p;
+            for (size_t a = 0; a < axes.size(); a++) apply(p, axes[a].first, axes[a].second.values[digit[a]]);
+            configs.push_back(p);
+
+            size_t a = 0;
+            while (a < axes.size() && ++digit[a] == axes[a].second.values.size()) digit[a++] = 0;
+            if (a == axes.size()) break;
+        }
+    } else {
+        std::mt19937_64 rng(seed);
+        for (size_t s = 0; s < samples; s++) {
+            Parameters p;
+            for (const auto& [name, axis] : axes) {
+                double v = axis.isRange()
+                    ? std::uniform_real_distribution<double>(axis.lo, axis.hi)(rng)
+                    : axis.values[std::uniform_int_distribution<size_t>(0, axis.values.size() - 1)(rng)];
+                apply(p, name, v);
+            }
+            configs.push_back(p);
+        }
+    }
+
+    std::vector<Parameters> runs;
+    size_t dropped = 0;
+    for (const auto& config : configs) {
+        try {
+            config.validate();
+        } catch (const std::invalid_argument&) {
+            dropped++;
+            continue;
+        }
+        for (size_t r = 0; r < repeats; r++) {
+            Parameters p = config;
+            p.seed = Optimizer::deriveSeed(seed, runs.size());
+            runs.push_back(p);
+        }
+    }
+
+    if (skipped) *skipped = dropped;
+    return runs;
+}
+
+
+
+
+// ==================================================================================================================
+// Exécution
+// ==================================================================================================================
+
+std::vector<RunSummary> run_sweep(const std::vector<Parameters>& runs, ThreadPool& pool,
+                                  std::ostream& csv, std::ostream* progress,
+                                  const std::vector<real>& targets)
+{
+    // les runs les plus coûteux partent en premier : les petits comblent la fin (ordonnancement LPT)
+    std::vector<size_t> order(runs.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    auto cost = [&](size_t i) { return double(runs[i].populationSize()) * double(runs[i].max_gen); };
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return cost(a) > cost(b); });
+
+    std::vector<RunSummary> summaries(runs.size());
+    std::atomic<size_t> next { 0 };
+    std::mutex output;
+    size_t done = 0;
+
+    csv << "run,seed,half_population_size,max_gen,initial_mutation_proba,min_real,max_real,"
+           "memetic_elite,memetic_budget,population_policy,min_half_population_size,min_hamming_ratio,"
+           "surrogate_keep,surrogate_exploration,time_limit,max_evaluations,"
+           "best_fitness,generations,evaluations,seconds,stop,algorithm,initialization,benchmark,benchmark_dims,"
+           "fused_generation,map_cells,operator_policy";
+    for (real t : targets) csv << ",evaluations_to_" << t << ",seconds_to_" << t;
+    csv << '\n' << std::flush;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // un élément par worker : chacun pioche le prochain run dans la file jusqu'à l'épuiser
+    pool.parallel_for(pool.size(), [&](size_t, size_t, size_t) {
+        for (size_t k = next++; k < order.size(); k = next++) {
+            if (stop_requested()) break; // les runs en cours finissent proprement, les suivants ne démarrent pas
+            size_t i = order[k];
+            auto t0 = std::chrono::steady_clock::now();
+
+            // le run est séquentiel : le parallélisme est entre les runs
+            std::unique_ptr<Optimizer> engine = make_optimizer(runs[i], nullptr);
+            GeneticEngine* genetic = dynamic_cast<GeneticEngine*>(engine.get());
+            RunSummary& s = summaries[i];
+            s.evaluations_to.assign(targets.size(), 0);
+            s.seconds_to.assign(targets.size(), 0);
+
+            // une cible est chronométrée à la fin de la génération qui l'atteint
+            auto check_targets = [&] {
+                const Solution best = engine->bestSolution();
+                if (!best.found) return;
+                for (size_t t = 0; t < targets.size(); t++) {
+                    if (s.evaluations_to[t] || best.fitness < targets[t]) continue;
+                    s.evaluations_to[t] = engine->evaluations();
+                    s.seconds_to[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                }
+            };
+
+            engine->init();
+            if (targets.empty()) {
+                engine->run();
+            } else {
+                check_targets();
+                while (!engine->finished()) {
+                    engine->step(1);
+                    check_targets();
+                }
+            }
+
+            s.run = i;
+            s.params = engine->parameters();
+            if constexpr (NumberOfObjectives == 1) {
+                // la dernière génération de l'AG compte aussi, dans la limite du budget ; DE et CMA-ES l'ont déjà évaluée
+                if (genetic) genetic->fitness();
+                s.best_fitness = engine->bestSolution().fitness;
+                check_targets();
+            } else {
+                genetic->bestIndex(&s.best_fitness); // le multi-objectif n'existe qu'avec l'AG (Parameters::validate)
+            }
+            s.generations = engine->generation();
+            s.evaluations = engine->evaluations();
+            s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            s.stop = engine->stopReason();
+
+            std::lock_guard<std::mutex> lock(output);
+            csv << s.run << ',' << s.params.seed << ',' << s.params.half_population_size << ','
+                << s.params.max_gen << ',' << s.params.initial_mutation_proba << ','
+                << s.params.domain.min << ',' << s.params.domain.max << ','
+                << s.params.memetic_elite << ',' << s.params.memetic_budget << ','
+                << int(s.params.size_policy) << ',' << s.params.min_half_population_size << ','
+                << s.params.min_hamming_ratio << ','
+                << s.params.surrogate_keep << ',' << s.params.surrogate_exploration << ','
+                << s.params.time_limit << ',' << s.params.max_evaluations << ','
+                << std::setprecision(17) << s.best_fitness << std::setprecision(6) << ','
+                << s.generations << ',' << s.evaluations << ',' << s.seconds << ',' << to_string(s.stop) << ','
+                << to_string(s.params.algorithm) << ',' << to_string(s.params.initialization) << ','
+                << to_string(s.params.domain.benchmark) << ',' << s.params.domain.benchmark_dims << ','
+                << int(s.params.fused_generation) << ',' << s.params.map_cells << ',' << int(s.params.operator_policy);
+            for (size_t t = 0; t < targets.size(); t++) {
+                csv << ',';
+                if (s.evaluations_to[t]) csv << s.evaluations_to[t];
+                csv << ',';
+                if (s.evaluations_to[t]) csv << s.seconds_to[t];
+            }
+            csv << '\n' << std::flush;
+
+            done++;
+            if (progress) {
+                *progress << "run " << s.run << " terminé (" << done << "/" << runs.size() << ") en "
+                          << s.seconds << " s, fitness " << s.best_fitness << '\n';
+            }
+        }
+    });
+
+    if (progress) {
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        *progress << runs.size() << " runs en " << total << " s, soit "
+                  << (total > 0 ? 3600.0 * double(runs.size()) / total : 0.0) << " runs/heure\n";
+    }
+
+    return summaries;
+}
+
+std::vector<RunSummary> run_sweep_spec(const SweepSpec& spec, std::ostream& progress) {
+    size_t skipped = 0;
+    std::vector<Parameters> runs = spec.expand(&skipped);
+    progress << runs.size() << " runs à exécuter";
+    if (skipped) progress << " (" << skipped << " combinaisons invalides ignorées)";
+    progress << '\n';
+
+    std::filesystem::path out = spec.output;
+    if (out.has_parent_path()) std::filesystem::create_directories(out.parent_path());
+    std::ofstream csv(out);
+    if (!csv.is_open()) throw std::runtime_error("impossible d'écrire " + spec.output);
+
+    // Ctrl-C : les runs en cours s'arrêtent avec leur meilleur agent, le csv garde une ligne par run terminé
+    install_stop_handlers();
+
+    ThreadPool& pool = ThreadPool::global();
+    progress << pool.size() << " workers, résultats dans " << spec.output << "\n\n";
+
+    return run_sweep(runs, pool, csv, &progress, spec.targets);
+}
@@ -0,0 +1,37 @@
+/*
+    Balayage de paramètres : lance de nombreux runs indépendants de l'algorithme génétique dans un seul processus.
+
+    Utilisation :
+        genetic_sweep <spécification> [sortie.csv]
+
+    Le format de la spécification est décrit dans sweep.h. Chaque run écrit une ligne de résumé dans le fichier csv
+    (par défaut celui donné par la clé "output" de la spécification).
+*/
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "sweep.h"
+
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "utilisation : " << argv[0] << " <spécification> [sortie.csv]\n";
+        return 1;
+    }
+
+    try {
+        std::ifstream spec_file(argv[1]);
+        if (!spec_file.is_open()) throw std::runtime_error(std::string("impossible d'ouvrir ") + argv[1]);
+
+        SweepSpec spec = SweepSpec::parse(spec_file);
+        if (argc > 2) spec.output = argv[2];
+
+        run_sweep_spec(spec, std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "erreur : " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+// Vérification de compilation : Vec.h avec un real qui n'est pas double (CMakeLists.txt le compile avec une copie
+// de settings.h où real est long double, puis float). Aucun code n'est exécuté.
+
+#include "Vec.h"
+
+template class Vec<2>;
+template class Vec<3>;
+template class Vec<4>;
+
+// les opérations restent évaluables à la compilation
+static_assert((Vec<3>(std::array<real, 3>{ 1, 2, 2 }) * real(2)).dot(Vec<3>(std::array<real, 3>{ 1, 0, 0 })) == real(2));
+static_assert((Vec<2>(std::array<real, 2>{ 3, 4 }) - Vec<2>()).normSquared() == real(25));